@@ -0,0 +1,97 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+
+// Realtime headroom: DSP load against the JACK period, the hex callback
+// duration histogram (log2 microsecond buckets) and the most recent
+// over-budget callbacks.
+Rectangle {
+    id: root
+    property var telemetry: AppController.telemetry
+    color: "#0b1220"
+    radius: 12
+
+    function bucketLabel(index) {
+        if (index === 0)
+            return "<1µs"
+        const us = Math.pow(2, index - 1)
+        return us >= 1000 ? (us / 1000).toFixed(us >= 10000 ? 0 : 1) + "ms" : us + "µs"
+    }
+
+    readonly property var histogram: telemetry ? telemetry.hexHistogram : []
+    readonly property real histogramMax: {
+        let peak = 1
+        for (let i = 0; i < histogram.length; ++i)
+            peak = Math.max(peak, histogram[i])
+        return peak
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        anchors.margins: 16
+        spacing: 12
+
+        RowLayout {
+            spacing: 16
+            Text {
+                text: root.telemetry ? root.telemetry.headroomText : "DSP —"
+                color: root.telemetry && root.telemetry.headroom < 25 ? "#f97316" : "#93c5fd"
+                font.pixelSize: 18
+            }
+            Text {
+                text: root.telemetry
+                      ? "over budget (>" + root.telemetry.budgetPercent + "% period): " + root.telemetry.overBudgetCount
+                        + " · worst " + root.telemetry.hexMaxCallbackUs + " µs"
+                      : ""
+                color: "#64748b"
+            }
+        }
+
+        Row {
+            Layout.fillWidth: true
+            Layout.preferredHeight: 72
+            spacing: 2
+            Repeater {
+                model: root.histogram.length
+                delegate: Column {
+                    spacing: 2
+                    width: 44
+                    Item {
+                        width: parent.width
+                        height: 52
+                        Rectangle {
+                            anchors.bottom: parent.bottom
+                            width: parent.width
+                            height: root.histogram[index] > 0
+                                    ? Math.max(2, parent.height * Math.log(1 + root.histogram[index]) / Math.log(1 + root.histogramMax))
+                                    : 0
+                            radius: 2
+                            color: "#38bdf8"
+                        }
+                    }
+                    Text {
+                        width: parent.width
+                        horizontalAlignment: Text.AlignHCenter
+                        text: root.bucketLabel(index)
+                        color: "#64748b"
+                        font.pixelSize: 10
+                    }
+                }
+            }
+        }
+
+        ListView {
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            clip: true
+            model: root.telemetry ? root.telemetry.recentMisses : []
+            delegate: Text {
+                text: modelData.source + "  " + modelData.durationUs + " µs / " + modelData.budgetUs + " µs budget"
+                      + "  · " + modelData.frames + " frames · " + modelData.activeStrings + " strings · "
+                      + modelData.ageSec.toFixed(1) + " s ago"
+                color: "#fca5a5"
+                font.pixelSize: 12
+            }
+        }
+    }
+}
@@ -24,8 +24,6 @@ Item {
             Button { text: "Save Preset"; onClicked: AppController.savePreset(presetBox.currentText) }
         }
 
-        Rectangle { Layout.fillWidth: true; Layout.fillHeight: true; color: "#0b1220"; radius: 12
-            Text { anchors.centerIn: parent; text: "Home: tuner, big meters, quick actions"; color: "#93c5fd" }
-        }
+        CallbackTelemetryPanel { Layout.fillWidth: true; Layout.fillHeight: true }
     }
 }
@@ -937,7 +937,10 @@ Item {
             root.lastTestPlaybackState = state;
 
             if (state === "Playing") {
-                var events = bridge && bridge.events ? bridge.events : [];
+                var events = [];
+                var eventModel = bridge ? bridge.eventModel : null;
+                for (var i = 0; eventModel && i < eventModel.count; ++i)
+                    events.push(eventModel.get(i));
                 neckSection.playDetectedEvents(events);
             } else if (state === "Stopped" || state === "Idle" || state === "Paused" || state === "Complete") {
                 neckSection.stopPlayback();
@@ -3,6 +3,7 @@
 #include "RecordedSessionPlayer.h"
 #include "audio/CarlaClient.h"
 #include "audio/HexJackClient.h"
+#include "audio/NullHexClient.h"
 
 #include <QDateTime>
 #include <QDebug>
@@ -224,17 +225,25 @@ bool AppController::ensureAudioClient() {
         });
 
         m_audioClient = std::move(client);
+        m_telemetry.setCarlaClient(m_audioClient.get());
     }
 
     if (!m_hexClient) {
-        auto client = std::make_unique<HexJackClient>(this);
-        qInfo() << "AppController" << "hex-client" << "created";
+        std::unique_ptr<HexCaptureClient> client;
+        if (NullHexClient::requestedByEnvironment()) {
+            client = std::make_unique<NullHexClient>(this);
+            qInfo() << "AppController" << "hex-client" << "created" << "null";
+        } else {
+            client = std::make_unique<HexJackClient>(this);
+            qInfo() << "AppController" << "hex-client" << "created";
+        }
 
-        connect(client.get(), &HexJackClient::xrunsChanged, this, [](int count) {
-            qInfo("HexJack xruns: %d", count);
+        connect(client.get(), &HexCaptureClient::xrunsChanged, this, [](int count) {
+            qInfo("Hex xruns: %d", count);
         });
 
         m_hexClient = std::move(client);
+        m_telemetry.setHexClient(m_hexClient.get());
     }
 
     if (m_hexClient) {
@@ -9,9 +9,10 @@
 #include "TabEngineBridge.h"
 #include "RunSessionOptions.h"
 #include "DetectionTuningController.h"
+#include "audio/AudioTelemetry.h"
 
 class CarlaClient;
-class HexJackClient;
+class HexCaptureClient;
 class RecordedSessionPlayer;
 
 class AppController : public QObject {
@@ -29,6 +30,7 @@ class AppController : public QObject {
     Q_PROPERTY(bool liveHexMonitorEnabled READ liveHexMonitorEnabled WRITE setLiveHexMonitorEnabled NOTIFY liveHexMonitorChanged)
     Q_PROPERTY(QObject* tabBridge READ tabBridgeObject CONSTANT)
     Q_PROPERTY(QObject* tuningController READ tuningControllerObject CONSTANT)
+    Q_PROPERTY(QObject* telemetry READ telemetryObject CONSTANT)
 public:
     explicit AppController(const RunSessionOptions& options = RunSessionOptions{}, QObject* parent=nullptr);
     ~AppController() override;
@@ -57,6 +59,8 @@ public:
     const QObject* tuningControllerObject() const { return &m_tuningController; }
     DetectionTuningController* tuningController() { return &m_tuningController; }
     const DetectionTuningController* tuningController() const { return &m_tuningController; }
+    QObject* telemetryObject() { return &m_telemetry; }
+    AudioTelemetry* telemetry() { return &m_telemetry; }
 
     bool testMode() const { return m_runOptions.isRecorded(); }
     QString testSessionName() const { return m_testSessionName; }
@@ -100,7 +104,7 @@ private:
     QString m_currentPreset {"Default"};
     QString m_latencyText {"—"};
     std::unique_ptr<CarlaClient> m_audioClient;
-    std::unique_ptr<HexJackClient> m_hexClient;
+    std::unique_ptr<HexCaptureClient> m_hexClient;
     int m_requestedBufferSize {0};
     int m_requestedSampleRate {0};
     int m_activeBufferSize {0};
@@ -109,6 +113,7 @@ private:
     bool m_hexRunning {false};
     TabEngineBridge m_tabBridge;
     DetectionTuningController m_tuningController;
+    AudioTelemetry m_telemetry;
     RunSessionOptions m_runOptions;
     QString m_testSessionName;
     QString m_testPlaybackState {QStringLiteral("Stopped")};
@@ -0,0 +1,79 @@
+#include "Decimator.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+constexpr int kTapsPerPhase = 16;
+// Blackman main-lobe transition width, in units of inputRate / taps.
+constexpr float kBlackmanTransition = 5.5f;
+}
+
+void Decimator::configure(int factor, float passbandHz, float inputRate) {
+  _factor = std::clamp(factor, 1, kMaxFactor);
+  _taps.clear();
+  _delay.clear();
+  if (_factor <= 1 || inputRate <= 0.f) {
+    _factor = 1;
+    return;
+  }
+
+  const int count = kTapsPerPhase * _factor + 1;
+  const float outputNyquist = 0.5f * inputRate / static_cast<float>(_factor);
+  const float transition = kBlackmanTransition * inputRate / static_cast<float>(count);
+  // Put the stopband edge at the output Nyquist, but never cut into the passband.
+  const float cutoffHz = std::clamp(outputNyquist - 0.5f * transition, passbandHz, outputNyquist);
+  const float fc = cutoffHz / inputRate;
+
+  _taps.resize(static_cast<std::size_t>(count));
+  const float centre = 0.5f * static_cast<float>(count - 1);
+  for (int k = 0; k < count; ++k) {
+    const float x = static_cast<float>(k) - centre;
+    const float sinc = (x == 0.f) ? 2.f * fc : std::sin(2.f * float(M_PI) * fc * x) / (float(M_PI) * x);
+    const float phase = 2.f * float(M_PI) * static_cast<float>(k) / static_cast<float>(count - 1);
+    const float window = 0.42f - 0.5f * std::cos(phase) + 0.08f * std::cos(2.f * phase);
+    _taps[static_cast<std::size_t>(k)] = sinc * window;
+  }
+  const float dc = std::accumulate(_taps.begin(), _taps.end(), 0.f);
+  for (float& tap : _taps)
+    tap /= dc;
+
+  _delay.assign(2 * _taps.size(), 0.f);
+  reset();
+}
+
+void Decimator::reset() {
+  std::fill(_delay.begin(), _delay.end(), 0.f);
+  _pos = 0;
+  _skip = 0;
+}
+
+int Decimator::process(const float* in, int n, float* out) {
+  if (_factor <= 1) {
+    std::copy_n(in, std::max(n, 0), out);
+    return std::max(n, 0);
+  }
+
+  const std::size_t length = _taps.size();
+  const float* taps = _taps.data();
+  float* delay = _delay.data();
+  int produced = 0;
+  for (int i = 0; i < n; ++i) {
+    delay[_pos] = in[i];
+    delay[_pos + length] = in[i];
+    _pos = (_pos + 1 == length) ? 0 : _pos + 1;
+    if (_skip > 0) {
+      --_skip;
+      continue;
+    }
+    // delay[_pos .. _pos + length) now holds the last `length` inputs, oldest
+    // first; the taps are symmetric so no reversal is needed.
+    const float* window = delay + _pos;
+    float acc = 0.f;
+    for (std::size_t k = 0; k < length; ++k)
+      acc += taps[k] * window[k];
+    out[produced++] = acc;
+    _skip = _factor - 1;
+  }
+  return produced;
+}
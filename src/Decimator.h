@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Integer-factor FIR decimator used by StringTracker to run onset/pitch for the
+// low strings at a reduced rate. Only every factor-th output is computed
+// (polyphase form), so the cost is about taps/factor multiply-adds per input
+// sample. The windowed-sinc anti-alias filter is linear phase: an output
+// produced right after input sample i describes time i - groupDelaySamples().
+// configure() allocates; reset() and process() do not.
+class Decimator {
+public:
+  static constexpr int kMaxFactor = 4;
+
+  // factor <= 1 disables decimation. passbandHz is the highest frequency the
+  // caller needs kept flat; the cutoff never drops below it.
+  void configure(int factor, float passbandHz, float inputRate);
+  void reset();
+
+  int factor() const { return _factor; }
+  bool active() const { return _factor > 1; }
+  float groupDelaySamples() const { return _taps.empty() ? 0.f : 0.5f * static_cast<float>(_taps.size() - 1); }
+  // Input offset (relative to the next process() call) that produces its first output.
+  int nextOutputOffset() const { return _skip; }
+  static int maxOutput(int inputFrames, int factor) {
+    return factor > 1 ? (inputFrames + factor - 1) / factor : inputFrames;
+  }
+
+  // Writes at most maxOutput(n, factor()) samples to out and returns the count.
+  int process(const float* in, int n, float* out);
+
+private:
+  int _factor = 1;
+  int _skip = 0;
+  std::size_t _pos = 0;
+  std::vector<float> _taps;
+  std::vector<float> _delay; // two copies of the delay line so every dot product is contiguous
+};
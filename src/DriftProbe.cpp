@@ -0,0 +1,80 @@
+#include "DriftProbe.h"
+#include "util.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Lowest note probed, below the open string for detuning.
+constexpr int kLowMarginSemitones = 1;
+// Probe lags sit this far either side of the held period (about 25 cents),
+// and at least one sample apart.
+constexpr float kStepRatio = 0.0145f;
+// A held note repeats almost exactly from one period to the next; below this
+// the hop is something else.
+constexpr float kMinCorrelation = 0.8f;
+constexpr float kLevelFloor = 1.0e-20f;
+}
+
+void DriftProbe::configure(float sampleRate, int hopSize, int openMidi) {
+  _hopSize = 0;
+  if (sampleRate <= 0.f || hopSize <= 0)
+    return;
+
+  _sampleRate = sampleRate;
+  const float lowestHz = midiToHz(openMidi - kLowMarginSemitones);
+  _maxLag = static_cast<int>(std::ceil(sampleRate / lowestHz * (1.f + kStepRatio))) + 2;
+  _history.assign(static_cast<std::size_t>(_maxLag + hopSize), 0.f);
+  _hopSize = hopSize;
+  reset();
+}
+
+void DriftProbe::reset() {
+  std::fill(_history.begin(), _history.end(), 0.f);
+  _correlation = 0.f;
+}
+
+void DriftProbe::push(const float* in, float gain) {
+  if (_hopSize <= 0)
+    return;
+  const std::size_t hop = static_cast<std::size_t>(_hopSize);
+  std::move(_history.begin() + static_cast<std::ptrdiff_t>(hop), _history.end(), _history.begin());
+  float* tail = _history.data() + (_history.size() - hop);
+  for (std::size_t i = 0; i < hop; ++i)
+    tail[i] = in ? in[i] * gain : 0.f;
+}
+
+float DriftProbe::correlate(int lag) const {
+  const std::size_t hop = static_cast<std::size_t>(_hopSize);
+  const float* now = _history.data() + (_history.size() - hop);
+  const float* past = now - lag;
+  float cross = 0.f;
+  float energy = 0.f;
+  for (std::size_t i = 0; i < hop; ++i) {
+    cross += now[i] * past[i];
+    energy += now[i] * now[i] + past[i] * past[i];
+  }
+  return energy > kLevelFloor ? 2.f * cross / energy : 0.f;
+}
+
+float DriftProbe::track(float hz) {
+  _correlation = 0.f;
+  if (_hopSize <= 0 || hz <= 0.f)
+    return -1.f;
+
+  const float period = _sampleRate / hz;
+  const int step = std::max(1, static_cast<int>(std::lround(period * kStepRatio)));
+  const int lag = static_cast<int>(std::lround(period));
+  if (lag - step < 1 || lag + step > _maxLag)
+    return -1.f;
+
+  const float a = correlate(lag - step);
+  const float b = correlate(lag);
+  const float c = correlate(lag + step);
+  _correlation = b;
+  if (b < kMinCorrelation || b < a || b < c)
+    return -1.f;
+
+  const float denom = a - 2.f * b + c;
+  const float shift = denom < 0.f ? std::clamp(0.5f * (a - c) / denom, -1.f, 1.f) : 0.f;
+  return _sampleRate / (static_cast<float>(lag) + shift * static_cast<float>(step));
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+
+// Cheap pitch follower for a note whose pitch is already known. Each call to
+// track() correlates the latest hop with itself one period back, at the held
+// period and about 25 cents either side, and refines the peak with a parabola:
+// three dot products of one hop, against the hundreds of lags a full estimate
+// scans. A hop that no longer repeats at that period (a slide past the probed
+// range, a new note, noise) reports -1 so the caller can estimate again.
+// configure() allocates; reset(), push() and track() do not.
+class DriftProbe {
+public:
+  void configure(float sampleRate, int hopSize, int openMidi);
+  void reset();
+
+  bool ready() const { return _hopSize > 0; }
+  int hopSize() const { return _hopSize; }
+
+  // Appends hopSize() samples of in, each multiplied by gain. Call every hop,
+  // probed or not, so the history stays continuous.
+  void push(const float* in, float gain);
+  // Pitch near hz in the latest hop, or -1 when the normalised correlation
+  // at hz's period falls below the probe's threshold or peaks outside the
+  // probed range.
+  float track(float hz);
+  float correlation() const { return _correlation; }
+
+private:
+  float correlate(int lag) const;
+
+  float _sampleRate = 0.f;
+  int _hopSize = 0;
+  int _maxLag = 0;
+  float _correlation = 0.f;
+
+  std::vector<float> _history;     // _maxLag + _hopSize samples, oldest first
+};
@@ -0,0 +1,93 @@
+#include "EventFuser.h"
+#include "NoteEventStore.h"
+#include <algorithm>
+
+void EventFuser::reset() {
+  _scanned = 0;
+  _prev.fill(-1);
+  _open.fill(-1);
+}
+
+void EventFuser::run(NoteEventStore& events, const std::vector<int>& activeIdx) {
+  // An open event sits before anything appended to its string since.
+  for (std::size_t s = 0; s < _open.size(); ++s) {
+    const int open = _open[s];
+    _open[s] = -1;
+    if (open >= 0 && open < _scanned)
+      fuse(events, open, activeIdx);
+  }
+  for (_scanned = std::max(_scanned, events.firstHandle()); _scanned < events.endHandle(); ++_scanned)
+    fuse(events, _scanned, activeIdx);
+}
+
+int EventFuser::settledHandle(const NoteEventStore& events, const std::vector<int>& activeIdx, float nowSec) const {
+  int settled = _scanned;
+  for (std::size_t s = 0; s < _open.size(); ++s) {
+    if (s < activeIdx.size() && activeIdx[s] >= 0)
+      settled = std::min(settled, activeIdx[s]);
+    if (_open[s] >= 0)
+      settled = std::min(settled, _open[s]);
+    if (const NoteEvent* prev = _prev[s] >= 0 ? events.find(_prev[s]) : nullptr) {
+      if (prev->endSec + kLegatoGapSec + kLateOnsetSec > nowSec)
+        settled = std::min(settled, _prev[s]);
+    }
+  }
+  return settled;
+}
+
+void EventFuser::fuse(NoteEventStore& events, int i, const std::vector<int>& activeIdx) {
+  NoteEvent* current = events.find(i);
+  if (!current)
+    return;
+  auto& ev = *current;
+  if (ev.stringIdx < 0 || ev.stringIdx >= 6)
+    return;
+  const std::size_t s = static_cast<std::size_t>(ev.stringIdx);
+  const bool open = s < activeIdx.size() && activeIdx[s] == i;
+
+  const bool finished = ev.endSec > ev.startSec;
+  if (!finished) {
+    if (open)
+      _open[s] = i;
+    return;
+  }
+
+  if (NoteEvent* previous = _prev[s] >= 0 ? events.find(_prev[s]) : nullptr) {
+    auto& prev = *previous;
+    if (prev.endSec > prev.startSec) {
+      const float gap = ev.startSec - prev.endSec;
+      if (gap >= 0.f && gap < kLegatoGapSec) {
+        const int delta = ev.fret - prev.fret;
+        const int absDelta = delta >= 0 ? delta : -delta;
+
+        if (absDelta >= 2) {
+          if (ev.articulation == Articulation::None)
+            ev.articulation = Articulation::Slide;
+          if (prev.articulation == Articulation::None)
+            prev.articulation = Articulation::Slide;
+        } else if (delta == 1 || delta == 2) {
+          if (ev.articulation == Articulation::None)
+            ev.articulation = Articulation::Hammer;
+        } else if (delta == -1 || delta == -2) {
+          if (ev.articulation == Articulation::None)
+            ev.articulation = Articulation::Pull;
+        } else if (absDelta == 0 && gap < 0.06f) {
+          if (ev.velocity < prev.velocity * 0.7f && ev.articulation == Articulation::None)
+            ev.articulation = Articulation::PalmMute;
+        }
+      }
+    }
+  }
+
+  if (ev.articulation == Articulation::None) {
+    const float duration = ev.endSec - ev.startSec;
+    if (duration < 0.18f && ev.velocity < 0.30f)
+      ev.articulation = Articulation::PalmMute;
+  }
+
+  // Still open: fused again next pass, and not yet anyone's predecessor.
+  if (open)
+    _open[s] = i;
+  else
+    _prev[s] = i;
+}
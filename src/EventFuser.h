@@ -0,0 +1,41 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <vector>
+
+class NoteEventStore;
+
+// Articulation rules over TabEngine's event list (hammer, pull, slide, palm
+// mute), run after every block. Only events on the same string interact, and
+// each only with the finished event before it. Every event but a string's
+// newest is closed and never changes again, so a closed event fused once is
+// final: each pass fuses the events appended since the last pass and each
+// string's still-open event, against the string's last final event. The
+// result is the same as rescanning the whole list every block, at a cost
+// that does not grow with the session. A predecessor the store has since
+// dropped is treated as absent.
+class EventFuser {
+public:
+  EventFuser() { reset(); }
+
+  // activeIdx[s] is the handle of string s's open event, or -1.
+  void run(NoteEventStore& events, const std::vector<int>& activeIdx);
+  // After the store is cleared or refilled.
+  void reset();
+  // Handles below the result will not change again: neither sounding nor
+  // still able to gain a mark from a note yet to come on their string (those
+  // arrive within kLegatoGapSec of the last note's end, allowing for the
+  // trackers dating a note up to kLateOnsetSec back). nowSec is the end of the
+  // last block run.
+  int settledHandle(const NoteEventStore& events, const std::vector<int>& activeIdx, float nowSec) const;
+
+  static constexpr float kLegatoGapSec = 0.12f;
+  static constexpr float kLateOnsetSec = 1.0f;
+
+private:
+  void fuse(NoteEventStore& events, int handle, const std::vector<int>& activeIdx);
+
+  int _scanned = 0;                  // handles seen so far
+  std::array<int, 6> _prev {};       // last closed, fused event per string
+  std::array<int, 6> _open {};       // open (or not yet finished) event per string
+};
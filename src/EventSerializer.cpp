@@ -0,0 +1,157 @@
+#include "EventSerializer.h"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+namespace {
+constexpr char kBinaryMagic[4] = {'G', 'P', 'E', 'V'};
+constexpr std::uint32_t kBinaryVersion = 1;
+constexpr std::size_t kBinaryHeaderBytes = 16;
+constexpr std::size_t kBinaryBytesPerEvent = 4 * sizeof(std::uint8_t) + 3 * sizeof(float);
+
+struct Cursor {
+  char* pos;
+  char* end;
+
+  void text(const char* s) {
+    const std::size_t length = std::min(std::strlen(s), static_cast<std::size_t>(end - pos));
+    std::memcpy(pos, s, length);
+    pos += length;
+  }
+  void integer(int value) {
+    pos = std::to_chars(pos, end, value).ptr;
+  }
+  void fixed(float value, int precision) {
+    const auto result = std::to_chars(pos, end, value, std::chars_format::fixed, precision);
+    if (result.ec == std::errc())
+      pos = result.ptr;
+  }
+};
+
+using FileHandle = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+FileHandle openFile(const std::string& path, const char* mode) {
+  return FileHandle(std::fopen(path.c_str(), mode), &std::fclose);
+}
+
+template <typename T, typename Field>
+unsigned char* writeColumn(unsigned char* out, const std::vector<NoteEvent>& events, Field field) {
+  for (const NoteEvent& event : events) {
+    const T value = field(event);
+    std::memcpy(out, &value, sizeof(T));
+    out += sizeof(T);
+  }
+  return out;
+}
+
+template <typename T, typename Field>
+const unsigned char* readColumn(const unsigned char* in, std::vector<NoteEvent>& events, Field field) {
+  for (NoteEvent& event : events) {
+    T value;
+    std::memcpy(&value, in, sizeof(T));
+    field(event, value);
+    in += sizeof(T);
+  }
+  return in;
+}
+}
+
+std::size_t writeEventJson(char* out, const NoteEvent& event) {
+  Cursor c {out, out + kMaxEventJsonChars};
+  c.text("{\"string\":");
+  c.integer(event.stringIdx);
+  c.text(",\"fret\":");
+  c.integer(event.fret);
+  c.text(",\"midi\":");
+  c.integer(event.midi);
+  c.text(",\"start\":");
+  c.fixed(event.startSec, 6);
+  c.text(",\"end\":");
+  c.fixed(event.endSec, 6);
+  c.text(",\"vel\":");
+  c.fixed(event.velocity, 3);
+  c.text(",\"art\":\"");
+  bool first = true;
+  for (unsigned bit = 0; bit < 8; ++bit) {
+    const auto mark = static_cast<Articulation>(1u << bit);
+    if (!hasArticulation(event.articulation, mark))
+      continue;
+    if (!first)
+      c.text("+");
+    first = false;
+    const std::string_view name = articulationName(mark);
+    const std::size_t length = std::min(name.size(), static_cast<std::size_t>(c.end - c.pos));
+    std::memcpy(c.pos, name.data(), length);
+    c.pos += length;
+  }
+  c.text("\"}");
+  return static_cast<std::size_t>(c.pos - out);
+}
+
+bool writeEventsBinary(const std::string& path, const std::vector<NoteEvent>& events) {
+  if constexpr (std::endian::native != std::endian::little)
+    return false;
+  std::vector<unsigned char> data(kBinaryHeaderBytes + events.size() * kBinaryBytesPerEvent);
+  const std::uint32_t header[3] = {kBinaryVersion, static_cast<std::uint32_t>(events.size()), 0};
+  std::memcpy(data.data(), kBinaryMagic, sizeof(kBinaryMagic));
+  std::memcpy(data.data() + sizeof(kBinaryMagic), header, sizeof(header));
+  unsigned char* out = data.data() + kBinaryHeaderBytes;
+  out = writeColumn<std::int8_t>(out, events, [](const NoteEvent& e) { return e.stringIdx; });
+  out = writeColumn<std::int8_t>(out, events, [](const NoteEvent& e) { return e.fret; });
+  out = writeColumn<std::int8_t>(out, events, [](const NoteEvent& e) { return e.midi; });
+  out = writeColumn<std::uint8_t>(out, events, [](const NoteEvent& e) { return static_cast<std::uint8_t>(e.articulation); });
+  out = writeColumn<float>(out, events, [](const NoteEvent& e) { return e.startSec; });
+  out = writeColumn<float>(out, events, [](const NoteEvent& e) { return e.endSec; });
+  writeColumn<float>(out, events, [](const NoteEvent& e) { return e.velocity; });
+
+  FileHandle file = openFile(path, "wb");
+  if (!file)
+    return false;
+  return std::fwrite(data.data(), 1, data.size(), file.get()) == data.size()
+      && std::fflush(file.get()) == 0;
+}
+
+bool readEventsBinary(const std::string& path, std::vector<NoteEvent>& events) {
+  if constexpr (std::endian::native != std::endian::little)
+    return false;
+  FileHandle file = openFile(path, "rb");
+  if (!file)
+    return false;
+  unsigned char header[kBinaryHeaderBytes];
+  if (std::fread(header, 1, sizeof(header), file.get()) != sizeof(header)
+      || std::memcmp(header, kBinaryMagic, sizeof(kBinaryMagic)) != 0)
+    return false;
+  std::uint32_t fields[3];
+  std::memcpy(fields, header + sizeof(kBinaryMagic), sizeof(fields));
+  if (fields[0] != kBinaryVersion)
+    return false;
+
+  // The columns must fill the rest of the file exactly.
+  const std::size_t count = fields[1];
+  const long columnsStart = std::ftell(file.get());
+  if (columnsStart < 0 || std::fseek(file.get(), 0, SEEK_END) != 0)
+    return false;
+  const long fileEnd = std::ftell(file.get());
+  if (fileEnd < columnsStart || static_cast<std::size_t>(fileEnd - columnsStart) != count * kBinaryBytesPerEvent
+      || std::fseek(file.get(), columnsStart, SEEK_SET) != 0)
+    return false;
+  std::vector<unsigned char> data(count * kBinaryBytesPerEvent);
+  if (std::fread(data.data(), 1, data.size(), file.get()) != data.size())
+    return false;
+
+  std::vector<NoteEvent> loaded(count);
+  const unsigned char* in = data.data();
+  in = readColumn<std::int8_t>(in, loaded, [](NoteEvent& e, std::int8_t v) { e.stringIdx = v; });
+  in = readColumn<std::int8_t>(in, loaded, [](NoteEvent& e, std::int8_t v) { e.fret = v; });
+  in = readColumn<std::int8_t>(in, loaded, [](NoteEvent& e, std::int8_t v) { e.midi = v; });
+  in = readColumn<std::uint8_t>(in, loaded, [](NoteEvent& e, std::uint8_t v) { e.articulation = static_cast<Articulation>(v); });
+  in = readColumn<float>(in, loaded, [](NoteEvent& e, float v) { e.startSec = v; });
+  in = readColumn<float>(in, loaded, [](NoteEvent& e, float v) { e.endSec = v; });
+  readColumn<float>(in, loaded, [](NoteEvent& e, float v) { e.velocity = v; });
+  events.swap(loaded);
+  return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "NoteEvent.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// JSON and binary forms of note events.
+//
+// JSON is an array of {"string","fret","midi","start","end","vel","art"}
+// objects, start/end with six decimals and vel with three. Each event is
+// formatted with std::to_chars into a fixed buffer, so writing allocates
+// only when the output string grows.
+//
+// events.bin is columnar, for reloading long takes without parsing: a
+// 16-byte header ("GPEV", version, event count, 0 as uint32), then one
+// column per field: int8 string, fret, midi, uint8 articulation bits, and
+// float32 start, end, velocity. Little-endian throughout.
+
+constexpr std::size_t kMaxEventJsonChars = 256;
+
+// Writes one event object (no separator) into out, which must hold
+// kMaxEventJsonChars; returns the length.
+std::size_t writeEventJson(char* out, const NoteEvent& event);
+
+// Appends the array of events (finished ones only if onlyFinished) to out.
+template <typename Events>
+void writeEventsJson(std::string& out, const Events& events, bool onlyFinished) {
+  char buffer[kMaxEventJsonChars];
+  out += '[';
+  bool first = true;
+  for (const NoteEvent& event : events) {
+    if (onlyFinished && event.endSec <= event.startSec)
+      continue;
+    if (!first)
+      out += ',';
+    first = false;
+    out.append(buffer, writeEventJson(buffer, event));
+  }
+  out += ']';
+}
+
+bool writeEventsBinary(const std::string& path, const std::vector<NoteEvent>& events);
+// Replaces events with the file's; false (events untouched) when the file is
+// missing, truncated or not an events.bin.
+bool readEventsBinary(const std::string& path, std::vector<NoteEvent>& events);
@@ -0,0 +1,262 @@
+#include "FretBank.h"
+#include "util.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Periods of each fret's fundamental per window: short enough to settle
+// within the tracker's onset hold (49 ms on the open low E). Adjacent frets
+// (6% apart) sit inside the fundamental's main lobe at this length; the upper
+// harmonics, whose lobes are proportionally narrower, tell them apart.
+constexpr int kWindowCycles = 4;
+// Harmonics are scored up to this many octaves above the open string, the
+// same ceiling for every fret: the open string gets eight, the 24th fret two.
+constexpr int kHarmonicOctaves = 3;
+// A fret an octave, a twelfth or two octaves up explains a subset of the
+// chosen fret's harmonics; a sub-harmonic candidate explains about as much as
+// the true note, so the higher one wins when it comes this close.
+constexpr double kSubharmonicRatio = 0.85;
+constexpr int kHarmonicIntervals[] = {24, 19, 12};
+constexpr double kTwoPi = 6.283185307179586;
+constexpr double kMaxCents = 100.0;
+// The phase reference must already hold the note: right after an onset the
+// bin one window back is mostly the previous note or silence, and its phase
+// says nothing about this one. Until then the bin centre is reported.
+constexpr double kSteadyRatio = 0.5;
+constexpr double kLevelFloor = 1.0e-20;
+// Bins this close to Nyquist alias; leave them out.
+constexpr double kMaxOmega = 0.9 * 3.141592653589793;
+constexpr std::size_t kDotLanes = 4;
+
+// Independent partial sums per lane, so the loop vectorises without
+// -ffast-math (as in PitchEstimator).
+double dot(const double* a, const double* b, std::size_t n) {
+  double lanes[kDotLanes] {};
+  std::size_t i = 0;
+  for (; i + kDotLanes <= n; i += kDotLanes) {
+    for (std::size_t j = 0; j < kDotLanes; ++j)
+      lanes[j] += a[i + j] * b[i + j];
+  }
+  double acc = 0.0;
+  for (; i < n; ++i)
+    acc += a[i] * b[i];
+  for (std::size_t j = 0; j < kDotLanes; ++j)
+    acc += lanes[j];
+  return acc;
+}
+}
+
+void FretBank::configure(float sampleRate, int hopSize, int openMidi) {
+  _hopSize = 0;
+  if (sampleRate <= 0.f || hopSize <= 0)
+    return;
+
+  _sampleRate = sampleRate;
+  _openMidi = openMidi;
+  _window.assign(kFrets, 0);
+  _energy.assign(kFrets, 0.0);
+  _explained.assign(kFrets, 0.0);
+  _firstBin.assign(kFrets + 1, 0);
+  _omega.clear();
+  _harmonic.clear();
+
+  const double ceilingHz = midiToHz(openMidi) * std::exp2(kHarmonicOctaves);
+  int longest = 0;
+  for (int f = 0; f < kFrets; ++f) {
+    const double hz = midiToHz(openMidi + f);
+    const int window = std::max(hopSize, static_cast<int>(std::lround(kWindowCycles * sampleRate / hz)));
+    _window[static_cast<std::size_t>(f)] = window;
+    longest = std::max(longest, window);
+    _firstBin[static_cast<std::size_t>(f)] = static_cast<int>(_omega.size());
+    // The bin sits on the window's own period so every harmonic is a whole
+    // number of cycles, even after rounding the window to samples.
+    const double fundamental = kTwoPi * kWindowCycles / window;
+    for (int h = 1; h == 1 || hz * h <= ceilingHz * 1.001; ++h) {
+      const double omega = fundamental * h;
+      if (omega >= kMaxOmega)
+        break;
+      _omega.push_back(omega);
+      _harmonic.push_back(h);
+    }
+  }
+  _firstBin[kFrets] = static_cast<int>(_omega.size());
+
+  const std::size_t bins = _omega.size();
+  const std::size_t hop = static_cast<std::size_t>(hopSize);
+  _tableRe.assign(bins * hop, 0.0);
+  _tableIm.assign(bins * hop, 0.0);
+  _sumRe.assign(bins, 0.0);
+  _sumIm.assign(bins, 0.0);
+  for (std::size_t bin = 0; bin < bins; ++bin) {
+    for (std::size_t i = 0; i < hop; ++i) {
+      _tableRe[bin * hop + i] = std::cos(_omega[bin] * static_cast<double>(i));
+      _tableIm[bin * hop + i] = -std::sin(_omega[bin] * static_cast<double>(i));
+    }
+  }
+
+  std::size_t ring = 1;
+  while (ring < static_cast<std::size_t>(longest + hopSize))
+    ring <<= 1;
+  _history.assign(ring, 0.f);
+  _mask = ring - 1;
+  // One window of the longest fret, plus the current hop.
+  _pastHops = (longest + hopSize / 2) / hopSize + 1;
+  _pastRe.assign(static_cast<std::size_t>(_pastHops) * bins, 0.0);
+  _pastIm.assign(static_cast<std::size_t>(_pastHops) * bins, 0.0);
+  _current.assign(hop, 0.0);
+  _delta.assign(hop, 0.0);
+  _hopSize = hopSize;
+  reset();
+}
+
+void FretBank::reset() {
+  std::fill(_history.begin(), _history.end(), 0.f);
+  std::fill(_energy.begin(), _energy.end(), 0.0);
+  std::fill(_sumRe.begin(), _sumRe.end(), 0.0);
+  std::fill(_sumIm.begin(), _sumIm.end(), 0.0);
+  std::fill(_pastRe.begin(), _pastRe.end(), 0.0);
+  std::fill(_pastIm.begin(), _pastIm.end(), 0.0);
+  _written = 0;
+  _hopIndex = 0;
+}
+
+int FretBank::windowSize(int fret) const {
+  if (fret < 0 || fret >= static_cast<int>(_window.size()))
+    return 0;
+  return _window[static_cast<std::size_t>(fret)];
+}
+
+FretEstimate FretBank::process(const float* in, float gain) {
+  if (_hopSize <= 0)
+    return {};
+
+  const std::size_t hop = static_cast<std::size_t>(_hopSize);
+  const std::uint64_t start = _written;
+  double hopPower = 0.0;
+  for (std::size_t i = 0; i < hop; ++i) {
+    const float x = in ? in[i] * gain : 0.f;
+    _history[(start + i) & _mask] = x;
+    _current[i] = x;
+    hopPower += static_cast<double>(x) * x;
+  }
+  _written += hop;
+
+  for (int f = 0; f < kFrets; ++f) {
+    const std::uint64_t window = static_cast<std::uint64_t>(_window[static_cast<std::size_t>(f)]);
+    double energy = _energy[static_cast<std::size_t>(f)];
+    for (std::size_t i = 0; i < hop; ++i) {
+      const double old = _history[(start + i - window) & _mask];
+      _delta[i] = _current[i] - old;
+      energy += _current[i] * _current[i] - old * old;
+    }
+    _energy[static_cast<std::size_t>(f)] = std::max(0.0, energy);
+
+    for (int b = _firstBin[static_cast<std::size_t>(f)]; b < _firstBin[static_cast<std::size_t>(f) + 1]; ++b) {
+      const std::size_t bin = static_cast<std::size_t>(b);
+      // omega * N is a whole number of turns, so the sample leaving the
+      // window was entered with the same phasor as the one arriving.
+      const double dRe = dot(_delta.data(), _tableRe.data() + bin * hop, hop);
+      const double dIm = dot(_delta.data(), _tableIm.data() + bin * hop, hop);
+      // e^{-i omega n} at the first new sample, from the absolute sample
+      // count so no rotation error builds up.
+      const double phase = std::fmod(_omega[bin] * static_cast<double>(start), kTwoPi);
+      const double pRe = std::cos(phase);
+      const double pIm = -std::sin(phase);
+      _sumRe[bin] += dRe * pRe - dIm * pIm;
+      _sumIm[bin] += dRe * pIm + dIm * pRe;
+    }
+  }
+
+  const FretEstimate est = classify(hopPower / static_cast<double>(hop));
+  const std::size_t bins = _sumRe.size();
+  const std::ptrdiff_t slot = static_cast<std::ptrdiff_t>(static_cast<std::size_t>(_hopIndex) * bins);
+  std::copy(_sumRe.begin(), _sumRe.end(), _pastRe.begin() + slot);
+  std::copy(_sumIm.begin(), _sumIm.end(), _pastIm.begin() + slot);
+  _hopIndex = (_hopIndex + 1) % _pastHops;
+  return est;
+}
+
+FretEstimate FretBank::classify(double hopPower) {
+  FretEstimate est;
+  const double hopDb = 10.0 * std::log10(std::max(hopPower, kLevelFloor));
+  if (hopDb < _silenceDb)
+    return est;
+
+  // Power of a sinusoid of amplitude A is A^2 / 2, with A = 2 |sum| / N.
+  int best = -1;
+  for (int f = 0; f < kFrets; ++f) {
+    const std::size_t fret = static_cast<std::size_t>(f);
+    const double scale = 2.0 / (static_cast<double>(_window[fret]) * _window[fret]);
+    double power = 0.0;
+    for (int b = _firstBin[fret]; b < _firstBin[fret + 1]; ++b) {
+      const std::size_t bin = static_cast<std::size_t>(b);
+      power += scale * (_sumRe[bin] * _sumRe[bin] + _sumIm[bin] * _sumIm[bin]);
+    }
+    _explained[fret] = power;
+    if (best < 0 || power > _explained[static_cast<std::size_t>(best)])
+      best = f;
+  }
+  const double bestPower = _explained[static_cast<std::size_t>(best)];
+  for (int interval : kHarmonicIntervals) {
+    const int upper = best + interval;
+    if (upper < kFrets && _explained[static_cast<std::size_t>(upper)] >= kSubharmonicRatio * bestPower) {
+      best = upper;
+      break;
+    }
+  }
+
+  const std::size_t fret = static_cast<std::size_t>(best);
+  const double window = _window[fret];
+  const double meanPower = _energy[fret] / window;
+  if (meanPower <= kLevelFloor)
+    return est;
+  est.confidence = static_cast<float>(std::min(1.0, _explained[fret] / meanPower));
+  if (est.confidence < 1.f - _tolerance)
+    return est;
+
+  // The fundamental carries the phase estimate unless a harmonic is more
+  // than twice as strong.
+  const std::size_t first = static_cast<std::size_t>(_firstBin[fret]);
+  std::size_t carrier = first;
+  double carrierMag = 0.0;
+  for (int b = _firstBin[fret]; b < _firstBin[fret + 1]; ++b) {
+    const std::size_t bin = static_cast<std::size_t>(b);
+    const double mag = std::hypot(_sumRe[bin], _sumIm[bin]);
+    if (mag > carrierMag) {
+      carrierMag = mag;
+      carrier = bin;
+    }
+  }
+  const double firstMag = std::hypot(_sumRe[first], _sumIm[first]);
+  if (firstMag >= 0.5 * carrierMag) {
+    carrier = first;
+    carrierMag = firstMag;
+  }
+
+  // The windowed sum of a steady partial at omega0 turns by (omega0 - omega)
+  // per sample. Over one hop that is a fraction of a radian for the low
+  // frets, swamped by leakage from the negative-frequency image, so measure
+  // it over about one window (window / h for harmonic h keeps the advance
+  // within +-pi up to 100 cents).
+  const int lagHops = std::clamp(static_cast<int>(std::lround(window / (_harmonic[carrier] * static_cast<double>(_hopSize)))),
+                                 1, _pastHops - 1);
+  const std::size_t past = static_cast<std::size_t>((_hopIndex - lagHops + _pastHops) % _pastHops) * _sumRe.size() + carrier;
+  double cents = 0.0;
+  const double pastRe = _pastRe[past];
+  const double pastIm = _pastIm[past];
+  if (carrierMag > 0.0 && std::hypot(pastRe, pastIm) >= kSteadyRatio * carrierMag) {
+    const double re = _sumRe[carrier] * pastRe + _sumIm[carrier] * pastIm;
+    const double im = _sumIm[carrier] * pastRe - _sumRe[carrier] * pastIm;
+    const double omega = _omega[carrier];
+    const double measured = omega + std::atan2(im, re) / static_cast<double>(lagHops * _hopSize);
+    if (measured > 0.0)
+      cents = std::clamp(1200.0 * std::log2(measured / omega), -kMaxCents, kMaxCents);
+  }
+
+  // omega is the window's rounded period, not the fret's exact pitch.
+  const double binHz = _omega[first] * _sampleRate / kTwoPi;
+  est.fret = best;
+  est.hz = static_cast<float>(binHz * std::exp2(cents / 1200.0));
+  est.cents = centsBetween(est.hz, midiToHz(_openMidi + best));
+  return est;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Pitch for one string as a classifier over the notes it can actually play:
+// one sliding-DFT bin per fret (open .. open + 24) and harmonic, up to three
+// octaves above the open string, so a hop costs O(frets * harmonics * hop)
+// whatever the window length. Each fret integrates a whole number of its own
+// periods, which puts all of its harmonics on bin centres; a hop updates each
+// bin with two dot products of (new - leaving) samples against a table of
+// e^{-i omega i}. The fret
+// whose harmonics explain the most power wins (the higher of two candidates
+// an octave or a twelfth apart when they nearly tie), and the phase advance
+// of its strongest bin over about one window gives the cents offset (bends,
+// detuning). Confidence is the share of the window's power explained. Sums
+// are kept in double and the reference phasors are re-derived from the sample
+// count every hop, so the recursion does not drift over long sessions.
+// configure() allocates; reset() and process() do not.
+
+struct FretEstimate {
+  int   fret = -1;            // 0 .. FretBank::kFrets - 1, -1 when unvoiced
+  float cents = 0.f;          // offset from the fret's equal-tempered pitch
+  float confidence = 0.f;     // 0..1
+  float hz = -1.f;
+};
+
+class FretBank {
+public:
+  static constexpr int kFrets = 25;
+
+  void configure(float sampleRate, int hopSize, int openMidi);
+  void reset();
+
+  // Voiced when the explained power reaches 1 - tolerance.
+  void setTolerance(float tolerance) { _tolerance = tolerance; }
+  void setSilenceDb(float db) { _silenceDb = db; }
+
+  bool ready() const { return _hopSize > 0; }
+  int hopSize() const { return _hopSize; }
+  int windowSize(int fret) const;   // samples integrated for fret
+  int binCount() const { return static_cast<int>(_omega.size()); }
+
+  // Appends hopSize() samples of in, each multiplied by gain.
+  FretEstimate process(const float* in, float gain);
+
+private:
+  FretEstimate classify(double hopPower);
+
+  float _sampleRate = 0.f;
+  int _hopSize = 0;
+  int _openMidi = 0;
+  float _tolerance = 0.5f;
+  float _silenceDb = -70.f;
+
+  std::vector<float> _history;     // power-of-two ring of past input
+  std::size_t _mask = 0;
+  std::uint64_t _written = 0;      // samples appended since reset()
+  std::vector<double> _current;    // this hop's samples
+  std::vector<double> _delta;      // this hop minus the hop leaving one fret's window
+
+  // Per fret.
+  std::vector<int> _window;
+  std::vector<double> _energy;     // running sum of squares over the fret's window
+
+  std::vector<double> _explained;  // power explained by the fret's harmonics, this hop
+  std::vector<int> _firstBin;      // kFrets + 1 offsets into the bin arrays
+
+  // Per bin, fret-major, harmonics ascending; none at or near Nyquist.
+  std::vector<double> _omega;      // radians per sample
+  std::vector<int> _harmonic;
+  std::vector<double> _tableRe;    // hopSize samples of e^{-i omega i} per bin
+  std::vector<double> _tableIm;
+  std::vector<double> _sumRe;      // sum over the window of x[m] e^{-i omega m}
+  std::vector<double> _sumIm;
+  std::vector<double> _pastRe;     // _sum at the end of each of the last _pastHops hops
+  std::vector<double> _pastIm;
+  int _pastHops = 0;
+  int _hopIndex = 0;               // hops processed since reset(), modulo _pastHops
+};
@@ -0,0 +1,243 @@
+#include "HexBlockKernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HEX_KERNEL_X86 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define HEX_KERNEL_NEON 1
+#endif
+
+namespace {
+
+// Present strings packed to the front so the inner loops never branch on
+// missing channels.
+struct Lanes {
+  int count = 0;
+  int index[6] {};
+  const float* src[6] {};
+  float* dst[6] {};
+  float gain[6] {};
+  float sumSq[6] {};
+  float peak[6] {};
+};
+
+using KernelFn = void (*)(Lanes&, int frames, float mixScale, float* monitorStereo);
+
+void scalarRange(Lanes& lanes, int begin, int end, float mixScale, float* monitorStereo) {
+  for (int i = begin; i < end; ++i) {
+    float mix = 0.f;
+    for (int k = 0; k < lanes.count; ++k) {
+      const float v = lanes.src[k][i] * lanes.gain[k];
+      lanes.dst[k][i] = v;
+      lanes.sumSq[k] += v * v;
+      lanes.peak[k] = std::max(lanes.peak[k], std::fabs(v));
+      mix += v;
+    }
+    if (monitorStereo) {
+      const float mono = mix * mixScale;
+      monitorStereo[2 * i] = mono;
+      monitorStereo[2 * i + 1] = mono;
+    }
+  }
+}
+
+void kernelScalar(Lanes& lanes, int frames, float mixScale, float* monitorStereo) {
+  scalarRange(lanes, 0, frames, mixScale, monitorStereo);
+}
+
+#if defined(HEX_KERNEL_X86)
+void kernelSse2(Lanes& lanes, int frames, float mixScale, float* monitorStereo) {
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  const __m128 scale = _mm_set1_ps(mixScale);
+  __m128 gain[6];
+  __m128 acc[6];
+  __m128 peak[6];
+  for (int k = 0; k < lanes.count; ++k) {
+    gain[k] = _mm_set1_ps(lanes.gain[k]);
+    acc[k] = _mm_setzero_ps();
+    peak[k] = _mm_setzero_ps();
+  }
+
+  int i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    __m128 mix = _mm_setzero_ps();
+    for (int k = 0; k < lanes.count; ++k) {
+      const __m128 v = _mm_mul_ps(_mm_loadu_ps(lanes.src[k] + i), gain[k]);
+      _mm_storeu_ps(lanes.dst[k] + i, v);
+      acc[k] = _mm_add_ps(acc[k], _mm_mul_ps(v, v));
+      peak[k] = _mm_max_ps(peak[k], _mm_and_ps(v, absMask));
+      mix = _mm_add_ps(mix, v);
+    }
+    if (monitorStereo) {
+      mix = _mm_mul_ps(mix, scale);
+      _mm_storeu_ps(monitorStereo + 2 * i, _mm_unpacklo_ps(mix, mix));
+      _mm_storeu_ps(monitorStereo + 2 * i + 4, _mm_unpackhi_ps(mix, mix));
+    }
+  }
+
+  for (int k = 0; k < lanes.count; ++k) {
+    alignas(16) float a[4];
+    alignas(16) float p[4];
+    _mm_store_ps(a, acc[k]);
+    _mm_store_ps(p, peak[k]);
+    lanes.sumSq[k] = (a[0] + a[1]) + (a[2] + a[3]);
+    lanes.peak[k] = std::max(std::max(p[0], p[1]), std::max(p[2], p[3]));
+  }
+  scalarRange(lanes, i, frames, mixScale, monitorStereo);
+}
+
+__attribute__((target("avx")))
+void kernelAvx(Lanes& lanes, int frames, float mixScale, float* monitorStereo) {
+  const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  const __m256 scale = _mm256_set1_ps(mixScale);
+  __m256 gain[6];
+  __m256 acc[6];
+  __m256 peak[6];
+  for (int k = 0; k < lanes.count; ++k) {
+    gain[k] = _mm256_set1_ps(lanes.gain[k]);
+    acc[k] = _mm256_setzero_ps();
+    peak[k] = _mm256_setzero_ps();
+  }
+
+  int i = 0;
+  for (; i + 8 <= frames; i += 8) {
+    __m256 mix = _mm256_setzero_ps();
+    for (int k = 0; k < lanes.count; ++k) {
+      const __m256 v = _mm256_mul_ps(_mm256_loadu_ps(lanes.src[k] + i), gain[k]);
+      _mm256_storeu_ps(lanes.dst[k] + i, v);
+      acc[k] = _mm256_add_ps(acc[k], _mm256_mul_ps(v, v));
+      peak[k] = _mm256_max_ps(peak[k], _mm256_and_ps(v, absMask));
+      mix = _mm256_add_ps(mix, v);
+    }
+    if (monitorStereo) {
+      mix = _mm256_mul_ps(mix, scale);
+      const __m256 lo = _mm256_unpacklo_ps(mix, mix);
+      const __m256 hi = _mm256_unpackhi_ps(mix, mix);
+      _mm256_storeu_ps(monitorStereo + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+      _mm256_storeu_ps(monitorStereo + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+  }
+
+  for (int k = 0; k < lanes.count; ++k) {
+    alignas(32) float a[8];
+    alignas(32) float p[8];
+    _mm256_store_ps(a, acc[k]);
+    _mm256_store_ps(p, peak[k]);
+    lanes.sumSq[k] = ((a[0] + a[1]) + (a[2] + a[3])) + ((a[4] + a[5]) + (a[6] + a[7]));
+    float m = p[0];
+    for (int j = 1; j < 8; ++j)
+      m = std::max(m, p[j]);
+    lanes.peak[k] = m;
+  }
+  _mm256_zeroupper();
+  scalarRange(lanes, i, frames, mixScale, monitorStereo);
+}
+#endif
+
+#if defined(HEX_KERNEL_NEON)
+void kernelNeon(Lanes& lanes, int frames, float mixScale, float* monitorStereo) {
+  const float32x4_t scale = vdupq_n_f32(mixScale);
+  float32x4_t gain[6];
+  float32x4_t acc[6];
+  float32x4_t peak[6];
+  for (int k = 0; k < lanes.count; ++k) {
+    gain[k] = vdupq_n_f32(lanes.gain[k]);
+    acc[k] = vdupq_n_f32(0.f);
+    peak[k] = vdupq_n_f32(0.f);
+  }
+
+  int i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    float32x4_t mix = vdupq_n_f32(0.f);
+    for (int k = 0; k < lanes.count; ++k) {
+      const float32x4_t v = vmulq_f32(vld1q_f32(lanes.src[k] + i), gain[k]);
+      vst1q_f32(lanes.dst[k] + i, v);
+      acc[k] = vfmaq_f32(acc[k], v, v);
+      peak[k] = vmaxq_f32(peak[k], vabsq_f32(v));
+      mix = vaddq_f32(mix, v);
+    }
+    if (monitorStereo) {
+      mix = vmulq_f32(mix, scale);
+      float32x4x2_t stereo {{mix, mix}};
+      vst2q_f32(monitorStereo + 2 * i, stereo);
+    }
+  }
+
+  for (int k = 0; k < lanes.count; ++k) {
+    lanes.sumSq[k] = vaddvq_f32(acc[k]);
+    lanes.peak[k] = vmaxvq_f32(peak[k]);
+  }
+  scalarRange(lanes, i, frames, mixScale, monitorStereo);
+}
+#endif
+
+struct KernelChoice {
+  KernelFn fn;
+  const char* isa;
+};
+
+KernelChoice selectKernel() {
+  const char* forced = std::getenv("GUITARPI_HEX_KERNEL");
+  if (forced && std::strcmp(forced, "scalar") == 0)
+    return {&kernelScalar, "scalar"};
+#if defined(HEX_KERNEL_X86)
+  __builtin_cpu_init();
+  const bool avxAllowed = !(forced && std::strcmp(forced, "sse2") == 0);
+  if (avxAllowed && __builtin_cpu_supports("avx"))
+    return {&kernelAvx, "avx"};
+  return {&kernelSse2, "sse2"};
+#elif defined(HEX_KERNEL_NEON)
+  return {&kernelNeon, "neon"};
+#else
+  return {&kernelScalar, "scalar"};
+#endif
+}
+
+const KernelChoice g_kernel = selectKernel();
+
+} // namespace
+
+void processHexBlock(const float* const in[6],
+                     float* const out[6],
+                     const float gains[6],
+                     int frames,
+                     float monitorGain,
+                     float* monitorStereo,
+                     HexBlockStats& stats) {
+  stats = HexBlockStats{};
+  stats.frames = std::max(0, frames);
+
+  Lanes lanes;
+  for (int s = 0; s < 6; ++s) {
+    if (!in[s] || !out[s])
+      continue;
+    stats.present[static_cast<std::size_t>(s)] = true;
+    lanes.index[lanes.count] = s;
+    lanes.src[lanes.count] = in[s];
+    lanes.dst[lanes.count] = out[s];
+    lanes.gain[lanes.count] = gains ? gains[s] : 1.f;
+    ++lanes.count;
+  }
+
+  if (frames <= 0)
+    return;
+
+  g_kernel.fn(lanes, frames, monitorGain / 6.f, monitorStereo);
+
+  const float invFrames = 1.f / static_cast<float>(frames);
+  for (int k = 0; k < lanes.count; ++k) {
+    const std::size_t slot = static_cast<std::size_t>(lanes.index[k]);
+    stats.rms[slot] = std::sqrt(lanes.sumSq[k] * invFrames);
+    stats.peak[slot] = lanes.peak[k];
+  }
+}
+
+const char* hexBlockKernelIsa() {
+  return g_kernel.isa;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <array>
+
+// Per-block statistics produced by processHexBlock(). Downstream stages
+// (meters, TabEngineBridge, StringTracker) reuse these instead of rescanning.
+struct HexBlockStats {
+  std::array<float, 6> rms {0.f, 0.f, 0.f, 0.f, 0.f, 0.f};
+  std::array<float, 6> peak {0.f, 0.f, 0.f, 0.f, 0.f, 0.f};
+  std::array<bool, 6> present {false, false, false, false, false, false};
+  int frames = 0;
+};
+
+// Single pass over a hex block: out[s] = in[s] * gains[s], per-string RMS and
+// absolute peak of the calibrated signal, and (when monitorStereo is non-null)
+// the interleaved stereo monitor mix sum(out) / 6 * monitorGain.
+// in[s] may be nullptr (silent string); out[s] may alias in[s].
+void processHexBlock(const float* const in[6],
+                     float* const out[6],
+                     const float gains[6],
+                     int frames,
+                     float monitorGain,
+                     float* monitorStereo,
+                     HexBlockStats& stats);
+
+// Name of the instruction set selected at runtime ("avx", "sse2", "neon", "scalar").
+const char* hexBlockKernelIsa();
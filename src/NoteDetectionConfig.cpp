@@ -19,6 +19,13 @@ constexpr std::array<float, 6> kDefaultAubioThresholdScale {{1.2f, 1.35f, 1.6f,
 constexpr std::array<float, 6> kDefaultOnsetSilenceDb {{-85.f, -85.f, -75.f, -75.f, -75.f, -75.f}};
 constexpr std::array<float, 6> kDefaultPitchSilenceDb {{-90.f, -90.f, -80.f, -80.f, -80.f, -80.f}};
 
+// Stage masks for the descriptors below. Target RMS and the gain multiplier
+// are applied by calibration, outside the trackers.
+constexpr unsigned kFilter = noteStageBit(NoteStage::Filter);
+constexpr unsigned kOnset = noteStageBit(NoteStage::Onset);
+constexpr unsigned kPitch = noteStageBit(NoteStage::Pitch);
+constexpr unsigned kDecision = noteStageBit(NoteStage::Decision);
+
 constexpr std::array<const char*, 6> kDefaultStringLabels {{"E", "A", "D", "G", "B", "e"}};
 
 NoteDetectionParameterSet fromDefaults() {
@@ -42,21 +49,21 @@ NoteDetectionParameterSet fromDefaults() {
 }
 
 const std::array<ParameterDescriptor, 15> kDescriptors {{
-    {NoteParameter::OnsetThresholdScale, "onsetThresholdScale", "Onset Threshold", "Aubio onset detection threshold (spectral flux).", 0.02f, 4.0f, 0.001f, false},
-    {NoteParameter::BaselineFloor, "baselineFloor", "Baseline Floor", "Adaptive noise floor estimate.", 0.00002f, 0.0100f, 0.00001f, false},
-    {NoteParameter::EnvelopeFloor, "envelopeFloor", "Envelope Floor", "Minimum RMS before envelope resets to zero.", 0.00005f, 0.0080f, 0.00005f, false},
-    {NoteParameter::GateRatio, "gateRatio", "Gate Ratio", "Multiplier applied to baseline floor for note-on decisions.", 0.005f, 10.0f, 0.005f, false},
-    {NoteParameter::SustainFloorScale, "sustainFloorScale", "Sustain Floor Scale", "Multiplier applied to envelope floor for note-off decisions.", 0.10f, 2.5f, 0.01f, false},
-    {NoteParameter::RetriggerGateScale, "retriggerGateScale", "Retrigger Gate Scale", "Threshold multiplier used to retrigger open strings.", 0.20f, 3.0f, 0.01f, false},
-    {NoteParameter::PeakReleaseRatio, "peakReleaseRatio", "Peak Release Ratio", "Envelope decay target expressed as fraction of recent peak.", 0.02f, 0.60f, 0.005f, false},
-    {NoteParameter::PitchTolerance, "pitchTolerance", "Pitch Tolerance", "Maximum cents deviation allowed per hop before smoothing.", 0.2f, 1.0f, 0.01f, false},
-    {NoteParameter::TargetRms, "targetRms", "Target RMS", "Target RMS level for normalized signal.", 0.0001f, 0.35f, 0.0001f, false},
-    {NoteParameter::CalibrationGainMultiplier, "calibrationGainMultiplier", "Gain Multiplier", "Fine-tune multiplier applied to calculated calibration gain.", 0.2f, 8.0f, 0.01f, false},
-    {NoteParameter::LowCutMultiplier, "lowCutMultiplier", "Low Cut Multiplier", "Multiplier applied to open-string pitch to derive HPF cutoff.", 0.3f, 0.9f, 0.01f, false},
-    {NoteParameter::HighCutMultiplier, "highCutMultiplier", "High Cut Multiplier", "Multiplier applied to 24th-fret pitch to derive LPF cutoff.", 0.8f, 1.8f, 0.02f, false},
-    {NoteParameter::AubioThresholdScale, "aubioThresholdScale", "Onset Threshold (aubio)", "Scaling factor for aubio onset detection threshold.", 0.5f, 3.0f, 0.05f, false},
-    {NoteParameter::OnsetSilenceDb, "onsetSilenceDb", "Onset Silence (dB)", "Silence level fed to aubio onset detector.", -120.f, -30.f, 1.f, true},
-    {NoteParameter::PitchSilenceDb, "pitchSilenceDb", "Pitch Silence (dB)", "Silence level fed to aubio pitch tracker.", -120.f, -30.f, 1.f, true}
+    {NoteParameter::OnsetThresholdScale, "onsetThresholdScale", "Onset Threshold", "Aubio onset detection threshold (spectral flux).", 0.02f, 4.0f, 0.001f, false, kDecision},
+    {NoteParameter::BaselineFloor, "baselineFloor", "Baseline Floor", "Adaptive noise floor estimate.", 0.00002f, 0.0100f, 0.00001f, false, kDecision},
+    {NoteParameter::EnvelopeFloor, "envelopeFloor", "Envelope Floor", "Minimum RMS before envelope resets to zero.", 0.00005f, 0.0080f, 0.00005f, false, kDecision},
+    {NoteParameter::GateRatio, "gateRatio", "Gate Ratio", "Multiplier applied to baseline floor for note-on decisions.", 0.005f, 10.0f, 0.005f, false, kDecision},
+    {NoteParameter::SustainFloorScale, "sustainFloorScale", "Sustain Floor Scale", "Multiplier applied to envelope floor for note-off decisions.", 0.10f, 2.5f, 0.01f, false, kDecision},
+    {NoteParameter::RetriggerGateScale, "retriggerGateScale", "Retrigger Gate Scale", "Threshold multiplier used to retrigger open strings.", 0.20f, 3.0f, 0.01f, false, kDecision},
+    {NoteParameter::PeakReleaseRatio, "peakReleaseRatio", "Peak Release Ratio", "Envelope decay target expressed as fraction of recent peak.", 0.02f, 0.60f, 0.005f, false, kDecision},
+    {NoteParameter::PitchTolerance, "pitchTolerance", "Pitch Tolerance", "Maximum cents deviation allowed per hop before smoothing.", 0.2f, 1.0f, 0.01f, false, kPitch},
+    {NoteParameter::TargetRms, "targetRms", "Target RMS", "Target RMS level for normalized signal.", 0.0001f, 0.35f, 0.0001f, false, 0},
+    {NoteParameter::CalibrationGainMultiplier, "calibrationGainMultiplier", "Gain Multiplier", "Fine-tune multiplier applied to calculated calibration gain.", 0.2f, 8.0f, 0.01f, false, 0},
+    {NoteParameter::LowCutMultiplier, "lowCutMultiplier", "Low Cut Multiplier", "Multiplier applied to open-string pitch to derive HPF cutoff.", 0.3f, 0.9f, 0.01f, false, kFilter},
+    {NoteParameter::HighCutMultiplier, "highCutMultiplier", "High Cut Multiplier", "Multiplier applied to 24th-fret pitch to derive LPF cutoff.", 0.8f, 1.8f, 0.02f, false, kFilter},
+    {NoteParameter::AubioThresholdScale, "aubioThresholdScale", "Onset Threshold (aubio)", "Scaling factor for aubio onset detection threshold.", 0.5f, 3.0f, 0.05f, false, kOnset},
+    {NoteParameter::OnsetSilenceDb, "onsetSilenceDb", "Onset Silence (dB)", "Silence level fed to aubio onset detector.", -120.f, -30.f, 1.f, true, kOnset},
+    {NoteParameter::PitchSilenceDb, "pitchSilenceDb", "Pitch Silence (dB)", "Silence level fed to aubio pitch tracker.", -120.f, -30.f, 1.f, true, kPitch}
 }};
 
 } // namespace
@@ -43,6 +43,21 @@ enum class NoteParameter {
 
 inline constexpr int kNumStrings = 6;
 
+// Parts of a string tracker a parameter feeds. An edit reconfigures only the
+// stages its descriptor lists, on the edited string.
+enum class NoteStage {
+    Filter,     // band-pass edges (and the decimator's passband)
+    Onset,      // onset detector threshold and silence level
+    Pitch,      // pitch estimator tolerance and silence level
+    Decision    // note-on/off thresholds, read per hop
+};
+
+inline constexpr int kNumNoteStages = 4;
+
+constexpr unsigned noteStageBit(NoteStage stage) {
+    return 1u << static_cast<unsigned>(stage);
+}
+
 struct ParameterDescriptor {
     NoteParameter id;
     std::string key;
@@ -52,6 +67,7 @@ struct ParameterDescriptor {
     float maxValue;
     float step;
     bool useDecibels;
+    unsigned stages;    // noteStageBit() of each stage that reads it; 0 for calibration-only values
 };
 
 const std::array<ParameterDescriptor, 15>& parameterDescriptors();
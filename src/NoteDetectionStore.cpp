@@ -1,11 +1,37 @@
 #include "NoteDetectionStore.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstdarg>
 
 namespace {
 
+// readActive() gives up after this many torn copies rather than spin on the
+// audio thread.
+constexpr int kReadActiveAttempts = 4;
+
+const std::array<float, 6>& column(const NoteDetectionParameterSet& set, NoteParameter id) {
+    switch (id) {
+        case NoteParameter::OnsetThresholdScale: return set.onsetThresholdScale;
+        case NoteParameter::BaselineFloor: return set.baselineFloor;
+        case NoteParameter::EnvelopeFloor: return set.envelopeFloor;
+        case NoteParameter::GateRatio: return set.gateRatio;
+        case NoteParameter::SustainFloorScale: return set.sustainFloorScale;
+        case NoteParameter::RetriggerGateScale: return set.retriggerGateScale;
+        case NoteParameter::PeakReleaseRatio: return set.peakReleaseRatio;
+        case NoteParameter::PitchTolerance: return set.pitchTolerance;
+        case NoteParameter::TargetRms: return set.targetRms;
+        case NoteParameter::CalibrationGainMultiplier: return set.calibrationGainMultiplier;
+        case NoteParameter::LowCutMultiplier: return set.lowCutMultiplier;
+        case NoteParameter::HighCutMultiplier: return set.highCutMultiplier;
+        case NoteParameter::AubioThresholdScale: return set.aubioThresholdScale;
+        case NoteParameter::OnsetSilenceDb: return set.onsetSilenceDb;
+        case NoteParameter::PitchSilenceDb: return set.pitchSilenceDb;
+    }
+    return set.onsetThresholdScale;
+}
+
 void logStoreLookup(const char* stage, const std::string& key, int stringIdx, const float* value = nullptr) {
     std::fprintf(stderr,
                  "store %s key=%s string=%d",
@@ -33,7 +59,7 @@ void logStoreDetail(const char* fmt, ...) {
 void NoteDetectionParameterSetAtomic::store(const NoteDetectionParameterSet& source) {
     const auto transfer = [](auto& destArr, const auto& srcArr) {
         for (std::size_t i = 0; i < destArr.size(); ++i)
-            destArr[i].store(srcArr[i], std::memory_order_release);
+            destArr[i].store(srcArr[i], std::memory_order_relaxed);
     };
     transfer(onsetThresholdScale, source.onsetThresholdScale);
     transfer(baselineFloor, source.baselineFloor);
@@ -52,6 +78,28 @@ void NoteDetectionParameterSetAtomic::store(const NoteDetectionParameterSet& sou
     transfer(pitchSilenceDb, source.pitchSilenceDb);
 }
 
+void NoteDetectionParameterSetAtomic::load(NoteDetectionParameterSet& dest) const {
+    const auto transfer = [](auto& destArr, const auto& srcArr) {
+        for (std::size_t i = 0; i < destArr.size(); ++i)
+            destArr[i] = srcArr[i].load(std::memory_order_relaxed);
+    };
+    transfer(dest.onsetThresholdScale, onsetThresholdScale);
+    transfer(dest.baselineFloor, baselineFloor);
+    transfer(dest.envelopeFloor, envelopeFloor);
+    transfer(dest.gateRatio, gateRatio);
+    transfer(dest.sustainFloorScale, sustainFloorScale);
+    transfer(dest.retriggerGateScale, retriggerGateScale);
+    transfer(dest.peakReleaseRatio, peakReleaseRatio);
+    transfer(dest.pitchTolerance, pitchTolerance);
+    transfer(dest.targetRms, targetRms);
+    transfer(dest.calibrationGainMultiplier, calibrationGainMultiplier);
+    transfer(dest.lowCutMultiplier, lowCutMultiplier);
+    transfer(dest.highCutMultiplier, highCutMultiplier);
+    transfer(dest.aubioThresholdScale, aubioThresholdScale);
+    transfer(dest.onsetSilenceDb, onsetSilenceDb);
+    transfer(dest.pitchSilenceDb, pitchSilenceDb);
+}
+
 NoteDetectionStore& NoteDetectionStore::instance() {
     static NoteDetectionStore store;
     return store;
@@ -62,6 +110,7 @@ NoteDetectionStore::NoteDetectionStore() {
     m_current = m_defaults;
     m_committed = m_defaults;
     m_active.store(m_current);
+    m_published = m_current;
 }
 
 float* NoteDetectionStore::access(NoteDetectionParameterSet& set, NoteParameter id, int stringIdx) {
@@ -102,6 +151,41 @@ const float* NoteDetectionStore::access(const NoteDetectionParameterSet& set, No
     return self->access(const_cast<NoteDetectionParameterSet&>(set), id, stringIdx);
 }
 
+bool NoteDetectionStore::readActive(NoteDetectionParameterSet& dest, std::uint64_t& generation,
+                                    NoteStageGenerations* stages) const {
+    NoteDetectionParameterSet copy;
+    NoteStageGenerations stageCopy;
+    for (int attempt = 0; attempt < kReadActiveAttempts; ++attempt) {
+        const std::uint64_t before = m_activeSequence.load(std::memory_order_acquire);
+        if (before & 1u)
+            continue;
+        m_active.load(copy);
+        const std::uint64_t copyGeneration = m_activeGeneration.load(std::memory_order_relaxed);
+        if (stages) {
+            for (std::size_t s = 0; s < stageCopy.stage.size(); ++s) {
+                for (std::size_t k = 0; k < stageCopy.stage[s].size(); ++k)
+                    stageCopy.stage[s][k] = m_stageGenerations[s][k].load(std::memory_order_relaxed);
+                stageCopy.any[s] = m_stringGenerations[s].load(std::memory_order_relaxed);
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_activeSequence.load(std::memory_order_relaxed) == before) {
+            dest = copy;
+            generation = copyGeneration;
+            if (stages)
+                *stages = stageCopy;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::uint64_t NoteDetectionStore::stringGeneration(int stringIdx) const {
+    if (stringIdx < 0 || stringIdx >= kNumStrings)
+        return 0;
+    return m_stringGenerations[static_cast<std::size_t>(stringIdx)].load(std::memory_order_acquire);
+}
+
 float NoteDetectionStore::activeValue(NoteParameter id, int stringIdx) const {
     if (stringIdx < 0 || stringIdx >= kNumStrings)
         return 0.f;
@@ -360,8 +444,39 @@ void NoteDetectionStore::pushUndo() {
 }
 
 void NoteDetectionStore::syncActive() {
+    // Which strings the edit reaches, and which of their stages, from the
+    // descriptors.
+    std::array<bool, kNumStrings> touched {};
+    std::array<unsigned, kNumStrings> changed {};
+    for (const auto& desc : parameterDescriptors()) {
+        const auto& before = column(m_published, desc.id);
+        const auto& after = column(m_current, desc.id);
+        for (std::size_t s = 0; s < changed.size(); ++s) {
+            if (before[s] != after[s]) {
+                touched[s] = true;
+                changed[s] |= desc.stages;
+            }
+        }
+    }
+    m_published = m_current;
+
+    // Writers hold m_mutex. The sequence is odd while m_active is part
+    // written, so readActive() never hands out a set torn across an edit.
+    const std::uint64_t sequence = m_activeSequence.load(std::memory_order_relaxed);
+    m_activeSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
     m_active.store(m_current);
-    m_activeGeneration.fetch_add(1, std::memory_order_acq_rel);
+    for (std::size_t s = 0; s < changed.size(); ++s) {
+        if (!touched[s])
+            continue;
+        for (int k = 0; k < kNumNoteStages; ++k) {
+            if (changed[s] & noteStageBit(static_cast<NoteStage>(k)))
+                m_stageGenerations[s][static_cast<std::size_t>(k)].fetch_add(1, std::memory_order_relaxed);
+        }
+        m_stringGenerations[s].fetch_add(1, std::memory_order_relaxed);
+    }
+    m_activeGeneration.fetch_add(1, std::memory_order_relaxed);
+    m_activeSequence.store(sequence + 2, std::memory_order_release);
 }
 
 // no-op placeholder
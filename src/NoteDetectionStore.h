@@ -28,6 +28,14 @@ struct NoteDetectionParameterSetAtomic {
     std::array<std::atomic<float>, 6> pitchSilenceDb;
 
     void store(const NoteDetectionParameterSet& source);
+    void load(NoteDetectionParameterSet& dest) const;
+};
+
+// Per string, a counter per NoteStage that moves when an edit changes a
+// parameter feeding that stage, and one that moves with any of them.
+struct NoteStageGenerations {
+    std::array<std::array<std::uint64_t, kNumNoteStages>, kNumStrings> stage {};
+    std::array<std::uint64_t, kNumStrings> any {};
 };
 
 class NoteDetectionStore {
@@ -71,6 +79,15 @@ public:
     std::uint64_t activeGeneration() const {
         return m_activeGeneration.load(std::memory_order_acquire);
     }
+    // Copies the whole active set and the generation it belongs to (and the
+    // stage generations, when asked) without locking. Returns false, leaving
+    // the outputs alone, when an edit was being published throughout the
+    // attempts; try again on the next block.
+    bool readActive(NoteDetectionParameterSet& dest, std::uint64_t& generation,
+                    NoteStageGenerations* stages = nullptr) const;
+    // Moves only when an edit changes one of that string's values; the stage
+    // generations say which stages read it (see ParameterDescriptor::stages).
+    std::uint64_t stringGeneration(int stringIdx) const;
 
     void setCompareBaseline(bool enabled) { m_compareBaseline.store(enabled); }
     bool compareBaseline() const { return m_compareBaseline.load(); }
@@ -91,10 +108,14 @@ private:
     NoteDetectionParameterSet m_current;
     NoteDetectionParameterSet m_committed;
     NoteDetectionParameterSetAtomic m_active;
+    NoteDetectionParameterSet m_published;             // m_active's contents, for syncActive()'s diff
+    std::array<std::array<std::atomic<std::uint64_t>, kNumNoteStages>, kNumStrings> m_stageGenerations {};
+    std::array<std::atomic<std::uint64_t>, kNumStrings> m_stringGenerations {};
     std::vector<NoteDetectionParameterSet> m_undoStack;
     std::vector<NoteDetectionParameterSet> m_redoStack;
     std::map<std::string, NoteDetectionParameterSet> m_savedStates;
     mutable std::mutex m_mutex;
     std::atomic<std::uint64_t> m_activeGeneration {1};
+    std::atomic<std::uint64_t> m_activeSequence {0};   // odd while syncActive() is writing m_active
     std::atomic<bool> m_compareBaseline {false};
 };
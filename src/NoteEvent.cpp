@@ -0,0 +1,52 @@
+#include "NoteEvent.h"
+
+namespace {
+struct ArticulationName {
+  Articulation mark;
+  std::string_view name;
+};
+
+constexpr ArticulationName kArticulationNames[] = {
+    {Articulation::Slide, "slide"},
+    {Articulation::Bend, "bend"},
+    {Articulation::Hammer, "hammer"},
+    {Articulation::Pull, "pull"},
+    {Articulation::PalmMute, "pm"},
+};
+}
+
+std::string_view articulationName(Articulation mark) {
+  for (const auto& entry : kArticulationNames) {
+    if (entry.mark == mark)
+      return entry.name;
+  }
+  return {};
+}
+
+std::string articulationLabel(Articulation set) {
+  std::string label;
+  for (const auto& entry : kArticulationNames) {
+    if (!hasArticulation(set, entry.mark))
+      continue;
+    if (!label.empty())
+      label += '+';
+    label += entry.name;
+  }
+  return label;
+}
+
+Articulation articulationFromLabel(std::string_view label) {
+  Articulation set = Articulation::None;
+  while (!label.empty()) {
+    const std::size_t plus = label.find('+');
+    const std::string_view name = label.substr(0, plus);
+    for (const auto& entry : kArticulationNames) {
+      if (entry.name == name)
+        set = set | entry.mark;
+    }
+    if (plus == std::string_view::npos)
+      break;
+    label.remove_prefix(plus + 1);
+  }
+  return set;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Articulation marks, combinable. The engine's rules set at most one today.
+enum class Articulation : std::uint8_t {
+  None     = 0,
+  Slide    = 1u << 0,
+  Bend     = 1u << 1,
+  Hammer   = 1u << 2,
+  Pull     = 1u << 3,
+  PalmMute = 1u << 4,
+};
+
+constexpr Articulation operator|(Articulation a, Articulation b) {
+  return static_cast<Articulation>(static_cast<std::uint8_t>(a) | static_cast<std::uint8_t>(b));
+}
+constexpr Articulation operator&(Articulation a, Articulation b) {
+  return static_cast<Articulation>(static_cast<std::uint8_t>(a) & static_cast<std::uint8_t>(b));
+}
+constexpr bool hasArticulation(Articulation set, Articulation mark) {
+  return (set & mark) != Articulation::None;
+}
+
+// Trivially copyable and 16 bytes, so the audio thread copies events without
+// touching the heap. Times stay in seconds on the engine's timeline (the
+// trackers' hop times) rather than frames, so they need no sample rate to
+// read. Convert articulations with articulationLabel()/articulationFromLabel()
+// at the JSON and QML edges.
+struct NoteEvent {
+  std::int8_t  stringIdx = -1;    // 0..5
+  std::int8_t  fret      = -1;    // 0..24
+  std::int8_t  midi      = -1;    // absolute MIDI pitch
+  Articulation articulation = Articulation::None;
+  float        startSec  = 0.f;   // seconds
+  float        endSec    = 0.f;   // seconds (filled on close)
+  float        velocity  = 0.f;   // 0..1 (relative)
+};
+static_assert(std::is_trivially_copyable_v<NoteEvent>, "NoteEvent is copied on the audio thread");
+static_assert(sizeof(NoteEvent) == 16, "NoteEvent packs into 16 bytes");
+
+// "slide", "bend", "hammer", "pull" or "pm" for a single mark, "" otherwise.
+std::string_view articulationName(Articulation mark);
+// Names of the marks in the set joined with '+', "" for none.
+std::string articulationLabel(Articulation set);
+// Inverse of articulationLabel(); unknown names are ignored.
+Articulation articulationFromLabel(std::string_view label);
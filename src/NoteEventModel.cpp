@@ -0,0 +1,126 @@
+#include "NoteEventModel.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+bool sameEvent(const NoteEvent& a, const NoteEvent& b) {
+    return std::memcmp(&a, &b, sizeof(NoteEvent)) == 0;
+}
+}
+
+NoteEventModel::NoteEventModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int NoteEventModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : count();
+}
+
+QVariant NoteEventModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() < 0 || index.row() >= count())
+        return {};
+    const NoteEvent& ev = m_rows[static_cast<std::size_t>(index.row())];
+    switch (role) {
+    case StringRole:
+        return static_cast<int>(ev.stringIdx);
+    case FretRole:
+        return static_cast<int>(ev.fret);
+    case MidiRole:
+        return static_cast<int>(ev.midi);
+    case StartRole:
+        return ev.startSec;
+    case EndRole:
+        return ev.endSec;
+    case VelocityRole:
+        return ev.velocity;
+    case ArticulationRole:
+        return QString::fromStdString(articulationLabel(ev.articulation));
+    case FinishedRole:
+        return ev.endSec > ev.startSec;
+    default:
+        return {};
+    }
+}
+
+QHash<int, QByteArray> NoteEventModel::roleNames() const {
+    return {
+        {StringRole, "string"},
+        {FretRole, "fret"},
+        {MidiRole, "midi"},
+        {StartRole, "start"},
+        {EndRole, "end"},
+        {VelocityRole, "velocity"},
+        {ArticulationRole, "articulation"},
+        {FinishedRole, "finished"},
+    };
+}
+
+QVariantMap NoteEventModel::get(int row) const {
+    QVariantMap map;
+    if (row < 0 || row >= count())
+        return map;
+    const NoteEvent& ev = m_rows[static_cast<std::size_t>(row)];
+    map.insert(QStringLiteral("string"), static_cast<int>(ev.stringIdx));
+    map.insert(QStringLiteral("fret"), static_cast<int>(ev.fret));
+    map.insert(QStringLiteral("midi"), static_cast<int>(ev.midi));
+    map.insert(QStringLiteral("start"), ev.startSec);
+    map.insert(QStringLiteral("end"), ev.endSec);
+    map.insert(QStringLiteral("velocity"), ev.velocity);
+    map.insert(QStringLiteral("articulation"), QString::fromStdString(articulationLabel(ev.articulation)));
+    return map;
+}
+
+void NoteEventModel::apply(const NoteEventUpdate& update) {
+    const int previousCount = count();
+    const int end = update.from + static_cast<int>(update.events.size());
+    if (update.epoch != m_epoch || update.first < m_first
+        || update.from > std::max(m_first + count(), update.first)) {
+        resetFrom(update);
+    } else {
+        // Preview chunks the store retired without archiving.
+        const int dropped = std::min(update.first - m_first, count());
+        if (dropped > 0) {
+            beginRemoveRows(QModelIndex(), 0, dropped - 1);
+            m_rows.erase(m_rows.begin(), m_rows.begin() + dropped);
+            endRemoveRows();
+        }
+        m_first = update.first;
+
+        // Rows the update carries again: open notes and the fuser's look-back
+        // window at the previous update.
+        int changedFirst = -1;
+        int changedLast = -1;
+        const int changedEnd = std::min(m_first + count(), end);
+        for (int handle = std::max(update.from, m_first); handle < changedEnd; ++handle) {
+            const NoteEvent& event = update.events[static_cast<std::size_t>(handle - update.from)];
+            NoteEvent& cached = m_rows[static_cast<std::size_t>(handle - m_first)];
+            if (sameEvent(event, cached))
+                continue;
+            cached = event;
+            if (changedFirst < 0)
+                changedFirst = handle - m_first;
+            changedLast = handle - m_first;
+        }
+        if (changedFirst >= 0)
+            emit dataChanged(index(changedFirst), index(changedLast));
+
+        const int firstNew = m_first + count();
+        if (end > firstNew) {
+            beginInsertRows(QModelIndex(), count(), count() + (end - firstNew) - 1);
+            m_rows.insert(m_rows.end(), update.events.begin() + (firstNew - update.from), update.events.end());
+            endInsertRows();
+        }
+    }
+    if (count() != previousCount)
+        emit countChanged();
+}
+
+void NoteEventModel::resetFrom(const NoteEventUpdate& update) {
+    beginResetModel();
+    m_rows = update.events;
+    m_epoch = update.epoch;
+    m_first = update.from;
+    endResetModel();
+}
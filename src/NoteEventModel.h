@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QVariantMap>
+#include <cstdint>
+#include <vector>
+
+#include "NoteEvent.h"
+
+// Changes to the engine's NoteEventStore, copied on the analysis thread for
+// NoteEventModel::apply() on the GUI thread, which never reads the store:
+// its epoch and oldest kept handle, and the events from handle `from` to the
+// end (those not settled at the previous update and everything appended
+// since). After a clear, `from` is the oldest kept handle.
+struct NoteEventUpdate {
+    std::uint64_t epoch {0};
+    int first {0};
+    int from {0};
+    std::vector<NoteEvent> events;
+    bool ready {false};   // published and not yet applied
+};
+
+// Detected events for QML, one row per event kept by the engine's
+// NoteEventStore. apply() mirrors it incrementally: new events are inserted
+// rows, and only the rows an update carries again (events that were not yet
+// settled, see TabEngine::settledHandle()) are compared and reported with
+// dataChanged, so a refresh costs the events that changed rather than the
+// whole take. Dropped preview chunks become removed rows; a cleared store
+// resets.
+class NoteEventModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+public:
+    enum Role {
+        StringRole = Qt::UserRole + 1,
+        FretRole,
+        MidiRole,
+        StartRole,
+        EndRole,
+        VelocityRole,
+        ArticulationRole,
+        FinishedRole,
+    };
+
+    explicit NoteEventModel(QObject* parent=nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int count() const { return static_cast<int>(m_rows.size()); }
+    // {string, fret, midi, start, end, velocity, articulation}, like the
+    // roles; empty for rows out of range.
+    Q_INVOKABLE QVariantMap get(int row) const;
+
+    void apply(const NoteEventUpdate& update);
+    const std::vector<NoteEvent>& events() const { return m_rows; }
+
+signals:
+    void countChanged();
+
+private:
+    void resetFrom(const NoteEventUpdate& update);
+
+    std::vector<NoteEvent> m_rows;
+    std::uint64_t m_epoch {0};   // store epoch the rows mirror
+    int m_first {0};             // handle of row 0
+};
@@ -0,0 +1,91 @@
+#include "NoteEventStore.h"
+
+int NoteEventStore::append(const NoteEvent& event) {
+  const int offset = _end - _hotBegin;
+  if (offset == static_cast<int>(hotChunks()) * kChunkEvents)
+    _hot.push_back(takeSpare());
+  (*_hot.back())[static_cast<std::size_t>(offset % kChunkEvents)] = event;
+  return _end++;
+}
+
+void NoteEventStore::clear() {
+  for (auto& chunk : _cold)
+    _spare.push_back(std::move(chunk));
+  for (std::size_t i = _hotFront; i < _hot.size(); ++i)
+    _spare.push_back(std::move(_hot[i]));
+  _cold.clear();
+  _hot.clear();
+  _hotFront = 0;
+  _hotBegin = 0;
+  _end = 0;
+  ++_epoch;
+}
+
+void NoteEventStore::assign(const std::vector<NoteEvent>& events) {
+  clear();
+  for (const NoteEvent& event : events)
+    append(event);
+}
+
+void NoteEventStore::reserve(std::size_t events) {
+  const std::size_t chunks = (static_cast<std::size_t>(_end - _hotBegin) + events + kChunkEvents - 1) / kChunkEvents;
+  _spare.reserve(chunks + _cold.size());
+  _hot.reserve(2 * chunks + 1);
+  while (_spare.size() + hotChunks() < chunks)
+    _spare.push_back(std::make_unique<Chunk>());
+}
+
+void NoteEventStore::setRetention(std::size_t events) {
+  _retention = events;
+  // The window, the partly filled newest chunk and one held back by an open
+  // note, plus the chunks an archived take moves to the cold segment.
+  if (events > 0)
+    reserve(events + 2 * kChunkEvents + _archiveReserve);
+}
+
+void NoteEventStore::setArchiveReserve(std::size_t events) {
+  _archiveReserve = events;
+  _cold.reserve((events + kChunkEvents - 1) / kChunkEvents);
+  if (_retention > 0)
+    reserve(_retention + 2 * kChunkEvents + events);
+}
+
+void NoteEventStore::compact(int pinnedHandle) {
+  if (_retention == 0)
+    return;
+  while (hotChunks() > 1) {
+    const int frontEnd = _hotBegin + kChunkEvents;
+    if (frontEnd > pinnedHandle || static_cast<std::size_t>(_end - frontEnd) < _retention)
+      break;
+    retireFront();
+  }
+}
+
+std::unique_ptr<NoteEventStore::Chunk> NoteEventStore::takeSpare() {
+  if (_spare.empty()) {
+    ++_chunkAllocations;
+    return std::make_unique<Chunk>();
+  }
+  auto chunk = std::move(_spare.back());
+  _spare.pop_back();
+  return chunk;
+}
+
+void NoteEventStore::retireFront() {
+  auto& front = _hot[_hotFront];
+  if (_archive) {
+    _cold.push_back(std::move(front));
+  } else {
+    // Dropping the front breaks the run of kept handles, so the archive goes too.
+    for (auto& chunk : _cold)
+      _spare.push_back(std::move(chunk));
+    _cold.clear();
+    _spare.push_back(std::move(front));
+  }
+  ++_hotFront;
+  _hotBegin += kChunkEvents;
+  if (_hotFront * 2 >= _hot.size()) {
+    _hot.erase(_hot.begin(), _hot.begin() + static_cast<std::ptrdiff_t>(_hotFront));
+    _hotFront = 0;
+  }
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include "NoteEvent.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+// TabEngine's note events, in fixed-size chunks that never move. A handle is
+// an event's position since the last clear(); it stays valid while the event
+// is kept, so the trackers' open-note handles and the bridge's dispatch
+// watermark survive appends and compaction. append() fills the newest chunk
+// and takes a spare chunk (or allocates one) when it is full; nothing is ever
+// copied to grow. With a retention window set, compact() retires the oldest
+// chunks once more than that many events are hot: to the cold archive when
+// archiving is on (the events stay readable by handle), otherwise back to the
+// spares, dropping their events. Chunks holding an open note are never
+// retired. Iteration and size() cover the kept events, archive first.
+class NoteEventStore {
+public:
+  static constexpr int kChunkEvents = 256;
+
+  NoteEventStore() = default;
+  NoteEventStore(const NoteEventStore&) = delete;
+  NoteEventStore& operator=(const NoteEventStore&) = delete;
+
+  // Oldest kept event, oldest hot event, one past the newest.
+  int firstHandle() const { return _hotBegin - static_cast<int>(_cold.size()) * kChunkEvents; }
+  int hotHandle() const { return _hotBegin; }
+  int endHandle() const { return _end; }
+  std::size_t size() const { return static_cast<std::size_t>(_end - firstHandle()); }
+  bool empty() const { return _end == firstHandle(); }
+  // Bumped by clear(), so a reader holding handles can tell they went stale.
+  std::uint64_t epoch() const { return _epoch; }
+
+  // nullptr once the event was dropped (or for a handle never issued).
+  NoteEvent* find(int handle) {
+    return const_cast<NoteEvent*>(static_cast<const NoteEventStore*>(this)->find(handle));
+  }
+  const NoteEvent* find(int handle) const {
+    if (handle >= _end)
+      return nullptr;
+    if (handle >= _hotBegin)
+      return slot(_hot.data() + _hotFront, handle - _hotBegin);
+    const int cold = handle - firstHandle();
+    return cold >= 0 ? slot(_cold.data(), cold) : nullptr;
+  }
+  // handle must be kept.
+  NoteEvent& operator[](int handle) { return *find(handle); }
+  const NoteEvent& operator[](int handle) const { return *find(handle); }
+
+  // Returns the new event's handle.
+  int append(const NoteEvent& event);
+  // Forgets every event and restarts handles at 0; the chunks become spares.
+  void clear();
+  void assign(const std::vector<NoteEvent>& events);
+  // Allocates spare chunks until that many events fit without allocating.
+  void reserve(std::size_t events);
+
+  // Hot events to keep when compacting; 0 keeps everything. Allocates the
+  // spare chunks the window needs, so call it off the audio thread.
+  void setRetention(std::size_t events);
+  std::size_t retention() const { return _retention; }
+  // Retired chunks go to the cold archive instead of being dropped.
+  void setArchive(bool enabled) { _archive = enabled; }
+  bool archive() const { return _archive; }
+  // Archived events a take can hold before archiving allocates: reserves the
+  // cold segment and the spare chunks that will fill it. Allocates, so call
+  // it off the audio thread. Only used with a retention window.
+  void setArchiveReserve(std::size_t events);
+  std::size_t archiveReserve() const { return _archiveReserve; }
+  // Chunks append() had to allocate because no spare was left: without a
+  // window, or once a take outgrows the archive reserve.
+  std::uint64_t chunkAllocations() const { return _chunkAllocations; }
+  // Retires old chunks past the retention window that end at or before
+  // pinnedHandle (the oldest event that may still change).
+  void compact(int pinnedHandle);
+
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = NoteEvent;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const NoteEvent*;
+    using reference = const NoteEvent&;
+
+    const_iterator() = default;
+    const_iterator(const NoteEventStore* store, int handle) : _store(store), _handle(handle) {}
+    reference operator*() const { return (*_store)[_handle]; }
+    pointer operator->() const { return _store->find(_handle); }
+    const_iterator& operator++() { ++_handle; return *this; }
+    const_iterator operator++(int) { const_iterator old = *this; ++_handle; return old; }
+    bool operator==(const const_iterator& other) const { return _handle == other._handle; }
+    bool operator!=(const const_iterator& other) const { return _handle != other._handle; }
+    int handle() const { return _handle; }
+
+  private:
+    const NoteEventStore* _store = nullptr;
+    int _handle = 0;
+  };
+
+  const_iterator begin() const { return {this, firstHandle()}; }
+  const_iterator end() const { return {this, _end}; }
+
+private:
+  using Chunk = std::array<NoteEvent, kChunkEvents>;
+
+  static const NoteEvent* slot(const std::unique_ptr<Chunk>* chunks, int offset) {
+    return &(*chunks[static_cast<std::size_t>(offset / kChunkEvents)])[static_cast<std::size_t>(offset % kChunkEvents)];
+  }
+  std::unique_ptr<Chunk> takeSpare();
+  void retireFront();
+
+  std::size_t hotChunks() const { return _hot.size() - _hotFront; }
+
+  // _hot[_hotFront] starts at _hotBegin; the retired slots before it are
+  // erased in batches, so retiring neither allocates nor shifts every block.
+  std::vector<std::unique_ptr<Chunk>> _hot;
+  std::size_t _hotFront = 0;
+  std::vector<std::unique_ptr<Chunk>> _cold;  // ends at _hotBegin
+  std::vector<std::unique_ptr<Chunk>> _spare;
+  int _hotBegin = 0;
+  int _end = 0;
+  std::uint64_t _epoch = 0;
+  std::size_t _retention = 0;
+  std::size_t _archiveReserve = 0;
+  std::uint64_t _chunkAllocations = 0;
+  bool _archive = false;
+};
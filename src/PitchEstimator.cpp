@@ -0,0 +1,166 @@
+#include "PitchEstimator.h"
+#include "util.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Detuning and bend headroom around the playable range.
+constexpr int kLowMarginSemitones = 1;
+constexpr int kHighMarginSemitones = 25;
+// McLeod's key-maximum rule: take the first peak within this fraction of the
+// highest one, which avoids picking a sub-octave.
+constexpr float kPeakCutoff = 0.9f;
+constexpr float kLevelFloor = 1.0e-20f;
+constexpr std::size_t kDotLanes = 8;
+
+// Independent partial sums per lane, so the loop vectorises without
+// -ffast-math (no reassociation of a single accumulator).
+float dot(const float* a, const float* b, std::size_t n) {
+  float lanes[kDotLanes] {};
+  std::size_t i = 0;
+  for (; i + kDotLanes <= n; i += kDotLanes) {
+    for (std::size_t j = 0; j < kDotLanes; ++j)
+      lanes[j] += a[i + j] * b[i + j];
+  }
+  float acc = 0.f;
+  for (; i < n; ++i)
+    acc += a[i] * b[i];
+  for (std::size_t j = 0; j < kDotLanes; ++j)
+    acc += lanes[j];
+  return acc;
+}
+}
+
+void PitchEstimator::configure(float sampleRate, int hopSize, int openMidi) {
+  _hopSize = 0;
+  if (sampleRate <= 0.f || hopSize <= 0)
+    return;
+
+  _sampleRate = sampleRate;
+  _minLag = std::max(2, static_cast<int>(std::floor(sampleRate / midiToHz(openMidi + kHighMarginSemitones))) - 1);
+  _maxLag = static_cast<int>(std::ceil(sampleRate / midiToHz(openMidi - kLowMarginSemitones))) + 1;
+  _lagCount = _maxLag - _minLag + 1;
+  // One period of the lowest note per window, rounded up to whole hops.
+  _blocks = std::max(2, (_maxLag + hopSize - 1) / hopSize);
+  _window = _blocks * hopSize;
+  _nextBlock = 0;
+
+  _history.assign(static_cast<std::size_t>(_window + _maxLag), 0.f);
+  _partials.assign(static_cast<std::size_t>(_blocks) * static_cast<std::size_t>(_lagCount), 0.f);
+  _autocorr.assign(static_cast<std::size_t>(_lagCount), 0.f);
+  _energy.assign(_history.size() + 1, 0.f);
+  _nsdf.assign(static_cast<std::size_t>(_lagCount), 0.f);
+  _hopSize = hopSize;
+  reset();
+}
+
+void PitchEstimator::reset() {
+  std::fill(_history.begin(), _history.end(), 0.f);
+  std::fill(_partials.begin(), _partials.end(), 0.f);
+  std::fill(_autocorr.begin(), _autocorr.end(), 0.f);
+  _nextBlock = 0;
+  _appendedBlocks = 0;
+  _clarity = 0.f;
+}
+
+float PitchEstimator::pushHop(const float* in, float gain) {
+  const std::size_t hop = static_cast<std::size_t>(_hopSize);
+  const std::size_t total = _history.size();
+  std::move(_history.begin() + static_cast<std::ptrdiff_t>(hop), _history.end(), _history.begin());
+  float* tail = _history.data() + (total - hop);
+  float hopEnergy = 0.f;
+  for (std::size_t i = 0; i < hop; ++i) {
+    const float x = in ? in[i] * gain : 0.f;
+    tail[i] = x;
+    hopEnergy += x * x;
+  }
+  return hopEnergy;
+}
+
+void PitchEstimator::append(const float* in, float gain) {
+  if (_hopSize <= 0)
+    return;
+  pushHop(in, gain);
+  _nextBlock = (_nextBlock + 1) % _blocks;
+  _appendedBlocks = std::min(_appendedBlocks + 1, _blocks - 1);
+}
+
+float PitchEstimator::process(const float* in, float gain) {
+  _clarity = 0.f;
+  if (_hopSize <= 0)
+    return -1.f;
+
+  const std::size_t hop = static_cast<std::size_t>(_hopSize);
+  const std::size_t total = _history.size();
+  const float hopEnergy = pushHop(in, gain);
+
+  // Lagged dot products of the new block, and of any appended ones still in
+  // the window; each row overwrites the block that left the window.
+  const std::size_t lags = static_cast<std::size_t>(_lagCount);
+  for (int age = _appendedBlocks; age >= 0; --age) {
+    const float* block = _history.data() + (total - hop * static_cast<std::size_t>(age + 1));
+    float* row = _partials.data() + static_cast<std::size_t>((_nextBlock - age + _blocks) % _blocks) * lags;
+    for (std::size_t k = 0; k < lags; ++k)
+      row[k] = dot(block, block - (static_cast<std::size_t>(_minLag) + k), hop);
+  }
+  _nextBlock = (_nextBlock + 1) % _blocks;
+  _appendedBlocks = 0;
+
+  const float hopDb = 10.f * std::log10(std::max(hopEnergy / static_cast<float>(hop), kLevelFloor));
+  if (hopDb < _silenceDb)
+    return -1.f;
+
+  std::copy(_partials.begin(), _partials.begin() + static_cast<std::ptrdiff_t>(lags), _autocorr.begin());
+  for (int b = 1; b < _blocks; ++b) {
+    const float* src = _partials.data() + static_cast<std::size_t>(b) * lags;
+    for (std::size_t k = 0; k < lags; ++k)
+      _autocorr[k] += src[k];
+  }
+
+  // m(tau) = energy of the window plus energy of the window delayed by tau.
+  _energy[0] = 0.f;
+  for (std::size_t i = 0; i < total; ++i)
+    _energy[i + 1] = _energy[i] + _history[i] * _history[i];
+  const std::size_t window = static_cast<std::size_t>(_window);
+  const float current = _energy[total] - _energy[total - window];
+  for (std::size_t k = 0; k < lags; ++k) {
+    const std::size_t tau = static_cast<std::size_t>(_minLag) + k;
+    const float delayed = _energy[total - tau] - _energy[total - window - tau];
+    const float m = current + delayed;
+    _nsdf[k] = m > 0.f ? 2.f * _autocorr[k] / m : 0.f;
+  }
+  return pickPeak();
+}
+
+float PitchEstimator::pickPeak() {
+  const int lags = _lagCount;
+  float highest = 0.f;
+  for (int k = 1; k + 1 < lags; ++k) {
+    const float v = _nsdf[static_cast<std::size_t>(k)];
+    if (v > highest && v >= _nsdf[static_cast<std::size_t>(k - 1)] && v >= _nsdf[static_cast<std::size_t>(k + 1)])
+      highest = v;
+  }
+  if (highest <= 0.f)
+    return -1.f;
+
+  int best = -1;
+  for (int k = 1; k + 1 < lags; ++k) {
+    const float v = _nsdf[static_cast<std::size_t>(k)];
+    if (v >= kPeakCutoff * highest && v >= _nsdf[static_cast<std::size_t>(k - 1)] && v >= _nsdf[static_cast<std::size_t>(k + 1)]) {
+      best = k;
+      break;
+    }
+  }
+  if (best < 0)
+    return -1.f;
+
+  const float a = _nsdf[static_cast<std::size_t>(best - 1)];
+  const float b = _nsdf[static_cast<std::size_t>(best)];
+  const float c = _nsdf[static_cast<std::size_t>(best + 1)];
+  const float denom = a - 2.f * b + c;
+  const float shift = denom < 0.f ? std::clamp(0.5f * (a - c) / denom, -0.5f, 0.5f) : 0.f;
+  _clarity = std::min(1.f, b - 0.25f * (a - c) * shift);
+  if (_clarity < 1.f - _tolerance)
+    return -1.f;
+  return _sampleRate / (static_cast<float>(_minLag + best) + shift);
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Time-domain pitch for one string, restricted to the lags of the notes the
+// string can play (open - 1 .. open + 25 semitones). Each hop adds one block
+// of lagged dot products per lag and drops the block that left the window,
+// so the autocorrelation is updated rather than recomputed; partial sums are
+// kept per block and re-added, which keeps them exact over long sessions.
+// The YIN difference d(tau) = m(tau) - 2 r(tau) is normalised by its own
+// energy term m(tau) (McLeod's NSDF), which, unlike YIN's cumulative mean,
+// needs no lags outside the string's range. configure() allocates;
+// reset(), process() and append() do not.
+class PitchEstimator {
+public:
+  void configure(float sampleRate, int hopSize, int openMidi);
+  void reset();
+
+  // Voiced when the NSDF peak reaches 1 - tolerance (the YIN threshold
+  // expressed on the same scale).
+  void setTolerance(float tolerance) { _tolerance = tolerance; }
+  void setSilenceDb(float db) { _silenceDb = db; }
+
+  bool ready() const { return _hopSize > 0; }
+  int minLag() const { return _minLag; }
+  int maxLag() const { return _maxLag; }
+  int windowSize() const { return _window; }
+
+  // Appends hopSize() samples of in, each multiplied by gain; returns the
+  // pitch in Hz, or -1 when unvoiced or below the silence level.
+  float process(const float* in, float gain);
+  // Appends a hop without estimating. The next process() computes the lag
+  // products of the appended blocks still inside its window, so appending
+  // more than windowSize() / hopSize() hops between estimates skips the rest.
+  void append(const float* in, float gain);
+  float clarity() const { return _clarity; }
+
+private:
+  float pushHop(const float* in, float gain);
+  float pickPeak();
+
+  float _sampleRate = 0.f;
+  int _hopSize = 0;
+  int _minLag = 0;      // first lag evaluated (one below the highest note's period)
+  int _maxLag = 0;
+  int _lagCount = 0;    // _maxLag - _minLag + 1
+  int _window = 0;      // integration length, a whole number of hops
+  int _blocks = 0;      // _window / _hopSize
+  int _nextBlock = 0;
+  int _appendedBlocks = 0; // hops appended since the last process(), capped at _blocks
+
+  float _tolerance = 0.15f;
+  float _silenceDb = -70.f;
+  float _clarity = 0.f;
+
+  std::vector<float> _history;     // _window + _maxLag samples, oldest first
+  std::vector<float> _partials;    // _blocks rows of _lagCount lagged dot products
+  std::vector<float> _autocorr;    // r(tau), sum of the partial rows
+  std::vector<float> _energy;      // running sum of squares over _history, size + 1
+  std::vector<float> _nsdf;
+};
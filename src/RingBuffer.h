@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// FIFO over a power-of-two array, indexed oldest first. reserve() allocates
+// and keeps the contents; push_back() on a full ring drops the oldest
+// element instead of growing, so the audio thread never allocates.
+// pushed() counts every element ever pushed, which tells a caller how many
+// arrived since it last looked without searching by timestamp.
+template <typename T>
+class FixedRing {
+public:
+  // Rounds up to a power of two; never shrinks.
+  void reserve(std::size_t minCapacity) {
+    if (minCapacity <= _slots.size())
+      return;
+    std::size_t capacity = 1;
+    while (capacity < minCapacity)
+      capacity <<= 1;
+    std::vector<T> slots(capacity);
+    for (std::size_t i = 0; i < _size; ++i)
+      slots[i] = (*this)[i];
+    _slots.swap(slots);
+    _mask = capacity - 1;
+    _head = 0;
+  }
+
+  std::size_t capacity() const { return _slots.size(); }
+  std::size_t size() const { return _size; }
+  bool empty() const { return _size == 0; }
+  std::uint64_t pushed() const { return _pushed; }
+
+  void clear() {
+    _head = 0;
+    _size = 0;
+  }
+
+  void push_back(const T& value) {
+    if (_slots.empty())
+      return;
+    if (_size == _slots.size())
+      pop_front();
+    _slots[(_head + _size) & _mask] = value;
+    ++_size;
+    ++_pushed;
+  }
+
+  void pop_front() {
+    if (_size == 0)
+      return;
+    _head = (_head + 1) & _mask;
+    --_size;
+  }
+
+  T& operator[](std::size_t i) { return _slots[(_head + i) & _mask]; }
+  const T& operator[](std::size_t i) const { return _slots[(_head + i) & _mask]; }
+  T& front() { return (*this)[0]; }
+  const T& front() const { return (*this)[0]; }
+  T& back() { return (*this)[_size - 1]; }
+  const T& back() const { return (*this)[_size - 1]; }
+
+private:
+  std::vector<T> _slots;
+  std::size_t _mask = 0;
+  std::size_t _head = 0;
+  std::size_t _size = 0;
+  std::uint64_t _pushed = 0;
+};
@@ -0,0 +1,226 @@
+#include "RtCheck.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* ptr, std::size_t size);
+void __libc_free(void* ptr);
+}
+
+namespace {
+
+enum class Violation : int { Malloc = 0, Calloc, Realloc, Free, MutexLock, Count };
+
+constexpr const char* kViolationNames[] = {"malloc", "calloc", "realloc", "free", "pthread_mutex_lock"};
+constexpr int kViolationKinds = static_cast<int>(Violation::Count);
+constexpr int kMaxStacks = 256;
+constexpr int kMaxFrames = 24;
+constexpr int kSkipFrames = 2; // record() + the interposed entry point
+
+struct StackRecord {
+    std::atomic<std::uint64_t> hash {0};
+    std::atomic<bool> ready {false};
+    std::atomic<std::uint64_t> hits {0};
+    Violation kind {Violation::Malloc};
+    const char* site {nullptr};
+    std::size_t bytes {0};
+    long tid {0};
+    int frameCount {0};
+    void* frames[kMaxFrames] {};
+};
+
+StackRecord g_stacks[kMaxStacks];
+std::atomic<std::uint64_t> g_perKind[kViolationKinds] {};
+std::atomic<std::uint64_t> g_unrecorded {0};
+std::atomic<bool> g_reported {false};
+
+thread_local int t_rtDepth = 0;
+thread_local const char* t_site = nullptr;
+thread_local bool t_inHook = false;
+
+using MutexLockFn = int (*)(pthread_mutex_t*);
+std::atomic<MutexLockFn> g_realMutexLock {nullptr};
+
+MutexLockFn realMutexLock() {
+    MutexLockFn fn = g_realMutexLock.load(std::memory_order_acquire);
+    if (!fn) {
+        fn = reinterpret_cast<MutexLockFn>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+        g_realMutexLock.store(fn, std::memory_order_release);
+    }
+    return fn;
+}
+
+std::uint64_t hashStack(Violation kind, const char* site, void* const* frames, int count) {
+    std::uint64_t h = 1469598103934665603ull;
+    const auto mix = [&h](std::uint64_t value) {
+        h ^= value;
+        h *= 1099511628211ull;
+    };
+    mix(static_cast<std::uint64_t>(kind));
+    mix(reinterpret_cast<std::uintptr_t>(site));
+    for (int i = 0; i < count; ++i)
+        mix(reinterpret_cast<std::uintptr_t>(frames[i]));
+    return h ? h : 1;
+}
+
+void record(Violation kind, std::size_t bytes) {
+    if (t_rtDepth <= 0 || t_inHook)
+        return;
+    t_inHook = true;
+
+    g_perKind[static_cast<int>(kind)].fetch_add(1, std::memory_order_relaxed);
+
+    void* frames[kMaxFrames + kSkipFrames];
+    const int captured = backtrace(frames, kMaxFrames + kSkipFrames);
+    void* const* stack = frames + (captured > kSkipFrames ? kSkipFrames : 0);
+    const int depth = captured > kSkipFrames ? captured - kSkipFrames : captured;
+    const std::uint64_t hash = hashStack(kind, t_site, stack, depth);
+
+    bool stored = false;
+    for (int probe = 0; probe < kMaxStacks; ++probe) {
+        StackRecord& slot = g_stacks[(hash + static_cast<std::uint64_t>(probe)) % kMaxStacks];
+        std::uint64_t expected = 0;
+        if (slot.hash.compare_exchange_strong(expected, hash, std::memory_order_acq_rel)) {
+            slot.kind = kind;
+            slot.site = t_site;
+            slot.bytes = bytes;
+            slot.tid = static_cast<long>(syscall(SYS_gettid));
+            slot.frameCount = depth;
+            std::memcpy(slot.frames, stack, static_cast<std::size_t>(depth) * sizeof(void*));
+            slot.hits.fetch_add(1, std::memory_order_relaxed);
+            slot.ready.store(true, std::memory_order_release);
+            stored = true;
+            break;
+        }
+        if (expected == hash) {
+            slot.hits.fetch_add(1, std::memory_order_relaxed);
+            stored = true;
+            break;
+        }
+    }
+    if (!stored)
+        g_unrecorded.fetch_add(1, std::memory_order_relaxed);
+
+    t_inHook = false;
+}
+
+struct Initializer {
+    Initializer() {
+        // backtrace() loads libgcc_s lazily on first use; do that now so the
+        // first recorded violation does not allocate from inside the hook.
+        void* warmup[2];
+        backtrace(warmup, 2);
+        realMutexLock();
+        std::atexit([]() { rtcheck::writeReport(); });
+    }
+};
+
+Initializer g_initializer;
+
+} // namespace
+
+namespace rtcheck {
+
+RealtimeScope::RealtimeScope(const char* site) noexcept
+    : m_previousSite(t_site) {
+    t_site = site;
+    ++t_rtDepth;
+}
+
+RealtimeScope::~RealtimeScope() {
+    --t_rtDepth;
+    t_site = m_previousSite;
+}
+
+void writeReport() {
+    if (g_reported.exchange(true))
+        return;
+
+    int fd = STDERR_FILENO;
+    const char* path = std::getenv("GUITARPI_RT_CHECK_REPORT");
+    if (path && *path) {
+        const int fileFd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fileFd >= 0)
+            fd = fileFd;
+    }
+
+    std::uint64_t total = 0;
+    for (int k = 0; k < kViolationKinds; ++k)
+        total += g_perKind[k].load(std::memory_order_relaxed);
+
+    dprintf(fd, "[rtcheck] realtime violations: %llu\n", static_cast<unsigned long long>(total));
+    for (int k = 0; k < kViolationKinds; ++k) {
+        dprintf(fd, "[rtcheck]   %-20s %llu\n",
+                kViolationNames[k],
+                static_cast<unsigned long long>(g_perKind[k].load(std::memory_order_relaxed)));
+    }
+    const std::uint64_t unrecorded = g_unrecorded.load(std::memory_order_relaxed);
+    if (unrecorded > 0)
+        dprintf(fd, "[rtcheck]   stack table full, %llu hits not attributed\n", static_cast<unsigned long long>(unrecorded));
+
+    int unique = 0;
+    for (const StackRecord& slot : g_stacks) {
+        if (!slot.ready.load(std::memory_order_acquire))
+            continue;
+        ++unique;
+        dprintf(fd, "\n[rtcheck] #%d %s in %s x%llu (first: %zu bytes, tid %ld)\n",
+                unique,
+                kViolationNames[static_cast<int>(slot.kind)],
+                slot.site ? slot.site : "?",
+                static_cast<unsigned long long>(slot.hits.load(std::memory_order_relaxed)),
+                slot.bytes,
+                slot.tid);
+        backtrace_symbols_fd(slot.frames, slot.frameCount, fd);
+    }
+
+    if (fd != STDERR_FILENO)
+        close(fd);
+}
+
+} // namespace rtcheck
+
+extern "C" {
+
+void* malloc(std::size_t size) noexcept {
+    record(Violation::Malloc, size);
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept {
+    record(Violation::Calloc, count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, std::size_t size) noexcept {
+    record(Violation::Realloc, size);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) noexcept {
+    if (ptr)
+        record(Violation::Free, 0);
+    __libc_free(ptr);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept {
+    record(Violation::MutexLock, 0);
+    MutexLockFn fn = realMutexLock();
+    return fn ? fn(mutex) : EINVAL;
+}
+
+} // extern "C"
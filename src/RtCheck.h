@@ -0,0 +1,37 @@
+#pragma once
+
+// Realtime-safety checker. Configure with -DGUITARPI_RT_CHECK=ON to link
+// RtCheck.cpp, which interposes malloc/calloc/realloc/free and
+// pthread_mutex_lock. Calls made while a RealtimeScope is alive on the calling
+// thread are recorded (with their stack) into a preallocated table and reported
+// when the process exits. In regular builds the scope compiles to nothing.
+namespace rtcheck {
+
+#if defined(GUITARPI_RT_CHECK)
+class RealtimeScope {
+public:
+    explicit RealtimeScope(const char* site) noexcept;
+    ~RealtimeScope();
+
+    RealtimeScope(const RealtimeScope&) = delete;
+    RealtimeScope& operator=(const RealtimeScope&) = delete;
+
+private:
+    const char* m_previousSite;
+};
+
+void writeReport();
+#else
+class RealtimeScope {
+public:
+    explicit RealtimeScope(const char*) noexcept {}
+};
+
+inline void writeReport() {}
+#endif
+
+} // namespace rtcheck
+
+#define GUITARPI_RT_CONCAT_INNER(a, b) a##b
+#define GUITARPI_RT_CONCAT(a, b) GUITARPI_RT_CONCAT_INNER(a, b)
+#define GUITARPI_RT_SCOPE(site) ::rtcheck::RealtimeScope GUITARPI_RT_CONCAT(rtScope_, __LINE__)(site)
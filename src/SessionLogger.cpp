@@ -1,6 +1,8 @@
 #include "SessionLogger.h"
+#include "TraceRing.h"
 
-#include <chrono>
+#include <algorithm>
+#include <cerrno>
 #include <cstdlib>
 #include <filesystem>
 #include <cstdio>
@@ -9,7 +11,19 @@
 #include <sstream>
 #include <string>
 
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
 namespace {
+// How often the worker drains the queue and the detection trace rings.
+// Producers never wake it, so this bounds how late a line reaches the file.
+constexpr std::chrono::milliseconds kDrainInterval {20};
+// An SD card stalls on every sync; once a second bounds what a power cut loses.
+constexpr std::int64_t kSyncIntervalNs = 1000000000;
+constexpr std::size_t kBatchLines = 64;
+constexpr std::size_t kPrefixChars = 64;
+
 std::string makeTimestampedName() {
     const auto now = std::chrono::system_clock::now();
     const std::time_t tt = std::chrono::system_clock::to_time_t(now);
@@ -37,6 +51,12 @@ std::string isoTimestamp() {
     oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
     return oss.str();
 }
+
+std::uint16_t copyTruncated(char* dest, std::size_t capacity, std::string_view source) {
+    const std::size_t length = std::min(source.size(), capacity);
+    std::copy_n(source.data(), length, dest);
+    return static_cast<std::uint16_t>(length);
+}
 }
 
 SessionLogger& SessionLogger::instance() {
@@ -57,105 +77,265 @@ SessionLogger::SessionLogger() {
     const std::string filename = "session-" + makeTimestampedName() + ".log";
     std::filesystem::path path = std::filesystem::path(dir) / filename;
     m_logPath = path.string();
-    m_stream.open(path, std::ios::out | std::ios::trunc);
-    if (!m_stream.is_open())
+    m_fd = ::open(m_logPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_fd < 0)
         return;
 
-    m_stream << "# SignalAssistant session log\n";
-    m_stream << "# Started at " << isoTimestamp() << "\n";
-    m_stream.flush();
+    m_slots = std::make_unique<Slot[]>(kQueueSlots);
+    for (std::size_t i = 0; i < kQueueSlots; ++i)
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    m_traceBatch.reserve(64 * 1024);
+    m_startWall = std::chrono::system_clock::now();
+    m_startMonotonicNs = monotonicNow();
+    m_lastSyncNs = m_startMonotonicNs;
+
+    const std::string header = "# SignalAssistant session log\n# Started at " + isoTimestamp()
+        + "\n# Line times are monotonic, counted from the start time\n";
+    writeAll(header.data(), header.size());
     m_running = true;
     m_worker = std::thread(&SessionLogger::workerLoop, this);
     m_ready = true;
+    trace::setEnabled(true);
 }
 
 SessionLogger::~SessionLogger() {
     if (m_ready) {
+        trace::setEnabled(false);
         {
-            std::lock_guard<std::mutex> guard(m_queueMutex);
+            std::lock_guard<std::mutex> guard(m_wakeMutex);
             m_running = false;
         }
         m_cv.notify_all();
         if (m_worker.joinable())
             m_worker.join();
     }
-    if (m_stream.is_open()) {
-        m_stream << "# Session closed at " << isoTimestamp() << "\n";
-        m_stream.flush();
+    if (m_fd >= 0) {
+        char footer[160];
+        const int length = std::snprintf(footer, sizeof(footer),
+                                         "# Session closed at %s (dropped %llu lines, %llu trace records)\n",
+                                         isoTimestamp().c_str(),
+                                         static_cast<unsigned long long>(m_dropped.load(std::memory_order_relaxed)),
+                                         static_cast<unsigned long long>(m_droppedTraces));
+        if (length > 0)
+            writeAll(footer, std::min(static_cast<std::size_t>(length), sizeof(footer) - 1));
+        syncIfDue(true);
+        ::close(m_fd);
+        m_fd = -1;
     }
 }
 
-void SessionLogger::log(const std::string& component, const std::string& message) {
+void SessionLogger::log(std::string_view component, std::string_view message) {
     if (!m_ready)
         return;
-    writeLine(component, message);
+    std::uint64_t position = 0;
+    Slot* slot = acquireSlot(position);
+    if (!slot)
+        return;
+    slot->monotonicNs = monotonicNow();
+    slot->componentLength = copyTruncated(slot->component, kComponentChars, component);
+    slot->textLength = copyTruncated(slot->text, kTextChars, message);
+    publishSlot(*slot, position);
 }
 
-void SessionLogger::logf(const std::string& component, const char* fmt, ...) {
+void SessionLogger::logf(std::string_view component, const char* fmt, ...) {
     if (!m_ready || !fmt)
         return;
+    std::uint64_t position = 0;
+    Slot* slot = acquireSlot(position);
+    if (!slot)
+        return;
+    slot->monotonicNs = monotonicNow();
+    slot->componentLength = copyTruncated(slot->component, kComponentChars, component);
     va_list args;
     va_start(args, fmt);
-    const std::string formatted = formatString(fmt, args);
+    const int needed = std::vsnprintf(slot->text, kTextChars, fmt, args);
     va_end(args);
-    writeLine(component, formatted);
+    slot->textLength = static_cast<std::uint16_t>(std::clamp(needed, 0, static_cast<int>(kTextChars) - 1));
+    publishSlot(*slot, position);
 }
 
-void SessionLogger::writeLine(const std::string& component, const std::string& message) {
-    enqueue(composeLine(component, message));
+// Bounded multi-producer queue (Vyukov): slot i of lap n is free for the
+// producer at position n * kQueueSlots + i when its sequence equals that
+// position, and holds a line for the worker when it is one more.
+SessionLogger::Slot* SessionLogger::acquireSlot(std::uint64_t& position) {
+    std::uint64_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = m_slots[pos & (kQueueSlots - 1)];
+        const std::uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const std::int64_t diff = static_cast<std::int64_t>(sequence) - static_cast<std::int64_t>(pos);
+        if (diff == 0) {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                position = pos;
+                return &slot;
+            }
+        } else if (diff < 0) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
 }
 
-void SessionLogger::enqueue(std::string line) {
-    std::unique_lock<std::mutex> lock(m_queueMutex, std::try_to_lock);
-    if (!lock.owns_lock())
-        return;
-    m_pending.emplace_back(std::move(line));
-    lock.unlock();
-    m_cv.notify_one();
+void SessionLogger::publishSlot(Slot& slot, std::uint64_t position) {
+    slot.sequence.store(position + 1, std::memory_order_release);
 }
 
 void SessionLogger::workerLoop() {
-    std::unique_lock<std::mutex> lock(m_queueMutex);
-    while (m_running || !m_pending.empty()) {
-        if (m_pending.empty()) {
-            m_cv.wait(lock, [this]() { return !m_running || !m_pending.empty(); });
-            continue;
-        }
-        auto line = std::move(m_pending.front());
-        m_pending.pop_front();
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    while (true) {
+        const bool running = m_running;
         lock.unlock();
-        if (m_stream.is_open()) {
-            m_stream << line << '\n';
-            m_stream.flush();
-        }
+        writeQueued();
+        drainTraces();
+        writeDropSummary();
+        syncIfDue(false);
         lock.lock();
+        // One last pass after the stop request picks up lines logged before it.
+        if (!running)
+            break;
+        m_cv.wait_for(lock, kDrainInterval, [this]() { return !m_running; });
     }
-    if (m_stream.is_open())
-        m_stream.flush();
 }
 
-std::string SessionLogger::composeLine(const std::string& component, const std::string& message) const {
-    std::ostringstream oss;
-    oss << isoTimestamp() << ' ';
-    if (!component.empty())
-        oss << '[' << component << "] ";
-    oss << message;
-    return oss.str();
+std::size_t SessionLogger::writeQueued() {
+    // The lines go to writev() straight from their slots, which are handed
+    // back to the producers once the batch is written.
+    static const char kNewline = '\n';
+    iovec iov[kBatchLines * 3];
+    char prefixes[kBatchLines][kPrefixChars];
+    std::size_t written = 0;
+    while (true) {
+        std::size_t lines = 0;
+        int iovs = 0;
+        for (; lines < kBatchLines; ++lines) {
+            Slot& slot = m_slots[(m_dequeuePos + lines) & (kQueueSlots - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != m_dequeuePos + lines + 1)
+                break;
+            const std::size_t prefixLength = formatPrefix(prefixes[lines], kPrefixChars, slot.monotonicNs,
+                                                          std::string_view(slot.component, slot.componentLength));
+            iov[iovs++] = {prefixes[lines], prefixLength};
+            iov[iovs++] = {slot.text, slot.textLength};
+            iov[iovs++] = {const_cast<char*>(&kNewline), 1};
+        }
+        if (lines == 0)
+            break;
+
+        iovec* next = iov;
+        while (iovs > 0) {
+            const ssize_t n = ::writev(m_fd, next, iovs);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            m_unsyncedBytes += static_cast<std::uint64_t>(n);
+            std::size_t remaining = static_cast<std::size_t>(n);
+            while (iovs > 0 && remaining >= next->iov_len) {
+                remaining -= next->iov_len;
+                ++next;
+                --iovs;
+            }
+            if (iovs > 0) {
+                next->iov_base = static_cast<char*>(next->iov_base) + remaining;
+                next->iov_len -= remaining;
+            }
+        }
+
+        for (std::size_t i = 0; i < lines; ++i)
+            m_slots[(m_dequeuePos + i) & (kQueueSlots - 1)].sequence.store(m_dequeuePos + i + kQueueSlots,
+                                                                           std::memory_order_release);
+        m_dequeuePos += lines;
+        written += lines;
+        if (lines < kBatchLines)
+            break;
+    }
+    return written;
+}
+
+void SessionLogger::drainTraces() {
+    m_traceBatch.clear();
+    char prefix[kPrefixChars];
+    const std::int64_t now = monotonicNow();
+    trace::drain([&](const trace::Record& record) {
+        m_traceBatch.append(prefix, formatPrefix(prefix, sizeof(prefix), now, "tracker"));
+        m_traceBatch += trace::format(record);
+        m_traceBatch += '\n';
+    });
+    writeAll(m_traceBatch.data(), m_traceBatch.size());
+}
+
+void SessionLogger::writeDropSummary() {
+    const std::uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+    const std::uint64_t droppedTraces = trace::takeDropped();
+    if (dropped == m_reportedDropped && droppedTraces == 0)
+        return;
+    m_droppedTraces += droppedTraces;
+    char line[256];
+    std::size_t length = formatPrefix(line, kPrefixChars, monotonicNow(), "logger");
+    const int body = std::snprintf(line + length, sizeof(line) - length,
+                                   "dropped %llu lines (queue full, %llu this session), %llu trace records (ring full, %llu this session)\n",
+                                   static_cast<unsigned long long>(dropped - m_reportedDropped),
+                                   static_cast<unsigned long long>(dropped),
+                                   static_cast<unsigned long long>(droppedTraces),
+                                   static_cast<unsigned long long>(m_droppedTraces));
+    if (body > 0)
+        length = std::min(length + static_cast<std::size_t>(body), sizeof(line) - 1);
+    writeAll(line, length);
+    m_reportedDropped = dropped;
+}
+
+void SessionLogger::writeAll(const char* data, std::size_t length) {
+    while (length > 0) {
+        const ssize_t n = ::write(m_fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        m_unsyncedBytes += static_cast<std::uint64_t>(n);
+        data += n;
+        length -= static_cast<std::size_t>(n);
+    }
+}
+
+void SessionLogger::syncIfDue(bool force) {
+    if (m_unsyncedBytes == 0)
+        return;
+    const std::int64_t now = monotonicNow();
+    if (!force && now - m_lastSyncNs < kSyncIntervalNs)
+        return;
+    ::fdatasync(m_fd);
+    m_unsyncedBytes = 0;
+    m_lastSyncNs = now;
+}
+
+// "2026-10-16 09:34:51.123456 [component] ": the start time plus the
+// monotonic time elapsed, so lines stay ordered if the wall clock steps.
+std::size_t SessionLogger::formatPrefix(char* out, std::size_t capacity, std::int64_t monotonicNs,
+                                        std::string_view component) const {
+    const auto wall = m_startWall + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::nanoseconds(monotonicNs - m_startMonotonicNs));
+    const std::time_t tt = std::chrono::system_clock::to_time_t(wall);
+    const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+        wall - std::chrono::system_clock::from_time_t(tt)).count();
+    std::tm tm{};
+    localtime_r(&tt, &tm);
+    std::size_t length = std::strftime(out, capacity, "%Y-%m-%d %H:%M:%S", &tm);
+    int more = std::snprintf(out + length, capacity - length, ".%06lld ", static_cast<long long>(std::max<std::int64_t>(0, micros)));
+    if (more > 0)
+        length = std::min(length + static_cast<std::size_t>(more), capacity - 1);
+    if (!component.empty()) {
+        more = std::snprintf(out + length, capacity - length, "[%.*s] ", static_cast<int>(component.size()), component.data());
+        if (more > 0)
+            length = std::min(length + static_cast<std::size_t>(more), capacity - 1);
+    }
+    return length;
 }
 
-std::string SessionLogger::formatString(const char* fmt, va_list args) {
-    if (!fmt)
-        return {};
-    va_list copy;
-    va_copy(copy, args);
-    const int needed = std::vsnprintf(nullptr, 0, fmt, copy);
-    va_end(copy);
-    if (needed <= 0)
-        return {};
-    std::string buffer(static_cast<std::size_t>(needed) + 1, '\0');
-    std::vsnprintf(buffer.data(), buffer.size(), fmt, args);
-    buffer.resize(static_cast<std::size_t>(needed));
-    return buffer;
+std::int64_t SessionLogger::monotonicNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
 std::string SessionLogger::resolveLogDirectory() {
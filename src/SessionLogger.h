@@ -1,43 +1,91 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdarg>
-#include <deque>
-#include <fstream>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <thread>
 
+// Session log file. log()/logf() copy the line into a fixed-size slot of a
+// bounded lock-free queue, stamped with the monotonic clock; any thread may
+// call them, none blocks, and nothing is allocated. When the queue is full
+// the line is dropped and counted. A worker drains the queue (and the
+// detection trace rings, see TraceRing.h) every few tens of milliseconds,
+// writes each batch with one writev(), fdatasync()s about once a second, and
+// logs how many lines were dropped whenever that number moves.
 class SessionLogger {
 public:
     static SessionLogger& instance();
 
-    void log(const std::string& component, const std::string& message);
-    void logf(const std::string& component, const char* fmt, ...);
+    void log(std::string_view component, std::string_view message);
+    void logf(std::string_view component, const char* fmt, ...);
 
     [[nodiscard]] bool enabled() const { return m_ready; }
     [[nodiscard]] const std::string& logFilePath() const { return m_logPath; }
+    // Lines lost to a full queue since the session started.
+    [[nodiscard]] std::uint64_t droppedLines() const { return m_dropped.load(std::memory_order_relaxed); }
 
 private:
+    static constexpr std::size_t kQueueSlots = 512;      // power of two
+    static constexpr std::size_t kComponentChars = 24;
+    static constexpr std::size_t kTextChars = 456;       // longer lines are truncated
+
+    struct Slot {
+        std::atomic<std::uint64_t> sequence {0};
+        std::int64_t monotonicNs = 0;
+        std::uint16_t componentLength = 0;
+        std::uint16_t textLength = 0;
+        char component[kComponentChars];
+        char text[kTextChars];
+    };
+
     SessionLogger();
     ~SessionLogger();
 
     SessionLogger(const SessionLogger&) = delete;
     SessionLogger& operator=(const SessionLogger&) = delete;
 
-    void writeLine(const std::string& component, const std::string& message);
-    void enqueue(std::string line);
+    // Claims a slot, or nullptr (and counts a drop) when the queue is full.
+    Slot* acquireSlot(std::uint64_t& position);
+    void publishSlot(Slot& slot, std::uint64_t position);
     void workerLoop();
-    std::string composeLine(const std::string& component, const std::string& message) const;
-    static std::string formatString(const char* fmt, va_list args);
+    std::size_t writeQueued();
+    void drainTraces();
+    void writeDropSummary();
+    void writeAll(const char* data, std::size_t length);
+    void syncIfDue(bool force);
+    std::size_t formatPrefix(char* out, std::size_t capacity, std::int64_t monotonicNs, std::string_view component) const;
+    static std::int64_t monotonicNow();
     static std::string resolveLogDirectory();
 
     std::string m_logPath;
     bool m_ready {false};
-    std::ofstream m_stream;
-    std::mutex m_queueMutex;
+    int m_fd {-1};
+
+    std::unique_ptr<Slot[]> m_slots;
+    std::atomic<std::uint64_t> m_enqueuePos {0};
+    std::uint64_t m_dequeuePos {0};                       // worker only
+    std::atomic<std::uint64_t> m_dropped {0};
+
+    // Worker only.
+    std::uint64_t m_reportedDropped {0};
+    std::uint64_t m_droppedTraces {0};
+    std::uint64_t m_unsyncedBytes {0};
+    std::int64_t m_lastSyncNs {0};
+    std::string m_traceBatch;
+
+    // Wall-clock time of m_startMonotonicNs, for the line timestamps.
+    std::chrono::system_clock::time_point m_startWall;
+    std::int64_t m_startMonotonicNs {0};
+
+    std::mutex m_wakeMutex;                               // worker sleep and shutdown only
     std::condition_variable m_cv;
-    std::deque<std::string> m_pending;
     bool m_running {false};
     std::thread m_worker;
 };
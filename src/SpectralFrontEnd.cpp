@@ -0,0 +1,279 @@
+#include "SpectralFrontEnd.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+// log(1 + lambda * |X|) before differencing, as aubio does for "specflux".
+constexpr float kFluxCompression = 10.0f;
+constexpr float kOnsetMinIoiSec = 0.020f;
+// A flux peak only counts as an onset if it reaches this fraction of the
+// recent maximum, which decays with kFluxPeakReleaseSec. Keeps the ripple of
+// a ringing string from re-triggering without an absolute flux scale.
+constexpr float kOnsetPeakFraction = 0.1f;
+constexpr float kFluxPeakReleaseSec = 0.5f;
+// The marker stays up this long after the peak: StringTracker only opens a
+// note once the pitch has settled, which takes a few hops after the attack.
+constexpr float kOnsetHoldSec = 0.030f;
+constexpr float kLevelFloor = 1.0e-20f;
+
+float levelDb(float energy, int n) {
+  return 10.f * std::log10(std::max(energy / static_cast<float>(std::max(n, 1)), kLevelFloor));
+}
+}
+
+void SpectralFrontEnd::configure(int fftSize, int hopSize, float sampleRate, float minPitchHz, float maxPitchHz) {
+  _fftSize = 0;
+  _hopSize = 0;
+  if (fftSize < 4 || (fftSize & (fftSize - 1)) != 0 || hopSize <= 0 || hopSize > fftSize || sampleRate <= 0.f)
+    return;
+
+  const int half = fftSize / 2;
+  const std::size_t n = static_cast<std::size_t>(fftSize);
+  const std::size_t bins = static_cast<std::size_t>(half + 1);
+  _sampleRate = sampleRate;
+
+  _history.assign(n, 0.f);
+  _window.resize(n);
+  for (std::size_t i = 0; i < n; ++i)
+    _window[i] = 0.5f - 0.5f * std::cos(2.f * float(M_PI) * static_cast<float>(i) / static_cast<float>(n));
+  _real.assign(n, 0.f);
+  _packed.assign(static_cast<std::size_t>(half), {});
+  _twiddle.resize(static_cast<std::size_t>(std::max(half / 2, 1)));
+  for (std::size_t k = 0; k < _twiddle.size(); ++k)
+    _twiddle[k] = std::polar(1.f, -2.f * float(M_PI) * static_cast<float>(k) / static_cast<float>(half));
+  _split.resize(bins);
+  for (std::size_t k = 0; k < bins; ++k)
+    _split[k] = std::polar(1.f, -2.f * float(M_PI) * static_cast<float>(k) / static_cast<float>(n));
+  _bitReverse.resize(static_cast<std::size_t>(half));
+  int bits = 0;
+  while ((1 << bits) < half)
+    ++bits;
+  for (int i = 0; i < half; ++i) {
+    int r = 0;
+    for (int b = 0; b < bits; ++b)
+      r |= ((i >> b) & 1) << (bits - 1 - b);
+    _bitReverse[static_cast<std::size_t>(i)] = r;
+  }
+  _magnitude.assign(bins, 0.f);
+  _power.assign(bins, 0.f);
+  _prevCompressed.assign(bins, 0.f);
+
+  _fftSize = fftSize;
+  _hopSize = hopSize;
+  _fluxPeakDecay = std::exp(-static_cast<float>(hopSize) / (sampleRate * kFluxPeakReleaseSec));
+  _onsetHoldHops = std::max(1, static_cast<int>(std::ceil(kOnsetHoldSec * sampleRate / static_cast<float>(hopSize))));
+
+  // Lags past half the window see too little overlap to be trusted.
+  _minLag = std::max(2, static_cast<int>(std::floor(sampleRate / std::max(maxPitchHz, 1.f))));
+  _maxLag = std::min(half - 1, static_cast<int>(std::ceil(sampleRate / std::max(minPitchHz, 1.f))));
+  _difference.assign(static_cast<std::size_t>(std::max(_maxLag, 0) + 2), 1.f);
+
+  // The windowed autocorrelation is the signal's times the window's; divide
+  // the latter out so the difference function does not rise with lag.
+  for (std::size_t i = 0; i < n; ++i)
+    _real[i] = _window[i];
+  forward();
+  inverse();
+  _windowAutocorr.assign(_difference.size(), 1.f);
+  const float w0 = _real[0];
+  for (std::size_t tau = 0; tau < _windowAutocorr.size() && tau < n; ++tau)
+    _windowAutocorr[tau] = w0 > 0.f ? std::max(_real[tau] / w0, 1.0e-3f) : 1.f;
+
+  reset();
+}
+
+void SpectralFrontEnd::reset() {
+  std::fill(_history.begin(), _history.end(), 0.f);
+  std::fill(_prevCompressed.begin(), _prevCompressed.end(), 0.f);
+  _fluxHistory.fill(0.f);
+  _fluxCount = 0;
+  _fluxPos = 0;
+  _peek.fill(0.f);
+  _prevFlux = 0.f;
+  _fluxPeak = 0.f;
+  _heldOnset = 0.f;
+  _onsetHoldRemaining = 0;
+  _hopsSinceOnset = std::numeric_limits<int>::max() / 2;
+}
+
+void SpectralFrontEnd::transform(bool inverse) {
+  const std::size_t m = _packed.size();
+  for (std::size_t i = 0; i < m; ++i) {
+    const std::size_t j = static_cast<std::size_t>(_bitReverse[i]);
+    if (i < j)
+      std::swap(_packed[i], _packed[j]);
+  }
+  for (std::size_t len = 2; len <= m; len <<= 1) {
+    const std::size_t halfLen = len / 2;
+    const std::size_t step = m / len;
+    for (std::size_t start = 0; start < m; start += len) {
+      for (std::size_t j = 0; j < halfLen; ++j) {
+        const std::complex<float> w = inverse ? std::conj(_twiddle[j * step]) : _twiddle[j * step];
+        const std::complex<float> a = _packed[start + j];
+        const std::complex<float> b = _packed[start + j + halfLen] * w;
+        _packed[start + j] = a + b;
+        _packed[start + j + halfLen] = a - b;
+      }
+    }
+  }
+}
+
+void SpectralFrontEnd::forward() {
+  // Real FFT of _real via a half-size complex FFT of (even, odd) pairs.
+  const std::size_t m = _packed.size();
+  for (std::size_t i = 0; i < m; ++i)
+    _packed[i] = {_real[2 * i], _real[2 * i + 1]};
+  transform(false);
+  for (std::size_t k = 0; k <= m; ++k) {
+    const std::complex<float> z = _packed[k % m];
+    const std::complex<float> zc = std::conj(_packed[(m - k) % m]);
+    const std::complex<float> even = 0.5f * (z + zc);
+    const std::complex<float> odd = std::complex<float>(0.f, -0.5f) * (z - zc);
+    const std::complex<float> x = even + _split[k] * odd;
+    _power[k] = std::norm(x);
+    _magnitude[k] = std::sqrt(_power[k]);
+  }
+}
+
+void SpectralFrontEnd::inverse() {
+  // Inverse real FFT of the (real, even) power spectrum: the circular
+  // autocorrelation of the windowed frame, written back into _real.
+  const std::size_t m = _packed.size();
+  for (std::size_t k = 0; k < m; ++k) {
+    const float even = 0.5f * (_power[k] + _power[m - k]);
+    const std::complex<float> odd = 0.5f * (_power[k] - _power[m - k]) * std::conj(_split[k]);
+    _packed[k] = std::complex<float>(even, 0.f) + std::complex<float>(0.f, 1.f) * odd;
+  }
+  transform(true);
+  const float scale = 1.f / static_cast<float>(m);
+  for (std::size_t i = 0; i < m; ++i) {
+    _real[2 * i] = _packed[i].real() * scale;
+    _real[2 * i + 1] = _packed[i].imag() * scale;
+  }
+}
+
+SpectralFrame SpectralFrontEnd::process(const float* in, float gain) {
+  SpectralFrame frame;
+  if (_fftSize <= 0)
+    return frame;
+
+  const std::size_t hop = static_cast<std::size_t>(_hopSize);
+  std::move(_history.begin() + static_cast<std::ptrdiff_t>(hop), _history.end(), _history.begin());
+  float* tail = _history.data() + (_history.size() - hop);
+  float energy = 0.f;
+  for (std::size_t i = 0; i < hop; ++i) {
+    const float x = in ? in[i] * gain : 0.f;
+    tail[i] = x;
+    energy += x * x;
+  }
+  const float hopDb = levelDb(energy, _hopSize);
+
+  for (std::size_t i = 0; i < _history.size(); ++i)
+    _real[i] = _history[i] * _window[i];
+  forward();
+
+  for (std::size_t k = 0; k < _magnitude.size(); ++k) {
+    const float compressed = std::log1p(kFluxCompression * _magnitude[k]);
+    const float rise = compressed - _prevCompressed[k];
+    if (rise > 0.f)
+      frame.flux += rise;
+    _prevCompressed[k] = compressed;
+    frame.hfc += static_cast<float>(k + 1) * _magnitude[k];
+  }
+  frame.flux /= static_cast<float>(_magnitude.size());
+  frame.onset = pickOnset(frame.flux, hopDb);
+
+  if (_pitchEnabled && hopDb >= _pitchSilenceDb && _maxLag > _minLag + 1) {
+    inverse();
+    frame.pitchHz = estimatePitch(frame.pitchClarity);
+  }
+  return frame;
+}
+
+float SpectralFrontEnd::pickOnset(float flux, float hopDb) {
+  // aubio's peak picker: flux above the running median plus threshold times
+  // the running mean, reported from the hop after the local maximum.
+  _fluxHistory[static_cast<std::size_t>(_fluxPos)] = flux;
+  _fluxPos = (_fluxPos + 1) % kOnsetHistory;
+  _fluxCount = std::min(_fluxCount + 1, kOnsetHistory);
+
+  std::array<float, kOnsetHistory> sorted = _fluxHistory;
+  const auto count = static_cast<std::ptrdiff_t>(_fluxCount);
+  float mean = 0.f;
+  for (std::ptrdiff_t i = 0; i < count; ++i)
+    mean += sorted[static_cast<std::size_t>(i)];
+  mean /= static_cast<float>(_fluxCount);
+  std::nth_element(sorted.begin(), sorted.begin() + count / 2, sorted.begin() + count);
+  const float median = sorted[static_cast<std::size_t>(count / 2)];
+
+  _peek[0] = _peek[1];
+  _peek[1] = _peek[2];
+  _peek[2] = flux - median - _onsetThreshold * mean;
+  const float peakFlux = _prevFlux;
+  _prevFlux = flux;
+  _fluxPeak = std::max(flux, _fluxPeak * _fluxPeakDecay);
+  if (_hopsSinceOnset < std::numeric_limits<int>::max() / 2)
+    ++_hopsSinceOnset;
+
+  if (detectPeak(peakFlux, hopDb)) {
+    const float curvature = _peek[0] - 2.f * _peek[1] + _peek[2];
+    const float offset = curvature < 0.f ? 0.5f * (_peek[0] - _peek[2]) / curvature : 0.f;
+    _heldOnset = 1.f + std::clamp(offset, -0.5f, 0.5f);
+    _onsetHoldRemaining = _onsetHoldHops;
+  }
+  if (_onsetHoldRemaining <= 0)
+    return 0.f;
+  --_onsetHoldRemaining;
+  return _heldOnset;
+}
+
+bool SpectralFrontEnd::detectPeak(float peakFlux, float hopDb) {
+  if (hopDb < _onsetSilenceDb)
+    return false;
+  if (!(_peek[1] > 0.f && _peek[1] > _peek[0] && _peek[1] >= _peek[2]))
+    return false;
+  if (peakFlux < kOnsetPeakFraction * _fluxPeak)
+    return false;
+  if (static_cast<float>(_hopsSinceOnset) * static_cast<float>(_hopSize) < kOnsetMinIoiSec * _sampleRate)
+    return false;
+  _hopsSinceOnset = 0;
+  return true;
+}
+
+float SpectralFrontEnd::estimatePitch(float& clarity) {
+  const float r0 = _real[0];
+  if (r0 <= 0.f)
+    return -1.f;
+
+  // Cumulative-mean-normalised difference (YIN step 3) with
+  // d(tau) = 2 * (r(0) - r(tau)).
+  float running = 0.f;
+  _difference[0] = 1.f;
+  for (int tau = 1; tau <= _maxLag; ++tau) {
+    const std::size_t t = static_cast<std::size_t>(tau);
+    const float diff = std::max(0.f, 2.f * (r0 - _real[t] / _windowAutocorr[t]));
+    running += diff;
+    _difference[t] = running > 0.f ? diff * static_cast<float>(tau) / running : 1.f;
+  }
+
+  int best = 0;
+  for (int tau = _minLag; tau < _maxLag; ++tau) {
+    if (_difference[static_cast<std::size_t>(tau)] < _pitchTolerance) {
+      while (tau + 1 < _maxLag && _difference[static_cast<std::size_t>(tau + 1)] < _difference[static_cast<std::size_t>(tau)])
+        ++tau;
+      best = tau;
+      break;
+    }
+  }
+  if (best <= 0)
+    return -1.f;
+
+  const float a = _difference[static_cast<std::size_t>(best - 1)];
+  const float b = _difference[static_cast<std::size_t>(best)];
+  const float c = _difference[static_cast<std::size_t>(best + 1)];
+  const float denom = a - 2.f * b + c;
+  const float shift = denom > 0.f ? std::clamp(0.5f * (a - c) / denom, -0.5f, 0.5f) : 0.f;
+  clarity = 1.f - b;
+  return _sampleRate / (static_cast<float>(best) + shift);
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+// Per-hop analysis for one StringTracker built on a single windowed FFT:
+// log-compressed spectral flux (peak-picked like aubio's "specflux" onset),
+// high-frequency content, and a YIN difference function taken from the
+// autocorrelation of the same power spectrum (inverse FFT, corrected for the
+// Hann window's own autocorrelation). Replaces running aubio onset and pitch
+// side by side, which windowed, transformed and buffered every hop twice.
+// configure() allocates; reset() and process() do not.
+
+struct SpectralFrame {
+  float onset = 0.f;         // > 0 from the hop after a flux peak, held for ~30 ms
+  float flux = 0.f;          // log-compressed positive spectral difference, per bin
+  float hfc = 0.f;
+  float pitchHz = -1.f;      // -1 when unvoiced or below the pitch silence level
+  float pitchClarity = 0.f;  // 1 - normalised difference at the chosen lag
+};
+
+class SpectralFrontEnd {
+public:
+  // fftSize must be a power of two >= 4 and >= hopSize.
+  void configure(int fftSize, int hopSize, float sampleRate, float minPitchHz, float maxPitchHz);
+  void reset();
+
+  void setOnsetThreshold(float threshold) { _onsetThreshold = threshold; }
+  void setOnsetSilenceDb(float db) { _onsetSilenceDb = db; }
+  void setPitchSilenceDb(float db) { _pitchSilenceDb = db; }
+  void setPitchTolerance(float tolerance) { _pitchTolerance = tolerance; }
+  // Off skips the inverse FFT and the difference function (pitch comes from elsewhere).
+  void setPitchEnabled(bool enabled) { _pitchEnabled = enabled; }
+
+  bool ready() const { return _fftSize > 0; }
+  int fftSize() const { return _fftSize; }
+  int hopSize() const { return _hopSize; }
+
+  // Appends hopSize() samples of in, each multiplied by gain, and analyses
+  // the fftSize() window ending there.
+  SpectralFrame process(const float* in, float gain);
+
+private:
+  static constexpr int kOnsetHistory = 7; // aubio peak picker: 1 hop before, 5 after, plus the current one
+
+  void forward();
+  void inverse();
+  void transform(bool inverse);
+  float pickOnset(float flux, float levelDb);
+  bool detectPeak(float peakFlux, float levelDb);
+  float estimatePitch(float& clarity);
+
+  int _fftSize = 0;
+  int _hopSize = 0;
+  float _sampleRate = 0.f;
+  int _minLag = 0;
+  int _maxLag = 0;
+
+  float _onsetThreshold = 0.1f;
+  float _onsetSilenceDb = -70.f;
+  float _pitchSilenceDb = -70.f;
+  float _pitchTolerance = 0.15f;
+  bool _pitchEnabled = true;
+
+  std::vector<float> _history;                 // last fftSize input samples, oldest first
+  std::vector<float> _window;
+  std::vector<float> _windowAutocorr;          // normalised to 1 at lag 0
+  std::vector<float> _real;                    // fftSize real samples in / out of the transform
+  std::vector<std::complex<float>> _packed;    // fftSize / 2 bins of the half-size complex FFT
+  std::vector<std::complex<float>> _twiddle;   // half-size FFT twiddles
+  std::vector<std::complex<float>> _split;     // real-FFT split factors, e^{-2 pi i k / fftSize}
+  std::vector<int> _bitReverse;
+  std::vector<float> _magnitude;               // fftSize / 2 + 1
+  std::vector<float> _power;
+  std::vector<float> _prevCompressed;
+  std::vector<float> _difference;              // cumulative-mean-normalised, up to _maxLag + 1
+
+  std::array<float, kOnsetHistory> _fluxHistory {};
+  int _fluxCount = 0;
+  int _fluxPos = 0;
+  std::array<float, 3> _peek {};               // thresholded flux of the last three hops
+  float _prevFlux = 0.f;
+  float _fluxPeak = 0.f;
+  float _fluxPeakDecay = 1.f;
+  float _heldOnset = 0.f;
+  int _onsetHoldHops = 1;
+  int _onsetHoldRemaining = 0;
+  int _hopsSinceOnset = 0;
+};
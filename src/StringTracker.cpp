@@ -1,14 +1,14 @@
 #include "StringTracker.h"
 #include "SessionLogger.h"
+#include "TraceRing.h"
 #include "StringTrackerParams.h"
+#include "TrackerRebuilder.h"
 #include "util.h"
 #include <array>
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cmath>
-#include <limits>
-#include <cstdio>
 #include <mutex>
 
 namespace {
@@ -24,6 +24,8 @@ constexpr float kEnvRiseAlpha = 0.15f;
 constexpr float kEnvFallAlpha = 0.03f;
 constexpr float kEnvMin = 1.0e-5f;
 constexpr int kReleaseQuietFrameCount = 8;
+constexpr float kFeatureHistorySec = 0.8f;
+constexpr std::size_t kPitchMedianWindow = 5;
 constexpr float kOpenBiasMinHoldSec = 0.36f;
 constexpr float kLowStringRetriggerGuardSec = 0.22f;
 constexpr int kAubioDebugString = 0; // set to -1 to disable raw aubio logging
@@ -32,6 +34,13 @@ constexpr float kCalibrationMinTargetRms = 5.0e-5f;
 constexpr float kCalibrationMaxTargetRms = 0.02f;
 constexpr float kCalibrationGainMin = 0.2f;
 constexpr float kCalibrationGainMax = 8.0f;
+// Multi-rate analysis: decimate only when the analysis rate keeps at least this
+// many samples per cycle of the band's high cut, and only by 3 or 4 (16 or
+// 12 kHz at 48 kHz), which in practice selects the three low strings.
+constexpr float kDecimationOversample = 20.0f;
+constexpr int kMinDecimation = 3;
+constexpr int kMinDecimatedHop = 16;
+constexpr int kMinHopSamples = 32;
 
 std::once_flag gLoggedTrackerSettings;
 
@@ -39,12 +48,19 @@ void logTrackerSettingsOnce(const Tuning& tuning, const TrackerConfig& cfg) {
   std::call_once(gLoggedTrackerSettings, [&]() {
     auto& logger = SessionLogger::instance();
     logger.logf("tracker-settings",
-                "TrackerConfig onsetThreshold=%.5f minNoteDurSec=%.3f hopSec=%.3f slideDelta=%.1f bendDelta=%.1f",
+                "TrackerConfig onsetThreshold=%.5f minNoteDurSec=%.3f hopSec=%.3f analysisHop=%d slideDelta=%.1f bendDelta=%.1f multirate=%d spectral=%d nativePitch=%d fretBank=0x%02x energyGate=%d sustainStride=%d",
                 cfg.onsetThreshold,
                 cfg.minNoteDurSec,
                 cfg.hopSec,
+                cfg.analysisHopSamples,
                 cfg.slideDeltaCents,
-                cfg.bendDeltaCents);
+                cfg.bendDeltaCents,
+                cfg.multirateLowStrings ? 1 : 0,
+                cfg.spectralFrontEnd ? 1 : 0,
+                cfg.nativePitch ? 1 : 0,
+                cfg.fretBankStrings,
+                cfg.energyGate ? 1 : 0,
+                cfg.sustainPitchStride);
 
     for (int s = 0; s < 6; ++s) {
       const int midi = tuning.stringMidi[static_cast<std::size_t>(s)];
@@ -71,52 +87,36 @@ void logTrackerSettingsOnce(const Tuning& tuning, const TrackerConfig& cfg) {
   });
 }
 
-float stringLowCutMultiplier(int s) {
-  return trackerparams::lowCutMultiplier(s);
+int analysisDecimation(float sr, float highCutHz) {
+  if (sr <= 0.f || highCutHz <= 0.f)
+    return 1;
+  const int factor = std::min(static_cast<int>(sr / (highCutHz * kDecimationOversample)), Decimator::kMaxFactor);
+  return factor >= kMinDecimation ? factor : 1;
 }
 
-float stringHighCutMultiplier(int s) {
-  return trackerparams::highCutMultiplier(s);
+float bandLowCut(int openMidi, float multiplier) {
+  return std::max(20.f, midiToHz(openMidi) * multiplier);
 }
 
-float stringOnsetThreshold(int s, float base) {
-  return trackerparams::onsetThresholdScale(s, base);
+float bandHighCut(int openMidi, float multiplier) {
+  return std::min(6000.f, midiToHz(openMidi + 24) * multiplier);
 }
 
-float stringBaselineFloor(int s) {
-  return trackerparams::baselineFloor(s);
+float aubioOnsetThreshold(float base, const trackerparams::TrackerParamSnapshot& params) {
+  return std::clamp(base * params.aubioThresholdScale, 0.01f, 0.18f);
 }
 
-float stringGateRatio(int s) {
-  return trackerparams::gateRatio(s);
+std::size_t pendingCapacity(int hopSamples, int blockOutput) {
+  return static_cast<std::size_t>(hopSamples + blockOutput);
 }
 
-float stringEnvelopeFloor(int s) {
-  return trackerparams::envelopeFloor(s);
-}
-
-float stringPeakReleaseRatio(int s) {
-  return trackerparams::peakReleaseRatio(s);
-}
-
-float stringSustainFloorScale(int s) {
-  return trackerparams::sustainFloorScale(s);
-}
-
-float stringRetriggerGateScale(int s) {
-  return trackerparams::retriggerGateScale(s);
-}
-
-float stringAubioThresholdScale(int s) {
-  return trackerparams::aubioThresholdScale(s);
-}
-
-float stringOnsetSilenceDb(int s) {
-  return trackerparams::onsetSilenceDb(s);
-}
-
-float stringPitchSilenceDb(int s) {
-  return trackerparams::pitchSilenceDb(s);
+// The feature history, plus every hop one block can add before it is pruned.
+std::size_t featureCapacity(int hopSamples, float hopSec, int blockOutput) {
+  if (hopSamples <= 0 || hopSec <= 0.f)
+    return 0;
+  const std::size_t historyHops = static_cast<std::size_t>(std::ceil(kFeatureHistorySec / hopSec)) + 2;
+  const std::size_t blockHops = static_cast<std::size_t>(blockOutput / hopSamples) + 2;
+  return historyHops + blockHops;
 }
 
 inline float energyToVelocity(float rmsVal) {
@@ -127,11 +127,22 @@ int stringFftMultiple(int s) {
   return trackerparams::fftMultiple(s);
 }
 
-float stringPitchTolerance(int s) {
-  return trackerparams::pitchTolerance(s);
-}
-
 constexpr float kSliderMixEpsilon = 1.0e-7f;
+// Energy gate (TrackerConfig::energyGate), as fractions of the lowest
+// envelope detectOnset() could accept. Pitch pauses first; onset detection
+// only once the string is quieter still.
+constexpr float kPitchGateRatio = 0.5f;
+constexpr float kOnsetGateRatio = 0.25f;
+// Quiet hops before either gate closes; the first louder hop reopens it.
+constexpr int kGateHoldHops = 4;
+// Sustain duty cycle (TrackerConfig::sustainPitchStride): hops the open
+// note's pitch must hold before estimates thin out, and the envelope rise
+// (a re-pluck, hammer-on) that returns to every hop. A hop is shorter than
+// a low note's period, so the rise is measured against a peak hold that
+// releases per hop rather than against the previous hop.
+constexpr int kSustainSettleHops = 8;
+constexpr float kSustainRiseRatio = 1.25f;
+constexpr float kSustainPeakRelease = 0.97f;
 
 // Keeps automatic floor estimates from overwhelming user-provided slider values.
 float sliderDominantMix(float base, float candidate, float maxBoost) {
@@ -150,8 +161,7 @@ void StringTracker::BandpassFilter::reset() {
   lpState = 0.f;
 }
 
-void StringTracker::BandpassFilter::configure(float sr, float lowCutHz, float highCutHz, int stringIdx) {
-  reset();
+void StringTracker::BandpassFilter::configure(float sr, float lowCutHz, float highCutHz) {
   if (sr <= 0.f) {
     hpAlpha = 0.f;
     lpBeta = 1.f;
@@ -163,10 +173,6 @@ void StringTracker::BandpassFilter::configure(float sr, float lowCutHz, float hi
 
   hpAlpha = std::exp(-2.0f * float(M_PI) * low / sr);
   lpBeta = std::exp(-2.0f * float(M_PI) * high / sr);
-  if (stringIdx == 0) {
-    std::fprintf(stderr, "Low E bandpass: %.1f–%.1f Hz (sr=%.1f)\n",
-                 low, high, sr);
-  }
 }
 
 float StringTracker::BandpassFilter::process(float x) {
@@ -182,128 +188,398 @@ float StringTracker::BandpassFilter::process(float x) {
 StringTracker::StringTracker(int stringIdx,
                              const Tuning& t,
                              const TrackerConfig& c,
-                             std::vector<NoteEvent>& sharedEvents,
+                             NoteEventStore& sharedEvents,
                              std::vector<int>& activeIdx)
 : _s(stringIdx), _tuning(t), _cfg(c), _events(sharedEvents), _activeIdx(activeIdx)
 {
   logTrackerSettingsOnce(_tuning, _cfg);
-  _filter.reset();
-  _filteredScratch.reserve(2048);
+  _staged.reserve(16);
+  _pitchMedianWindow.reserve(kPitchMedianWindow + 1);
   _calibrationAvgRms = 0.001f;
   _calibrationValid = false;
   refreshCalibrationTarget();
 }
 
 StringTracker::~StringTracker() {
+  // TabEngine stops the rebuilder first, so nothing is being built here.
+  delete _built;
+  delete _retired.exchange(nullptr, std::memory_order_acquire);
+}
+
+StringTracker::Dsp::~Dsp() {
+#ifdef HAVE_AUBIO
+  if (aubioOnset) { del_aubio_onset(aubioOnset); aubioOnset = nullptr; }
+  if (aubioPitch) { del_aubio_pitch(aubioPitch); aubioPitch = nullptr; }
+  if (aubioIn) { del_fvec(aubioIn); aubioIn = nullptr; }
+  if (aubioOnsetOut) { del_fvec(aubioOnsetOut); aubioOnsetOut = nullptr; }
+  if (aubioPitchOut) { del_fvec(aubioPitchOut); aubioPitchOut = nullptr; }
+#endif
+}
+
+bool StringTracker::DspSpec::matches(const DspSpec& other) const {
+  return std::fabs(sr - other.sr) < 1e-3f && configuredHop == other.configuredHop
+      && multirate == other.multirate && spectralFrontEnd == other.spectralFrontEnd
+      && nativePitch == other.nativePitch && fretBank == other.fretBank && sustainProbe == other.sustainProbe
+      && onsetThreshold == other.onsetThreshold
+      && params.stageGeneration[static_cast<std::size_t>(NoteStage::Filter)]
+             == other.params.stageGeneration[static_cast<std::size_t>(NoteStage::Filter)];
+}
+
+void StringTracker::Dsp::reset() {
+  decimator.reset();
+  filter.reset();
+  frontEnd.reset();
+  pitchEstimator.reset();
+  fretBank.reset();
+  driftProbe.reset();
 #ifdef HAVE_AUBIO
-  if (_aubioOnset) { del_aubio_onset(_aubioOnset); _aubioOnset = nullptr; }
-  if (_aubioPitch) { del_aubio_pitch(_aubioPitch); _aubioPitch = nullptr; }
-  if (_aubioIn) { del_fvec(_aubioIn); _aubioIn = nullptr; }
-  if (_aubioOnsetOut) { del_fvec(_aubioOnsetOut); _aubioOnsetOut = nullptr; }
-  if (_aubioPitchOut) { del_fvec(_aubioPitchOut); _aubioPitchOut = nullptr; }
+  if (aubioIn) {
+    for (uint_t i = 0; i < aubioIn->length; ++i)
+      aubioIn->data[i] = 0.f;
+  }
 #endif
 }
 
-void StringTracker::configureProcessing(float sr, int blockSamples) {
+void StringTracker::Dsp::applyOnsetParams(const trackerparams::TrackerParamSnapshot& params) {
+  const float aubioThresh = aubioOnsetThreshold(spec.onsetThreshold, params);
+  if (useFrontEnd) {
+    frontEnd.setOnsetThreshold(aubioThresh);
+    frontEnd.setOnsetSilenceDb(params.onsetSilenceDb);
+  }
+#ifdef HAVE_AUBIO
+  if (aubioOnset) {
+    aubio_onset_set_silence(aubioOnset, params.onsetSilenceDb);
+    aubio_onset_set_threshold(aubioOnset, aubioThresh);
+  }
+#endif
+}
+
+void StringTracker::Dsp::applyPitchParams(const trackerparams::TrackerParamSnapshot& params) {
+  if (useFretBank) {
+    fretBank.setTolerance(params.pitchTolerance);
+    fretBank.setSilenceDb(params.pitchSilenceDb);
+  }
+  if (useNativePitch) {
+    pitchEstimator.setTolerance(params.pitchTolerance);
+    pitchEstimator.setSilenceDb(params.pitchSilenceDb);
+  }
+  if (useFrontEnd) {
+    frontEnd.setPitchSilenceDb(params.pitchSilenceDb);
+    frontEnd.setPitchTolerance(params.pitchTolerance);
+  }
+#ifdef HAVE_AUBIO
+  if (aubioPitch) {
+    aubio_pitch_set_silence(aubioPitch, params.pitchSilenceDb);
+    aubio_pitch_set_tolerance(aubioPitch, params.pitchTolerance);
+  }
+#endif
+}
+
+void StringTracker::configureProcessing(float sr, int blockSamples, bool buildInline) {
   if (sr <= 0.f || blockSamples <= 0)
     return;
 
-  const std::uint64_t storeGen = trackerparams::settingsGeneration();
-  const bool paramsChanged = (storeGen != _paramGeneration);
-  const int desiredHop = std::max(64, blockSamples);
-  if (!paramsChanged && std::fabs(sr - _currentSr) < 1e-3f && desiredHop == _hopSamples)
+  // One acquire load per block; the snapshot is only copied when an edit
+  // reached this string, and a copy that raced an edit waits for the next
+  // block.
+  if (_params.generation == 0 || trackerparams::stringGeneration(_s) != _params.stringGeneration) {
+    const trackerparams::TrackerParamSnapshot previous = _params;
+    if (trackerparams::pullSnapshot(_s, _params)) {
+      refreshCalibrationTarget();
+      if (_dsp)
+        applyParamChanges(previous);
+    }
+  }
+  if (_params.generation == 0)
     return;
 
-  if (paramsChanged)
-    refreshCalibrationTarget();
+  // A replacement finished on the rebuilder thread goes in at this block
+  // boundary, once the one it replaced last time has been deleted.
+  if (_rebuildState.load(std::memory_order_acquire) == kRebuildReady
+      && !_retired.load(std::memory_order_acquire)) {
+    std::unique_ptr<Dsp> next(_built);
+    _built = nullptr;
+    _rebuildState.store(kRebuildIdle, std::memory_order_relaxed);
+    installDsp(std::move(next));
+  }
 
-  _paramGeneration = storeGen;
-  _currentSr = sr;
-  _hopSamples = desiredHop;
-  _currentHopSec = static_cast<float>(_hopSamples) / _currentSr;
-
-  _fftSize = 1;
-  const int fftTarget = std::max(_hopSamples * stringFftMultiple(_s), _hopSamples * 4);
-  while (_fftSize < fftTarget)
-    _fftSize <<= 1;
-
-  const float openHz = midiToHz(_tuning.stringMidi[_s]);
-  const float lowCut = std::max(20.f, openHz * stringLowCutMultiplier(_s));
-  const float highestNote = midiToHz(_tuning.stringMidi[_s] + 24);
-  const float highCut = std::min(6000.f, highestNote * stringHighCutMultiplier(_s));
-  _filter.configure(sr, lowCut, highCut, _s);
+  DspSpec spec;
+  spec.sr = sr;
+  spec.blockSamples = blockSamples;
+  spec.configuredHop = std::max(kMinHopSamples, _cfg.analysisHopSamples);
+  spec.multirate = _cfg.multirateLowStrings;
+  spec.spectralFrontEnd = _cfg.spectralFrontEnd;
+  spec.nativePitch = _cfg.nativePitch;
+  spec.fretBank = fretBankSelected();
+  spec.sustainProbe = _cfg.sustainPitchStride > 1;
+  spec.onsetThreshold = _cfg.onsetThreshold;
+  spec.params = _params;
+  if (_dsp && _dsp->spec.matches(spec)) {
+    reservePending(blockSamples);
+    return;
+  }
+
+  // Builds without a rebuilder (tools, benchmarks) and the first build from
+  // prepare() happen here. Everything else, a first build on the audio
+  // thread included, goes to the rebuilder: the current state, or silence
+  // when there is none yet, runs until the replacement is ready a few blocks
+  // later.
+  if (!_rebuilder || (buildInline && !_dsp)) {
+    installDsp(buildDsp(spec));
+    reservePending(blockSamples);
+    return;
+  }
+  if (_rebuildState.load(std::memory_order_relaxed) == kRebuildIdle) {
+    _request = spec;
+    _rebuildState.store(kRebuildRequested, std::memory_order_release);
+    _rebuilder->wake();
+  }
+  if (_dsp)
+    reservePending(blockSamples);
+}
+
+void StringTracker::applyParamChanges(const trackerparams::TrackerParamSnapshot& previous) {
+  // Decision thresholds are read from _params every hop and need nothing
+  // here; onset and pitch settings are plain setters.
+  if (_params.changedSince(previous, NoteStage::Onset))
+    _dsp->applyOnsetParams(_params);
+  if (_params.changedSince(previous, NoteStage::Pitch))
+    _dsp->applyPitchParams(_params);
+
+  // New band edges retune the filter in place unless they move the
+  // decimator's passband or factor, which changes the analysis rate or the
+  // anti-alias filter; that is left to a rebuild (the spec no longer matches).
+  if (_params.changedSince(previous, NoteStage::Filter)) {
+    const float lowCut = bandLowCut(_tuning.stringMidi[_s], _params.lowCutMultiplier);
+    const float highCut = bandHighCut(_tuning.stringMidi[_s], _params.highCutMultiplier);
+    const int decimation = _dsp->spec.multirate ? analysisDecimation(_dsp->spec.sr, highCut) : 1;
+    if (decimation != _dsp->decimator.factor() || (_dsp->decimator.active() && highCut != _dsp->highCut))
+      return;
+    _dsp->lowCut = lowCut;
+    _dsp->highCut = highCut;
+    _dsp->filter.configure(_dsp->analysisSr, lowCut, highCut);
+  }
+  _dsp->spec.params = _params;
+}
+
+void StringTracker::serviceRebuild() {
+  delete _retired.exchange(nullptr, std::memory_order_acq_rel);
+  if (_rebuildState.load(std::memory_order_acquire) != kRebuildRequested)
+    return;
+  _built = buildDsp(_request).release();
+  _rebuildState.store(kRebuildReady, std::memory_order_release);
+}
+
+std::unique_ptr<StringTracker::Dsp> StringTracker::buildDsp(const DspSpec& spec) {
+  auto dsp = std::make_unique<Dsp>();
+  dsp->spec = spec;
+  const trackerparams::TrackerParamSnapshot& params = spec.params;
+  const float sr = spec.sr;
+
+  dsp->lowCut = bandLowCut(_tuning.stringMidi[_s], params.lowCutMultiplier);
+  dsp->highCut = bandHighCut(_tuning.stringMidi[_s], params.highCutMultiplier);
+
+  const int decimation = spec.multirate ? analysisDecimation(sr, dsp->highCut) : 1;
+  dsp->decimator.configure(decimation, dsp->highCut, sr);
+  dsp->analysisSr = sr / static_cast<float>(dsp->decimator.factor());
+  dsp->hopSamples = dsp->decimator.active()
+      ? std::max(kMinDecimatedHop, (spec.configuredHop + dsp->decimator.factor() / 2) / dsp->decimator.factor())
+      : spec.configuredHop;
+  dsp->hopSec = static_cast<float>(dsp->hopSamples) / dsp->analysisSr;
+  // Sized here so installDsp() can adopt them instead of growing its own.
+  const int blockOutput = Decimator::maxOutput(spec.blockSamples, dsp->decimator.factor());
+  dsp->pendingRaw.reserve(pendingCapacity(dsp->hopSamples, blockOutput));
+  dsp->pendingFiltered.reserve(pendingCapacity(dsp->hopSamples, blockOutput));
+  dsp->feat.reserve(featureCapacity(dsp->hopSamples, dsp->hopSec, blockOutput));
+
+  dsp->fftSize = 1;
+  const int fftTarget = std::max(dsp->hopSamples * stringFftMultiple(_s), dsp->hopSamples * 4);
+  while (dsp->fftSize < fftTarget)
+    dsp->fftSize <<= 1;
+
+  dsp->filter.configure(dsp->analysisSr, dsp->lowCut, dsp->highCut);
+  dsp->filter.reset();
   SessionLogger::instance().logf("tracker",
-                                 "[s%d] configure sr=%.1f hop=%d fft=%d low=%.1f high=%.1f",
+                                 "[s%d] configure sr=%.1f rate=%.1f decim=%d hop=%d fft=%d low=%.1f high=%.1f",
                                  _s + 1,
                                  sr,
-                                 _hopSamples,
-                                 _fftSize,
-                                 lowCut,
-                                 highCut);
-  const float aubioScale = stringAubioThresholdScale(_s);
-  const float aubioThresh = std::clamp(_cfg.onsetThreshold * aubioScale, 0.01f, 0.18f);
+                                 dsp->analysisSr,
+                                 dsp->decimator.factor(),
+                                 dsp->hopSamples,
+                                 dsp->fftSize,
+                                 dsp->lowCut,
+                                 dsp->highCut);
+  const float aubioScale = params.aubioThresholdScale;
+  const float aubioThresh = aubioOnsetThreshold(spec.onsetThreshold, params);
   SessionLogger::instance().logf("tracker",
                                  "[s%d] params baseline=%.6f gate=%.4f envFloor=%.6f sustain=%.3f retrigger=%.3f peakRelease=%.3f pitchTol=%.3f onsetScale=%.3f aubioScale=%.2f aubioThresh=%.3f onsetSilence=%.1f pitchSilence=%.1f",
                                  _s + 1,
-                                 stringBaselineFloor(_s),
-                                 stringGateRatio(_s),
-                                 stringEnvelopeFloor(_s),
-                                 stringSustainFloorScale(_s),
-                                 stringRetriggerGateScale(_s),
-                                 stringPeakReleaseRatio(_s),
-                                 stringPitchTolerance(_s),
-                                 stringOnsetThreshold(_s, _cfg.onsetThreshold),
+                                 params.baselineFloor,
+                                 params.gateRatio,
+                                 params.envelopeFloor,
+                                 params.sustainFloorScale,
+                                 params.retriggerGateScale,
+                                 params.peakReleaseRatio,
+                                 params.pitchTolerance,
+                                 params.onsetThreshold(spec.onsetThreshold),
                                  aubioScale,
                                  aubioThresh,
-                                 stringOnsetSilenceDb(_s),
-                                 stringPitchSilenceDb(_s));
+                                 params.onsetSilenceDb,
+                                 params.pitchSilenceDb);
 
-  _aubioReady = false;
+  dsp->useFretBank = spec.fretBank;
+#ifdef HAVE_AUBIO
+  dsp->useFrontEnd = spec.spectralFrontEnd;
+  dsp->useNativePitch = spec.nativePitch && !dsp->useFretBank;
+#else
+  dsp->useFrontEnd = true;
+  dsp->useNativePitch = !dsp->useFretBank;
+#endif
+  if (dsp->useFretBank) {
+    dsp->fretBank.configure(dsp->analysisSr, dsp->hopSamples, _tuning.stringMidi[_s]);
+    SessionLogger::instance().logf("tracker",
+                                   "[s%d] fret bank bins=%d window=%d..%d",
+                                   _s + 1,
+                                   dsp->fretBank.binCount(),
+                                   dsp->fretBank.windowSize(FretBank::kFrets - 1),
+                                   dsp->fretBank.windowSize(0));
+  }
+  // The fret bank's sliding sums need every hop, so it is never duty-cycled.
+  // Neither is the native estimator: a skipped hop still has to be appended
+  // and its lag products computed by the next estimate, which is nearly all
+  // of the estimate's cost, so probing would only add the probe's own.
+  dsp->useDriftProbe = spec.sustainProbe && !dsp->useFretBank && !dsp->useNativePitch;
+  if (dsp->useDriftProbe)
+    dsp->driftProbe.configure(dsp->analysisSr, dsp->hopSamples, _tuning.stringMidi[_s]);
+  if (dsp->useNativePitch) {
+    dsp->pitchEstimator.configure(dsp->analysisSr, dsp->hopSamples, _tuning.stringMidi[_s]);
+    SessionLogger::instance().logf("tracker",
+                                   "[s%d] native pitch lags=%d..%d window=%d",
+                                   _s + 1,
+                                   dsp->pitchEstimator.minLag(),
+                                   dsp->pitchEstimator.maxLag(),
+                                   dsp->pitchEstimator.windowSize());
+  }
+  if (dsp->useFrontEnd) {
+    dsp->frontEnd.configure(dsp->fftSize, dsp->hopSamples, dsp->analysisSr, kMinPitchHz, kMaxPitchHz);
+    dsp->frontEnd.setPitchEnabled(!dsp->useNativePitch && !dsp->useFretBank);
+    dsp->ready = dsp->frontEnd.ready() && (!dsp->useNativePitch || dsp->pitchEstimator.ready())
+        && (!dsp->useFretBank || dsp->fretBank.ready());
+    SessionLogger::instance().logf("tracker",
+                                   "[s%d] spectral front end %s hop=%d fft=%d sr=%.1f onsetThresh=%.3f",
+                                   _s + 1,
+                                   dsp->ready ? "initialised" : "init failed",
+                                   dsp->hopSamples,
+                                   dsp->fftSize,
+                                   dsp->analysisSr,
+                                   aubioThresh);
+  }
 #ifdef HAVE_AUBIO
-  if (_aubioOnset) { del_aubio_onset(_aubioOnset); _aubioOnset = nullptr; }
-  if (_aubioPitch) { del_aubio_pitch(_aubioPitch); _aubioPitch = nullptr; }
-  if (_aubioIn) { del_fvec(_aubioIn); _aubioIn = nullptr; }
-  if (_aubioOnsetOut) { del_fvec(_aubioOnsetOut); _aubioOnsetOut = nullptr; }
-  if (_aubioPitchOut) { del_fvec(_aubioPitchOut); _aubioPitchOut = nullptr; }
-
-  _aubioOnset = new_aubio_onset("specflux", static_cast<uint_t>(_fftSize), static_cast<uint_t>(_hopSamples), static_cast<uint_t>(sr));
-  const char* pitchAlgo = (_s <= 1) ? "yin" : "yinfast";
-  _aubioPitch = new_aubio_pitch(pitchAlgo, static_cast<uint_t>(_fftSize), static_cast<uint_t>(_hopSamples), static_cast<uint_t>(sr));
-  _aubioIn = new_fvec(static_cast<uint_t>(_hopSamples));
-  _aubioOnsetOut = new_fvec(1);
-  _aubioPitchOut = new_fvec(1);
-
-  if (_aubioOnset && _aubioPitch && _aubioIn && _aubioOnsetOut && _aubioPitchOut) {
-    aubio_pitch_set_unit(_aubioPitch, "Hz");
-    aubio_pitch_set_silence(_aubioPitch, stringPitchSilenceDb(_s));
-    aubio_pitch_set_tolerance(_aubioPitch, stringPitchTolerance(_s));
-
-    aubio_onset_set_silence(_aubioOnset, stringOnsetSilenceDb(_s));
-    aubio_onset_set_threshold(_aubioOnset, aubioThresh);
-
-    _aubioReady = true;
-        std::fprintf(stderr,
-           "StringTracker[%d]: Aubio initialised (hop=%d, sr=%.1f, aubioScale=%.2f, base=%.3f, onsetThresh=%.3f)\n",
-             _s + 1,
-             _hopSamples,
-           sr,
-           aubioScale,
-           _cfg.onsetThreshold,
-           aubioThresh);
+  if (dsp->useFrontEnd) {
+    dsp->applyOnsetParams(params);
+    dsp->applyPitchParams(params);
+    return dsp;
+  }
+
+  const uint_t analysisRate = static_cast<uint_t>(std::lround(dsp->analysisSr));
+  dsp->aubioOnset = new_aubio_onset("specflux", static_cast<uint_t>(dsp->fftSize), static_cast<uint_t>(dsp->hopSamples), analysisRate);
+  dsp->aubioIn = new_fvec(static_cast<uint_t>(dsp->hopSamples));
+  dsp->aubioOnsetOut = new_fvec(1);
+  if (!dsp->useNativePitch && !dsp->useFretBank) {
+    const char* pitchAlgo = (_s <= 1) ? "yin" : "yinfast";
+    dsp->aubioPitch = new_aubio_pitch(pitchAlgo, static_cast<uint_t>(dsp->fftSize), static_cast<uint_t>(dsp->hopSamples), analysisRate);
+    dsp->aubioPitchOut = new_fvec(1);
+  }
+  const bool pitchReady = dsp->useFretBank ? dsp->fretBank.ready()
+      : (dsp->useNativePitch ? dsp->pitchEstimator.ready() : (dsp->aubioPitch && dsp->aubioPitchOut));
+
+  if (dsp->aubioOnset && pitchReady && dsp->aubioIn && dsp->aubioOnsetOut) {
+    if (dsp->aubioPitch)
+      aubio_pitch_set_unit(dsp->aubioPitch, "Hz");
+    dsp->ready = true;
+    SessionLogger::instance().logf("tracker",
+                                   "[s%d] aubio initialised hop=%d sr=%.1f aubioScale=%.2f base=%.3f onsetThresh=%.3f",
+                                   _s + 1,
+                                   dsp->hopSamples,
+                                   dsp->analysisSr,
+                                   aubioScale,
+                                   spec.onsetThreshold,
+                                   aubioThresh);
   } else {
-    std::fprintf(stderr, "StringTracker[%d]: Aubio init failed (onset=%p pitch=%p in=%p out=%p pitchOut=%p)\n",
-                 _s + 1, (void*)_aubioOnset, (void*)_aubioPitch, (void*)_aubioIn, (void*)_aubioOnsetOut, (void*)_aubioPitchOut);
+    SessionLogger::instance().logf("tracker",
+                                   "[s%d] aubio init failed onset=%p pitch=%p in=%p out=%p pitchOut=%p",
+                                   _s + 1, (void*)dsp->aubioOnset, (void*)dsp->aubioPitch, (void*)dsp->aubioIn,
+                                   (void*)dsp->aubioOnsetOut, (void*)dsp->aubioPitchOut);
   }
 #else
   if (!_warnedNoAubio) {
-    std::fprintf(stderr, "StringTracker[%d]: Aubio support not available; live detection disabled.\n", _s + 1);
+    SessionLogger::instance().logf("tracker", "[s%d] aubio support not available; using the spectral front end and native pitch",
+                                   _s + 1);
     _warnedNoAubio = true;
   }
 #endif
+  dsp->applyOnsetParams(params);
+  dsp->applyPitchParams(params);
+  return dsp;
+}
+
+void StringTracker::installDsp(std::unique_ptr<Dsp> next) {
+  // Built from an older snapshot when onset or pitch settings changed
+  // while it was on the rebuilder; those apply in place.
+  next->applyOnsetParams(_params);
+  next->applyPitchParams(_params);
+  std::unique_ptr<Dsp> old = std::move(_dsp);
+  // Same rate and hop: the pending samples and the block timeline carry on,
+  // and so do the filter and decimator histories where their settings match,
+  // so an edit that leaves the band alone causes no transient.
+  const bool sameStream = old && old->analysisSr == next->analysisSr && old->hopSamples == next->hopSamples
+      && old->decimator.factor() == next->decimator.factor();
+  if (sameStream) {
+    if (old->lowCut == next->lowCut && old->highCut == next->highCut)
+      next->filter = old->filter;
+    if (old->highCut == next->highCut && old->spec.sr == next->spec.sr)
+      std::swap(old->decimator, next->decimator);
+  } else {
+    if (next->pendingRaw.capacity() > _pendingRaw.capacity()) {
+      _pendingRaw.swap(next->pendingRaw);
+      _pendingFiltered.swap(next->pendingFiltered);
+    }
+    _pendingRaw.clear();
+    _pendingFiltered.clear();
+    _expectedBlockSec = -1.f;
+  }
+  if (next->feat.capacity() > _feat.capacity()) {
+    for (std::size_t i = 0; i < _feat.size(); ++i)
+      next->feat.push_back(_feat[i]);
+    std::swap(_feat, next->feat);
+  }
+  _sustainStableHops = 0;
+  _sustainPhase = 0;
+  _sustainAnchorHz = -1.f;
+  _sustainTrackHz = -1.f;
+  _dsp = std::move(next);
+  ++_dspBuilds;
+
+  if (old && _rebuilder) {
+    _retired.store(old.release(), std::memory_order_release);
+    _rebuilder->wake();
+  }
+}
+
+void StringTracker::reservePending(int blockSamples) {
+  // Only grows, so steady-state blocks never allocate; a longer JACK period
+  // costs one reserve here instead of a rebuild.
+  const int blockOutput = Decimator::maxOutput(blockSamples, _dsp->decimator.factor());
+  const std::size_t needed = pendingCapacity(_dsp->hopSamples, blockOutput);
+  if (_pendingRaw.capacity() < needed) {
+    _pendingRaw.reserve(needed);
+    _pendingFiltered.reserve(needed);
+  }
+  _feat.reserve(featureCapacity(_dsp->hopSamples, _dsp->hopSec, blockOutput));
 }
 
 void StringTracker::updateFeatures(const float* samples, int n, float sr, float t0) {
-  if (_hopSamples <= 0 || !_aubioReady) {
+  if (!_dsp || !_dsp->ready) {
     return;
   }
 
@@ -312,120 +588,243 @@ void StringTracker::updateFeatures(const float* samples, int n, float sr, float
     f.tSec = t0;
     _feat.push_back(f);
   } else {
-    const int hop = _hopSamples;
+    accumulateHops(samples, n, sr, t0);
+  }
 
-    if (n > 0) {
-      _filteredScratch.resize(static_cast<std::size_t>(n));
-      for (int i = 0; i < n; ++i) {
-        const float in = samples ? samples[i] * _calibrationGain : 0.f;
-        _filteredScratch[static_cast<std::size_t>(i)] = _filter.process(in);
-      }
-    }
+  while (!_feat.empty() && (_feat.back().tSec - _feat.front().tSec) > kFeatureHistorySec)
+    _feat.pop_front();
+}
 
-    int offset = 0;
-    while (offset < n) {
-      const int frameLen = std::min(hop, n - offset);
-      if (frameLen <= 0)
-        break;
-
-      FrameFeatures f{};
-      f.tSec = t0 + (static_cast<float>(offset) + 0.5f * frameLen) / sr;
-      const float* framePtr = (_filteredScratch.empty() || offset >= n)
-              ? nullptr
-              : _filteredScratch.data() + offset;
-      const float* rawPtr = (samples && offset < n)
-              ? samples + offset
-              : nullptr;
-      f.envelopeRms = rms(framePtr, frameLen);
-
-      float framePeak = 0.f;
-      float rawPeak = 0.f;
-      if (framePtr) {
-        for (int i = 0; i < frameLen; ++i)
-          framePeak = std::max(framePeak, std::fabs(framePtr[i]));
-      }
-      if (rawPtr) {
-        for (int i = 0; i < frameLen; ++i)
-          rawPeak = std::max(rawPeak, std::fabs(rawPtr[i] * _calibrationGain));
-      }
-      const bool useFilteredForPitch = (_s <= 1);
-      const float onsetGain = framePeak > 1e-5f ? std::min(1.0f, 0.35f / framePeak) : 1.f;
-      const float pitchPeak = useFilteredForPitch ? framePeak : rawPeak;
-      const float pitchGain = pitchPeak > 1e-5f ? std::min(1.0f, 0.45f / pitchPeak) : 1.f;
+void StringTracker::accumulateHops(const float* samples, int n, float sr, float t0) {
+  // Blocks that processBlock skipped (silence) leave a gap; drop the partial
+  // hop and restart the decimator so stale history is not stitched onto the
+  // new audio.
+  const bool contiguous = _expectedBlockSec >= 0.f && std::fabs(t0 - _expectedBlockSec) <= 0.5f / sr;
+  _expectedBlockSec = t0 + static_cast<float>(n) / sr;
+  if (!contiguous) {
+    _dsp->decimator.reset();
+    _pendingRaw.clear();
+    _pendingFiltered.clear();
+  }
+  if (!samples) {
+    _expectedBlockSec = -1.f;
+    return;
+  }
+
+  // Output j of this block was produced after input offset first + j * factor
+  // and describes the input groupDelay samples earlier. The pending start is
+  // re-derived from t0 every block so it never accumulates rounding.
+  const float sampleSec = 1.f / _dsp->analysisSr;
+  const float firstOutputSec = t0 + (static_cast<float>(_dsp->decimator.nextOutputOffset()) - _dsp->decimator.groupDelaySamples()) / sr;
+  const std::size_t pending = _pendingRaw.size();
+  _pendingStartSec = firstOutputSec - static_cast<float>(pending) * sampleSec;
+
+  _pendingRaw.resize(pending + static_cast<std::size_t>(Decimator::maxOutput(n, _dsp->decimator.factor())));
+  const int produced = _dsp->decimator.process(samples, n, _pendingRaw.data() + pending);
+  _pendingRaw.resize(pending + static_cast<std::size_t>(produced));
+  _pendingFiltered.resize(_pendingRaw.size());
+  for (std::size_t i = pending; i < _pendingRaw.size(); ++i)
+    _pendingFiltered[i] = _dsp->filter.process(_pendingRaw[i] * _calibrationGain);
+
+  const int hop = _dsp->hopSamples;
+  std::size_t consumed = 0;
+  while (_pendingRaw.size() - consumed >= static_cast<std::size_t>(hop)) {
+    const float frameStartSec = _pendingStartSec + static_cast<float>(consumed) * sampleSec;
+    analyzeFrame(_pendingRaw.data() + consumed,
+                 _pendingFiltered.data() + consumed,
+                 hop,
+                 frameStartSec + 0.5f * static_cast<float>(hop) * sampleSec);
+    consumed += static_cast<std::size_t>(hop);
+  }
+  if (consumed > 0) {
+    _pendingRaw.erase(_pendingRaw.begin(), _pendingRaw.begin() + static_cast<std::ptrdiff_t>(consumed));
+    _pendingFiltered.erase(_pendingFiltered.begin(), _pendingFiltered.begin() + static_cast<std::ptrdiff_t>(consumed));
+  }
+}
 
-      float onsetMarker = 0.f;
-      float detectedPitchHz = -1.f;
+void StringTracker::analyzeFrame(const float* rawPtr, const float* framePtr, int frameLen, float tSec) {
+  FrameFeatures f{};
+  f.tSec = tSec;
+  f.envelopeRms = rms(framePtr, frameLen);
+
+  float framePeak = 0.f;
+  float rawPeak = 0.f;
+  if (framePtr) {
+    for (int i = 0; i < frameLen; ++i)
+      framePeak = std::max(framePeak, std::fabs(framePtr[i]));
+  }
+  if (rawPtr) {
+    for (int i = 0; i < frameLen; ++i)
+      rawPeak = std::max(rawPeak, std::fabs(rawPtr[i] * _calibrationGain));
+  }
+  const bool useFilteredForPitch = (_s <= 1);
+  const float onsetGain = framePeak > 1e-5f ? std::min(1.0f, 0.35f / framePeak) : 1.f;
+  const float pitchPeak = useFilteredForPitch ? framePeak : rawPeak;
+  const float pitchGain = pitchPeak > 1e-5f ? std::min(1.0f, 0.45f / pitchPeak) : 1.f;
+
+  float onsetMarker = 0.f;
+  float detectedPitchHz = -1.f;
+  // The band-passed frame for the low strings, the calibrated raw frame
+  // otherwise; the front end and the native estimator both read it in place.
+  const float* pitchSource = frameLen >= _dsp->hopSamples ? (useFilteredForPitch ? framePtr : rawPtr) : nullptr;
+  const float pitchSourceGain = useFilteredForPitch ? 1.f : _calibrationGain;
+  // The filter, decimator and envelope above run on every hop; only the
+  // estimators pause while the string is quiet. Pitch keeps running under an
+  // open note so sustain and release still see it.
+  bool evaluatePitch = true;
+  bool evaluateOnset = true;
+  bool pitchGateReopened = false;
+  if (_cfg.energyGate) {
+    const bool pitchWasGated = _pitchQuietHops >= kGateHoldHops;
+    const float bound = onsetEnvelopeBound();
+    if (activeEvent() || f.envelopeRms >= bound * kPitchGateRatio)
+      _pitchQuietHops = 0;
+    else
+      _pitchQuietHops = std::min(_pitchQuietHops + 1, kGateHoldHops);
+    if (f.envelopeRms >= bound * kOnsetGateRatio)
+      _onsetQuietHops = 0;
+    else
+      _onsetQuietHops = std::min(_onsetQuietHops + 1, kGateHoldHops);
+    evaluatePitch = _pitchQuietHops < kGateHoldHops;
+    evaluateOnset = _onsetQuietHops < kGateHoldHops;
+    pitchGateReopened = pitchWasGated && evaluatePitch;
+  }
+  // Sustain duty cycle: while the open note's pitch holds, the full
+  // estimator runs every sustainPitchStride hops and the drift probe follows
+  // the note in between. A rising envelope, an onset on the previous hop, or
+  // a probe that loses the note or drifts past half the bend threshold from
+  // the last estimate goes back to estimating every hop.
+  bool probeOnly = false;
+  if (_dsp->useDriftProbe) {
+    _dsp->driftProbe.push(pitchSource, pitchSourceGain);
+    if (f.envelopeRms > _sustainPeakRms * kSustainRiseRatio || _prevOnsetMarker > 0.f)
+      _sustainStableHops = 0;
+    _sustainPeakRms = std::max(_sustainPeakRms * kSustainPeakRelease, f.envelopeRms);
+    if (evaluatePitch && _sustainStableHops >= kSustainSettleHops && _sustainAnchorHz > 0.f
+        && _sustainPhase + 1 < _cfg.sustainPitchStride) {
+      const float probeHz = _dsp->driftProbe.track(_sustainTrackHz);
+      if (probeHz > 0.f && std::fabs(centsBetween(probeHz, _sustainAnchorHz)) <= 0.5f * _cfg.bendDeltaCents) {
+        probeOnly = true;
+        detectedPitchHz = probeHz;
+        _sustainTrackHz = probeHz;
+        ++_sustainPhase;
+      } else {
+        _sustainStableHops = 0;
+      }
+    }
+  }
+  const bool estimatePitch = evaluatePitch && !probeOnly;
+
+  ++_gateStats.hops;
+  ++(!evaluatePitch ? _gateStats.pitchSkipped : probeOnly ? _gateStats.pitchProbed : _gateStats.pitchEvaluated);
+  ++(evaluateOnset ? _gateStats.onsetEvaluated : _gateStats.onsetSkipped);
+
+  SpectralFrame spectral;
+  const bool frontEndPitch = !_dsp->useNativePitch && !_dsp->useFretBank;
+  if (_dsp->useFrontEnd && (evaluateOnset || (frontEndPitch && estimatePitch))) {
+    const float gain = pitchSourceGain * (pitchPeak > 1e-5f ? std::min(1.0f, 0.35f / pitchPeak) : 1.f);
+    _dsp->frontEnd.setPitchEnabled(frontEndPitch && estimatePitch);
+    spectral = _dsp->frontEnd.process(pitchSource, gain);
+    onsetMarker = spectral.onset;
+    if (spectral.pitchHz >= kMinPitchHz && spectral.pitchHz <= kMaxPitchHz)
+      detectedPitchHz = spectral.pitchHz;
+  }
+  if (_dsp->useNativePitch && estimatePitch) {
+    const float pitchHz = _dsp->pitchEstimator.process(pitchSource, pitchSourceGain * pitchGain);
+    if (pitchHz >= kMinPitchHz && pitchHz <= kMaxPitchHz)
+      detectedPitchHz = pitchHz;
+  } else if (_dsp->useNativePitch) {
+    // Gated and probe-only hops still enter the window, so the next estimate
+    // does not join the audio before the gap onto the new note.
+    _dsp->pitchEstimator.append(pitchSource, pitchSourceGain * pitchGain);
+  }
+  if (_dsp->useFretBank && evaluatePitch) {
+    // Keeping the sliding sums through a gap would cost what the gate saves;
+    // restart them on the quiet history instead.
+    if (pitchGateReopened)
+      _dsp->fretBank.reset();
+    const FretEstimate fret = _dsp->fretBank.process(pitchSource, pitchSourceGain * pitchGain);
+    if (fret.hz >= kMinPitchHz && fret.hz <= kMaxPitchHz)
+      detectedPitchHz = fret.hz;
+  }
 #ifdef HAVE_AUBIO
-      if (_aubioIn) {
-        for (int i = 0; i < hop; ++i) {
-          float directSample = 0.f;
-          if (rawPtr && i < frameLen) {
-            directSample = rawPtr[i] * _calibrationGain;
-          } else if (framePtr && i < frameLen) {
-            directSample = framePtr[i];
-          }
-          _aubioIn->data[i] = directSample * onsetGain;
-        }
-        if (_aubioOnset && _aubioOnsetOut) {
-          aubio_onset_do(_aubioOnset, _aubioIn, _aubioOnsetOut);
-          onsetMarker = fvec_get_sample(_aubioOnsetOut, 0);
-        }
-        if (_aubioPitch && _aubioPitchOut) {
-          for (int i = 0; i < hop; ++i) {
-            float pitchSample = 0.f;
-            if (useFilteredForPitch && framePtr && i < frameLen)
-              pitchSample = framePtr[i];
-            else if (rawPtr && i < frameLen)
-              pitchSample = rawPtr[i] * _calibrationGain;
-            _aubioIn->data[i] = pitchSample * pitchGain;
-          }
-          aubio_pitch_do(_aubioPitch, _aubioIn, _aubioPitchOut);
-          const float pitchHz = fvec_get_sample(_aubioPitchOut, 0);
-          if (pitchHz > 0.f && pitchHz >= kMinPitchHz && pitchHz <= kMaxPitchHz)
-            detectedPitchHz = pitchHz;
-        }
+  if (_dsp->aubioIn && !_dsp->useFrontEnd && (evaluateOnset || estimatePitch)) {
+    for (int i = 0; i < _dsp->hopSamples; ++i) {
+      float directSample = 0.f;
+      if (rawPtr && i < frameLen) {
+        directSample = rawPtr[i] * _calibrationGain;
+      } else if (framePtr && i < frameLen) {
+        directSample = framePtr[i];
       }
+      _dsp->aubioIn->data[i] = directSample * onsetGain;
+    }
+    if (_dsp->aubioOnset && _dsp->aubioOnsetOut && evaluateOnset) {
+      aubio_onset_do(_dsp->aubioOnset, _dsp->aubioIn, _dsp->aubioOnsetOut);
+      onsetMarker = fvec_get_sample(_dsp->aubioOnsetOut, 0);
+    }
+    if (_dsp->aubioPitch && _dsp->aubioPitchOut && estimatePitch) {
+      for (int i = 0; i < _dsp->hopSamples; ++i) {
+        float pitchSample = 0.f;
+        if (useFilteredForPitch && framePtr && i < frameLen)
+          pitchSample = framePtr[i];
+        else if (rawPtr && i < frameLen)
+          pitchSample = rawPtr[i] * _calibrationGain;
+        _dsp->aubioIn->data[i] = pitchSample * pitchGain;
+      }
+      aubio_pitch_do(_dsp->aubioPitch, _dsp->aubioIn, _dsp->aubioPitchOut);
+      const float pitchHz = fvec_get_sample(_dsp->aubioPitchOut, 0);
+      if (pitchHz > 0.f && pitchHz >= kMinPitchHz && pitchHz <= kMaxPitchHz)
+        detectedPitchHz = pitchHz;
+    }
+  }
 #endif
 
-      if (detectedPitchHz > 0.f) {
-        const float smoothedPitch = applyPitchMedian(detectedPitchHz);
-        f.pitchHz = smoothedPitch;
-        const float refHz = midiToHz(_tuning.stringMidi[_s]);
-        f.pitchCents = centsBetween(f.pitchHz, refHz);
-      } else {
-        _pitchMedianWindow.clear();
-      }
+  _prevOnsetMarker = onsetMarker;
+  if (_dsp->useDriftProbe && !probeOnly) {
+    _sustainPhase = 0;
+    _sustainAnchorHz = detectedPitchHz;
+    _sustainTrackHz = detectedPitchHz;
+  }
 
-      if (f.pitchHz > 0.f)
-        _lastFeaturePitchHz = f.pitchHz;
-
-      f.onsetStrength = onsetMarker;
-
-      if (onsetMarker > 0.f && _s == kAubioDebugString) {
-        auto& logger = SessionLogger::instance();
-        if (logger.enabled()) {
-          logger.logf("tracker",
-                     "[s%d] aubio-raw t=%.4f onset=%.6f env=%.6f peak=%.6f gain=%.3f",
-                     _s + 1,
-                     f.tSec,
-                     onsetMarker,
-                     f.envelopeRms,
-                     framePeak,
-                     onsetGain);
-        }
-      }
+  if (detectedPitchHz > 0.f) {
+    const float smoothedPitch = applyPitchMedian(detectedPitchHz);
+    f.pitchHz = smoothedPitch;
+    const float refHz = midiToHz(_tuning.stringMidi[_s]);
+    f.pitchCents = centsBetween(f.pitchHz, refHz);
+  } else {
+    _pitchMedianWindow.clear();
+  }
 
-      if (f.envelopeRms <= 0.f && f.onsetStrength <= 0.f && detectedPitchHz <= 0.f) {
-        f.onsetStrength = 0.f;
-      }
+  if (f.pitchHz > 0.f)
+    _lastFeaturePitchHz = f.pitchHz;
 
-      _feat.push_back(f);
-      offset += hop;
+  f.onsetStrength = onsetMarker;
+
+  if (onsetMarker > 0.f && _s == kAubioDebugString && trace::enabled()) {
+    if (_dsp->useFrontEnd) {
+      trace::emit(trace::Event::SpectralRaw, _s, f.tSec,
+                  {onsetMarker, spectral.flux, spectral.hfc, spectral.pitchClarity, f.envelopeRms, framePeak});
+    } else {
+      trace::emit(trace::Event::AubioRaw, _s, f.tSec, {onsetMarker, f.envelopeRms, framePeak, onsetGain});
     }
   }
 
-  while (!_feat.empty() && (_feat.back().tSec - _feat.front().tSec) > 0.8f)
-    _feat.pop_front();
+  if (f.envelopeRms <= 0.f && f.onsetStrength <= 0.f && detectedPitchHz <= 0.f) {
+    f.onsetStrength = 0.f;
+  }
+
+  _feat.push_back(f);
+}
+
+// Lowest envelope detectOnset() could accept this hop: the larger of its gate
+// and envelope floor, leaving out the last-onset terms, which only raise them.
+float StringTracker::onsetEnvelopeBound() const {
+  float baseline = std::max(_params.baselineFloor, kSliderMixEpsilon);
+  baseline = sliderDominantMix(baseline, _envAdaptiveRms * 0.4f, 4.0f);
+  const float gateThreshold = baseline * _params.gateRatio;
+  float envFloor = std::max(_params.envelopeFloor, baseline * 0.7f);
+  envFloor = sliderDominantMix(envFloor, _envAdaptiveRms * 0.6f, 3.0f);
+  return std::max(gateThreshold, envFloor);
 }
 
 bool StringTracker::detectOnset(std::size_t frameIdx) {
@@ -436,11 +835,11 @@ bool StringTracker::detectOnset(std::size_t frameIdx) {
   const float onsetStrength = frame.onsetStrength;
   const float envelope = frame.envelopeRms;
 
-  const float sliderOnsetScale = stringOnsetThreshold(_s, 1.0f);
+  const float sliderOnsetScale = _params.onsetThreshold(1.0f);
   const float onsetThreshold = sliderOnsetScale * _cfg.onsetThreshold;
-  const float baseFloor = stringBaselineFloor(_s);
-  const float gateRatio = stringGateRatio(_s);
-  const float envelopeFloorParam = stringEnvelopeFloor(_s);
+  const float baseFloor = _params.baselineFloor;
+  const float gateRatio = _params.gateRatio;
+  const float envelopeFloorParam = _params.envelopeFloor;
   const float sliderBaseline = std::max(baseFloor, kSliderMixEpsilon);
   float baseline = sliderBaseline;
   const float floorCandidate = baseline;
@@ -451,109 +850,71 @@ bool StringTracker::detectOnset(std::size_t frameIdx) {
   float envFloor = std::max(envelopeFloorParam, baseline * 0.7f);
   envFloor = sliderDominantMix(envFloor, _envAdaptiveRms * 0.6f, 3.0f);
   envFloor = sliderDominantMix(envFloor, _lastOnsetPeakRms * 0.5f, 2.5f);
-  const float separationGuard = std::max(_currentHopSec, kMinOnsetSeparationSec);
+  const float separationGuard = std::max(_dsp->hopSec, kMinOnsetSeparationSec);
   const float timeSinceLastOnset = (_lastOnsetSec >= 0.f) ? frame.tSec - _lastOnsetSec : -1.f;
   const float guardRemaining = (_lastOnsetSec >= 0.f) ? std::max(0.f, separationGuard - timeSinceLastOnset) : 0.f;
   float activeAge = -1.f;
-  if (_activeIdx[_s] >= 0 && _activeIdx[_s] < static_cast<int>(_events.size()))
-    activeAge = frame.tSec - _events[_activeIdx[_s]].startSec;
+  if (const NoteEvent* active = activeEvent())
+    activeAge = frame.tSec - active->startSec;
   const float retriggerBlockRemaining = (_retriggerBlockUntilSec > frame.tSec)
       ? (_retriggerBlockUntilSec - frame.tSec)
       : 0.f;
-  const float sliderRetriggerScale = stringRetriggerGateScale(_s);
+  const float sliderRetriggerScale = _params.retriggerGateScale;
   const float onsetDelta = onsetStrength - onsetThreshold;
   const float envDelta = envelope - gateThreshold;
 
-  auto& sessionLogger = SessionLogger::instance();
-  const bool logString = sessionLogger.enabled() && (_s == kAubioDebugString);
+  const bool logString = trace::enabled() && (_s == kAubioDebugString);
   const bool shouldLog = logString && (onsetStrength > onsetThreshold * 0.35f || envelope > gateThreshold * 0.7f);
-  auto logDecision = [&](const char* tag) {
+  auto logDecision = [&](trace::Event event) {
     if (!shouldLog)
       return;
-    sessionLogger.logf("tracker",
-               "[s%d] onset-%s t=%.4f env=%.6f gate=%.6f envDelta=%.6f envFloor=%.6f onset=%.6f thresh=%.6f onsetDelta=%.6f baseline=%.6f floor=%.6f adapt=%.6f lastPeak=%.6f baseParam=%.6f gateRatio=%.4f envParam=%.6f onsetScale=%.3f retriggerScale=%.3f guard=%.3f guardRemain=%.3f activeAge=%.3f retrigRemain=%.3f pitchHz=%.2f pitchCents=%.1f",
-                       _s + 1,
-                       tag,
-                       frame.tSec,
-                       envelope,
-                       gateThreshold,
-                       envDelta,
-                       envFloor,
-                       onsetStrength,
-                       onsetThreshold,
-                       onsetDelta,
-                       baseline,
-                       floorCandidate,
-                       adaptiveMetric,
-                       _lastOnsetPeakRms,
-                       baseFloor,
-                       gateRatio,
-                       envelopeFloorParam,
-                       sliderOnsetScale,
-                       sliderRetriggerScale,
-                       separationGuard,
-                       guardRemaining,
-                       activeAge,
-                       retriggerBlockRemaining,
-                       frame.pitchHz,
-                       frame.pitchCents);
+    trace::emit(event, _s, frame.tSec,
+                {envelope, gateThreshold, envDelta, envFloor, onsetStrength, onsetThreshold, onsetDelta,
+                 baseline, floorCandidate, adaptiveMetric, _lastOnsetPeakRms, baseFloor, gateRatio,
+                 envelopeFloorParam, sliderOnsetScale, sliderRetriggerScale, separationGuard, guardRemaining,
+                 activeAge, retriggerBlockRemaining, frame.pitchHz, frame.pitchCents});
   };
   if (onsetStrength <= 0.f)
     return false;
 
   if (onsetStrength < onsetThreshold) {
-    logDecision("below-threshold");
+    logDecision(trace::Event::OnsetBelowThreshold);
     return false;
   }
 
   if (_onsetLatched) {
-    logDecision("latched");
+    logDecision(trace::Event::OnsetLatched);
     return false;
   }
 
   if (envelope < gateThreshold) {
-    logDecision("below-gate");
+    logDecision(trace::Event::OnsetBelowGate);
     return false;
   }
 
   if (envelope < envFloor) {
-    logDecision("below-env-floor");
+    logDecision(trace::Event::OnsetBelowEnvFloor);
     return false;
   }
 
   if (_lastOnsetSec >= 0.f && (frame.tSec - _lastOnsetSec) < separationGuard) {
-    logDecision("separation-guard");
+    logDecision(trace::Event::OnsetSeparationGuard);
     return false;
   }
 
-  if (_activeIdx[_s] >= 0 && _activeIdx[_s] < static_cast<int>(_events.size())) {
-    const auto& active = _events[_activeIdx[_s]];
-    if (frame.tSec - active.startSec < _cfg.minNoteDurSec * 0.6f) {
-      logDecision("active-guard");
+  if (const NoteEvent* active = activeEvent()) {
+    if (frame.tSec - active->startSec < _cfg.minNoteDurSec * 0.6f) {
+      logDecision(trace::Event::OnsetActiveGuard);
       return false;
     }
   }
 
   _onsetLatched = true;
-  logDecision("accepted");
-  SessionLogger::instance().logf("tracker",
-                                 "[s%d] onset t=%.3f env=%.5f gate=%.5f envDelta=%.5f envFloor=%.5f onset=%.3f thresh=%.3f onsetDelta=%.5f baseline=%.5f adaptive=%.5f lastPeak=%.5f guard=%.3f activeAge=%.3f pitch=%.2fHz pitchCents=%.1f",
-                                 _s + 1,
-                                 frame.tSec,
-                                 frame.envelopeRms,
-                                 gateThreshold,
-                                 envDelta,
-                                 envFloor,
-                                 frame.onsetStrength,
-                                 onsetThreshold,
-                                 onsetDelta,
-                                 baseline,
-                                 adaptiveMetric,
-                                 _lastOnsetPeakRms,
-                                 separationGuard,
-                                 activeAge,
-                                 frame.pitchHz,
-                                 frame.pitchCents);
+  logDecision(trace::Event::OnsetAccepted);
+  trace::emit(trace::Event::Onset, _s, frame.tSec,
+              {frame.envelopeRms, gateThreshold, envDelta, envFloor, frame.onsetStrength, onsetThreshold,
+               onsetDelta, baseline, adaptiveMetric, _lastOnsetPeakRms, separationGuard, activeAge,
+               frame.pitchHz, frame.pitchCents});
   return true;
 }
 
@@ -591,23 +952,17 @@ int StringTracker::applyLowStringBias(int midi, const FrameFeatures& frame) cons
   if (harmonicError > tolerance)
     return midi;
 
-  const float minEnv = std::max(stringEnvelopeFloor(_s) * 0.65f, _calibrationTargetRms * 0.55f);
-  const float minOnset = stringOnsetThreshold(_s, _cfg.onsetThreshold) * 1.6f;
+  const float minEnv = std::max(_params.envelopeFloor * 0.65f, _calibrationTargetRms * 0.55f);
+  const float minOnset = _params.onsetThreshold(_cfg.onsetThreshold) * 1.6f;
   if (frame.envelopeRms < minEnv || frame.onsetStrength < minOnset)
     return midi;
 
   const float fundamentalHz = frame.pitchHz / static_cast<float>(harmonic);
   const int candidateMidi = std::clamp(hzToMidi(fundamentalHz), openMidi, openMidi + 24);
   if (candidateMidi == openMidi && candidateMidi < midi) {
-    SessionLogger::instance().logf("tracker",
-                                   "[s%d] harmonic-bias t=%.3f pitch=%.2fHz ratio=%.2f harmonic=%d midi=%d->%d",
-                                   _s + 1,
-                                   frame.tSec,
-                                   frame.pitchHz,
-                                   ratio,
-                                   harmonic,
-                                   midi,
-                                   candidateMidi);
+    trace::emit(trace::Event::HarmonicBias, _s, frame.tSec,
+                {frame.pitchHz, ratio, static_cast<float>(harmonic), static_cast<float>(midi),
+                 static_cast<float>(candidateMidi)});
     return candidateMidi;
   }
 
@@ -615,13 +970,14 @@ int StringTracker::applyLowStringBias(int midi, const FrameFeatures& frame) cons
 }
 
 bool StringTracker::noteShouldClose(std::size_t frameIdx) const {
-  if (_activeIdx[_s] < 0 || _activeIdx[_s] >= static_cast<int>(_events.size()))
+  const NoteEvent* active = activeEvent();
+  if (!active)
     return false;
   if (frameIdx >= _feat.size())
     return false;
 
   const auto& frame = _feat[frameIdx];
-  const auto& ev = _events[_activeIdx[_s]];
+  const auto& ev = *active;
   const float age = frame.tSec - ev.startSec;
   if (age < _cfg.minNoteDurSec)
     return false;
@@ -644,9 +1000,9 @@ bool StringTracker::noteShouldClose(std::size_t frameIdx) const {
     return false;
   avgEnv /= static_cast<float>(count);
 
-  const float envelopeFloor = stringEnvelopeFloor(_s);
+  const float envelopeFloor = _params.envelopeFloor;
   const float sliderEnvFloor = std::max(envelopeFloor, kSliderMixEpsilon);
-  const float sustainScale = std::max(0.05f, stringSustainFloorScale(_s));
+  const float sustainScale = std::max(0.05f, _params.sustainFloorScale);
   const float sustainFloor = sliderEnvFloor * sustainScale;
 
   const bool quiet = avgEnv < sustainFloor;
@@ -657,19 +1013,14 @@ bool StringTracker::noteShouldClose(std::size_t frameIdx) const {
   }
 
   if (_releaseQuietFrames >= kReleaseQuietFrameCount) {
-    SessionLogger::instance().logf("tracker",
-                                   "[s%d] release-quiet t=%.3f avgEnv=%.5f floor=%.5f quietFrames=%d",
-                                   _s + 1,
-                                   frame.tSec,
-                                   avgEnv,
-                                   sustainFloor,
-                                   _releaseQuietFrames);
+    trace::emit(trace::Event::ReleaseQuiet, _s, frame.tSec,
+                {avgEnv, sustainFloor, static_cast<float>(_releaseQuietFrames)});
     return true;
   }
 
   const float cappedPeak = sliderDominantMix(sustainFloor, _lastOnsetPeakRms, 6.0f);
   float retriggerGate = std::max(sustainFloor, cappedPeak * 0.4f);
-  retriggerGate = std::max(sliderEnvFloor * 0.3f, retriggerGate * stringRetriggerGateScale(_s));
+  retriggerGate = std::max(sliderEnvFloor * 0.3f, retriggerGate * _params.retriggerGateScale);
   retriggerGate = std::min(retriggerGate, sustainFloor * 6.0f);
   bool allowRetriggerRelease = true;
   if (_s == 0 && _activeForcedOpen) {
@@ -683,13 +1034,7 @@ bool StringTracker::noteShouldClose(std::size_t frameIdx) const {
     }
   }
   if (allowRetriggerRelease && frame.onsetStrength > retriggerGate && age >= _cfg.minNoteDurSec * 0.75f) {
-    SessionLogger::instance().logf("tracker",
-                                   "[s%d] release-retrigger t=%.3f onset=%.3f gate=%.3f age=%.3f",
-                                   _s + 1,
-                                   frame.tSec,
-                                   frame.onsetStrength,
-                                   retriggerGate,
-                                   age);
+    trace::emit(trace::Event::ReleaseRetrigger, _s, frame.tSec, {frame.onsetStrength, retriggerGate, age});
     return true;
   }
 
@@ -700,17 +1045,17 @@ float StringTracker::applyPitchMedian(float pitchHz) {
   if (pitchHz <= 0.f)
     return pitchHz;
 
-  constexpr std::size_t kWindow = 5;
   _pitchMedianWindow.push_back(pitchHz);
-  if (_pitchMedianWindow.size() > kWindow)
+  if (_pitchMedianWindow.size() > kPitchMedianWindow)
     _pitchMedianWindow.pop_front();
 
   if (_pitchMedianWindow.size() < 3)
     return pitchHz;
 
-  std::array<float, kWindow> scratch{};
+  std::array<float, kPitchMedianWindow> scratch{};
   const std::size_t count = _pitchMedianWindow.size();
-  std::copy_n(_pitchMedianWindow.begin(), count, scratch.begin());
+  for (std::size_t i = 0; i < count; ++i)
+    scratch[i] = _pitchMedianWindow[i];
   const auto endIt = scratch.begin() + static_cast<std::ptrdiff_t>(count);
   std::sort(scratch.begin(), endIt);
   return scratch[count / 2];
@@ -808,26 +1153,56 @@ float StringTracker::lastPitchHz() const {
   return _lastFeaturePitchHz;
 }
 
-void StringTracker::processBlock(const float* samples, int n, float sr, float t0) {
+NoteEvent* StringTracker::activeEvent() {
+  if (_stagedActive >= 0)
+    return &_staged[static_cast<std::size_t>(_stagedActive)];
+  return _activeIdx[_s] >= 0 ? _events.find(_activeIdx[_s]) : nullptr;
+}
+
+const NoteEvent* StringTracker::activeEvent() const {
+  return const_cast<StringTracker*>(this)->activeEvent();
+}
+
+void StringTracker::clearActiveEvent() {
+  _activeIdx[_s] = -1;
+  _stagedActive = -1;
+}
+
+void StringTracker::prepare(float sr, int n) {
+  if (sr > 0.f)
+    configureProcessing(sr, n, true);
+}
+
+void StringTracker::prepareBlock(float sr, int n) {
+  if (sr > 0.f)
+    configureProcessing(sr, n, false);
+}
+
+void StringTracker::commitStagedEvents() {
+  if (_staged.empty())
+    return;
+  for (std::size_t i = 0; i < _staged.size(); ++i) {
+    const int handle = _events.append(_staged[i]);
+    if (static_cast<int>(i) == _stagedActive)
+      _activeIdx[_s] = handle;
+  }
+  _staged.clear();
+  _stagedActive = -1;
+}
+
+void StringTracker::processBlock(const float* samples, int n, float sr, float t0, float knownPeak) {
   if (sr <= 0.f)
     return;
 
-  configureProcessing(sr, n);
+  configureProcessing(sr, n, false);
 
-#ifndef HAVE_AUBIO
-  (void)samples;
-  (void)n;
-  (void)sr;
-  (void)t0;
-  return;
-#else
-  if (!_aubioReady)
+  if (!_dsp || !_dsp->ready)
     return;
 
   if (!samples || n <= 0)
     return;
 
-  const float channelPeak = [] (const float* data, int count) {
+  const float channelPeak = (knownPeak >= 0.f) ? knownPeak : [] (const float* data, int count) {
     float peak = 0.f;
     if (!data || count <= 0)
       return peak;
@@ -839,17 +1214,13 @@ void StringTracker::processBlock(const float* samples, int n, float sr, float t0
   if (channelPeak < 1e-6f)
     return;
 
-  const float prevTailSec = _feat.empty() ? std::numeric_limits<float>::lowest() : _feat.back().tSec;
-  const std::size_t prevFrames = _feat.size();
+  const std::uint64_t prevPushed = _feat.pushed();
   updateFeatures(samples, n, sr, t0);
   if (_feat.empty())
     return;
 
-  std::size_t startIdx = 0;
-  if (prevFrames > 0 && prevTailSec > std::numeric_limits<float>::lowest()) {
-    while (startIdx < _feat.size() && _feat[startIdx].tSec <= prevTailSec)
-      ++startIdx;
-  }
+  const std::size_t added = static_cast<std::size_t>(std::min<std::uint64_t>(_feat.pushed() - prevPushed, _feat.size()));
+  const std::size_t startIdx = _feat.size() - added;
 
   for (std::size_t idx = startIdx; idx < _feat.size(); ++idx) {
     auto& frame = _feat[idx];
@@ -862,31 +1233,30 @@ void StringTracker::processBlock(const float* samples, int n, float sr, float t0
 
     _lastOnsetPeakRms *= 0.995f;
 
-    const float latchRelease = stringOnsetThreshold(_s, _cfg.onsetThreshold) * 0.6f;
+    const float latchRelease = _params.onsetThreshold(_cfg.onsetThreshold) * 0.6f;
     if (frame.onsetStrength < latchRelease)
       _onsetLatched = false;
 
     const int midiCandidate = (frame.pitchHz > 0.f) ? estimateMidi(frame) : -1;
     const bool pitchStable = updatePitchConfidence(midiCandidate, frame.pitchHz);
     const int heldMidi = applyPitchHold(midiCandidate, pitchStable);
-
-    if (_activeIdx[_s] >= 0 && _activeIdx[_s] < static_cast<int>(_events.size())) {
-      auto& active = _events[_activeIdx[_s]];
-      active.endSec = frame.tSec;
-      active.velocity = std::max(active.velocity, energyToVelocity(frame.envelopeRms));
+    if (pitchStable && activeEvent())
+      _sustainStableHops = std::min(_sustainStableHops + 1, kSustainSettleHops);
+    else
+      _sustainStableHops = 0;
+
+    if (NoteEvent* active = activeEvent()) {
+      active->endSec = frame.tSec;
+      active->velocity = std::max(active->velocity, energyToVelocity(frame.envelopeRms));
     }
 
     if (detectOnset(idx)) {
-      if (_activeIdx[_s] >= 0 && _activeIdx[_s] < static_cast<int>(_events.size())) {
-        auto& active = _events[_activeIdx[_s]];
+      if (NoteEvent* activePtr = activeEvent()) {
+        auto& active = *activePtr;
         active.endSec = std::max(frame.tSec, active.startSec + _cfg.minNoteDurSec);
-        SessionLogger::instance().logf("tracker",
-                                       "[s%d] note-ended (new onset) t=%.3f fret=%d dur=%.3f",
-                                       _s + 1,
-                                       active.endSec,
-                                       active.fret,
-                                       active.endSec - active.startSec);
-        _activeIdx[_s] = -1;
+        trace::emit(trace::Event::NoteEndedByOnset, _s, active.endSec,
+                    {static_cast<float>(active.fret), active.endSec - active.startSec});
+        clearActiveEvent();
         _releaseQuietFrames = 0;
         _activeHoldUntilSec = 0.f;
         _retriggerBlockUntilSec = 0.f;
@@ -917,8 +1287,9 @@ void StringTracker::processBlock(const float* samples, int n, float sr, float t0
           ev.startSec = frame.tSec;
           ev.endSec = frame.tSec;
           ev.velocity = velocity;
-          _events.push_back(ev);
-          _activeIdx[_s] = static_cast<int>(_events.size() - 1);
+          _staged.push_back(ev);
+          _stagedActive = static_cast<int>(_staged.size() - 1);
+          _activeIdx[_s] = -1;
           _lastOnsetPeakRms = frame.envelopeRms;
           _lastOnsetSec = frame.tSec;
           _releaseQuietFrames = 0;
@@ -931,21 +1302,11 @@ void StringTracker::processBlock(const float* samples, int n, float sr, float t0
             if (forcedOpenBias) {
               _activeHoldUntilSec = frame.tSec + kOpenBiasMinHoldSec;
               _activeForcedOpen = true;
-              SessionLogger::instance().logf("tracker",
-                                             "[s%d] open-hold t=%.3f hold=%.3fs",
-                                             _s + 1,
-                                             frame.tSec,
-                                             kOpenBiasMinHoldSec);
+              trace::emit(trace::Event::OpenHold, _s, frame.tSec, {kOpenBiasMinHoldSec});
             }
           }
-          SessionLogger::instance().logf("tracker",
-                                         "[s%d] note-start t=%.3f fret=%d midi=%d vel=%.2f env=%.5f",
-                                         _s + 1,
-                                         ev.startSec,
-                                         ev.fret,
-                                         ev.midi,
-                                         ev.velocity,
-                                         frame.envelopeRms);
+          trace::emit(trace::Event::NoteStart, _s, ev.startSec,
+                      {static_cast<float>(ev.fret), static_cast<float>(ev.midi), ev.velocity, frame.envelopeRms});
         }
       } else {
         _onsetLatched = false;
@@ -954,37 +1315,43 @@ void StringTracker::processBlock(const float* samples, int n, float sr, float t0
     }
 
     if (noteShouldClose(idx)) {
-      if (_activeIdx[_s] >= 0 && _activeIdx[_s] < static_cast<int>(_events.size())) {
-        auto& active = _events[_activeIdx[_s]];
+      if (NoteEvent* activePtr = activeEvent()) {
+        auto& active = *activePtr;
         active.endSec = std::max(frame.tSec, active.startSec + _cfg.minNoteDurSec);
-        SessionLogger::instance().logf("tracker",
-                                       "[s%d] note-ended t=%.3f fret=%d dur=%.3f",
-                                       _s + 1,
-                                       active.endSec,
-                                       active.fret,
-                                       active.endSec - active.startSec);
+        trace::emit(trace::Event::NoteEnded, _s, active.endSec,
+                    {static_cast<float>(active.fret), active.endSec - active.startSec});
       }
-      _activeIdx[_s] = -1;
+      clearActiveEvent();
       _releaseQuietFrames = 0;
       _activeHoldUntilSec = 0.f;
       _retriggerBlockUntilSec = 0.f;
       _activeForcedOpen = false;
     }
   }
-#endif
 }
 
 void StringTracker::resetState() {
   _feat.clear();
+  _staged.clear();
+  _stagedActive = -1;
   _lastOnsetPeakRms = 0.f;
   _lastOnsetSec = -1.f;
-  _filter.reset();
-  _filteredScratch.clear();
-  _currentSr = 0.f;
-  _hopSamples = 0;
-  _fftSize = 0;
-  _currentHopSec = 0.f;
-  _aubioReady = false;
+  // The installed DSP state is cleared in place rather than rebuilt, so a
+  // reset from the audio thread never allocates.
+  if (_dsp)
+    _dsp->reset();
+  _pendingRaw.clear();
+  _pendingFiltered.clear();
+  _pendingStartSec = 0.f;
+  _expectedBlockSec = -1.f;
+  _sustainStableHops = 0;
+  _sustainPhase = 0;
+  _sustainAnchorHz = -1.f;
+  _sustainTrackHz = -1.f;
+  _sustainPeakRms = 0.f;
+  _prevOnsetMarker = 0.f;
+  _pitchQuietHops = 0;
+  _onsetQuietHops = 0;
   _onsetLatched = false;
   _pitchMedianWindow.clear();
   _pitchConfidenceFrames = 0;
@@ -1000,12 +1367,6 @@ void StringTracker::resetState() {
   _retriggerBlockUntilSec = 0.f;
   _activeForcedOpen = false;
   _lastFeaturePitchHz = -1.f;
-#ifdef HAVE_AUBIO
-  if (_aubioIn) {
-    for (uint_t i = 0; i < _aubioIn->length; ++i)
-      _aubioIn->data[i] = 0.f;
-  }
-#endif
 }
 
 void StringTracker::setCalibration(const CalibrationProfile& profile) {
@@ -1,9 +1,17 @@
 #pragma once
 #include "TabEngine.h"
+#include "Decimator.h"
+#include "DriftProbe.h"
+#include "FretBank.h"
+#include "PitchEstimator.h"
+#include "RingBuffer.h"
+#include "SpectralFrontEnd.h"
+#include "StringTrackerParams.h"
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
-#include <deque>
+#include <memory>
 #include <vector>
 
 #ifdef HAVE_AUBIO
@@ -12,27 +20,61 @@ extern "C" {
 }
 #endif
 
+class TrackerRebuilder;
+
 class StringTracker {
 public:
   // events/out indices are shared with TabEngine so we can open/close notes centrally
   StringTracker(int stringIdx,
                 const Tuning& tuning,
                 const TrackerConfig& cfg,
-                std::vector<NoteEvent>& sharedEvents,
+                NoteEventStore& sharedEvents,
                 std::vector<int>& activeIdx);
   ~StringTracker();
 
-  // mono samples may be nullptr => treat as silence
-  void processBlock(const float* samples, int n, float sr, float blockStartSec);
+  // mono samples may be nullptr => treat as silence; knownPeak >= 0 skips the
+  // peak scan when the caller already has it (see processHexBlock).
+  void processBlock(const float* samples, int n, float sr, float blockStartSec, float knownPeak = -1.f);
+  // Reconfigures DSP state for (sr, n) if needed; TabEngine calls this serially
+  // before running trackers in parallel. Blocks of any size are accumulated
+  // into TrackerConfig::analysisHopSamples hops, so n only sizes buffers.
+  // With a rebuilder, every configuration (the first one included, unless
+  // prepare() built it) is built on its thread while the current state keeps
+  // running, and swapped in at a block boundary.
+  void prepareBlock(float sr, int n);
+  // Builds the first configuration for (sr, n) on the calling thread, before
+  // audio starts, so the audio thread never builds or logs. Allocates.
+  void prepare(float sr, int n);
+  // Set before the first block; nullptr builds everything inline.
+  void setRebuilder(TrackerRebuilder* rebuilder) { _rebuilder = rebuilder; }
+  // Rebuilder thread only: deletes retired state and builds a requested one.
+  void serviceRebuild();
+  // New events are staged per tracker during processBlock and appended to the
+  // shared event list here, in string order, by TabEngine.
+  void commitStagedEvents();
   void resetState();
   void setCalibration(const CalibrationProfile& profile);
   float lastPitchHz() const;
   float calibrationGain() const { return _calibrationGain; }
+  float analysisRate() const { return _dsp ? _dsp->analysisSr : 0.f; }
+  const TrackerGateStats& gateStats() const { return _gateStats; }
+  // Analysis states installed so far, the first included.
+  std::uint64_t dspBuilds() const { return _dspBuilds; }
   // void setCalibrationGain(float gain);  // Legacy - unused
 
 private:
-  void configureProcessing(float sr, int blockSamples);
+  void configureProcessing(float sr, int blockSamples, bool buildInline);
+  bool fretBankSelected() const { return ((_cfg.fretBankStrings >> _s) & 1u) != 0; }
   void updateFeatures(const float* samples, int n, float sr, float t0);
+  void accumulateHops(const float* samples, int n, float sr, float t0);
+  void reservePending(int blockSamples);
+  struct Dsp;
+  struct DspSpec;
+  std::unique_ptr<Dsp> buildDsp(const DspSpec& spec);
+  void installDsp(std::unique_ptr<Dsp> next);
+  void applyParamChanges(const trackerparams::TrackerParamSnapshot& previous);
+  void analyzeFrame(const float* rawPtr, const float* framePtr, int frameLen, float tSec);
+  float onsetEnvelopeBound() const;
   bool detectOnset(std::size_t frameIdx);
   int  estimateMidi(const FrameFeatures& frame) const;
   int  applyLowStringBias(int midi, const FrameFeatures& frame) const;
@@ -41,6 +83,9 @@ private:
   bool updatePitchConfidence(int midi, float pitchHz);
   int  applyPitchHold(int midi, bool stable);
   void refreshCalibrationTarget();
+  NoteEvent* activeEvent();
+  const NoteEvent* activeEvent() const;
+  void clearActiveEvent();
 
   struct BandpassFilter {
     float hpAlpha = 0.f;
@@ -49,27 +94,105 @@ private:
     float hpPrevInput = 0.f;
     float lpState = 0.f;
     void reset();
-    void configure(float sr, float lowCutHz, float highCutHz, int stringIdx);
+    // Coefficients only: the state carries on, so the band can move in place.
+    void configure(float sr, float lowCutHz, float highCutHz);
     float process(float x);
   };
 
+  // What a Dsp was built from; blockSamples only sizes its spare buffers.
+  struct DspSpec {
+    float sr = 0.f;
+    int   blockSamples = 0;
+    int   configuredHop = 0;         // TrackerConfig::analysisHopSamples
+    bool  multirate = false;
+    bool  spectralFrontEnd = false;
+    bool  nativePitch = false;
+    bool  fretBank = false;
+    bool  sustainProbe = false;      // TrackerConfig::sustainPitchStride > 1
+    float onsetThreshold = 0.f;
+    trackerparams::TrackerParamSnapshot params;
+    bool matches(const DspSpec& other) const;
+  };
+
+  // Everything configuring the analysis allocates, built in one piece by
+  // buildDsp() and installed by swapping _dsp.
+  struct Dsp {
+    ~Dsp();
+    void reset();
+    // Allocation-free, so an edit to these stages applies at the next block.
+    void applyOnsetParams(const trackerparams::TrackerParamSnapshot& params);
+    void applyPitchParams(const trackerparams::TrackerParamSnapshot& params);
+
+    DspSpec spec;
+    float analysisSr = 0.f;          // rate onset/pitch run at (spec.sr / decimation factor)
+    int   hopSamples = 0;            // analysis hop, in samples at analysisSr
+    int   fftSize = 0;
+    float hopSec = 0.f;
+    float lowCut = 0.f;
+    float highCut = 0.f;
+    bool  ready = false;
+    bool  useFrontEnd = false;       // SpectralFrontEnd instead of aubio onset + pitch
+    bool  useNativePitch = false;
+    bool  useFretBank = false;       // this string's bit in TrackerConfig::fretBankStrings
+    bool  useDriftProbe = false;     // TrackerConfig::sustainPitchStride > 1 on an estimator that can pause
+    Decimator decimator;
+    BandpassFilter filter;
+    SpectralFrontEnd frontEnd;
+    PitchEstimator pitchEstimator;
+    FretBank fretBank;
+    DriftProbe driftProbe;
+    // Reserved for the new hop, adopted by installDsp() when larger than the
+    // tracker's own; the tracker's old storage leaves with the retired Dsp.
+    std::vector<float> pendingRaw;
+    std::vector<float> pendingFiltered;
+    FixedRing<FrameFeatures> feat;
+#ifdef HAVE_AUBIO
+    aubio_onset_t* aubioOnset = nullptr;
+    aubio_pitch_t* aubioPitch = nullptr;
+    fvec_t*        aubioIn = nullptr;
+    fvec_t*        aubioOnsetOut = nullptr;
+    fvec_t*        aubioPitchOut = nullptr;
+#endif
+  };
+
+  // Handover with the rebuilder thread: the audio thread writes _request and
+  // moves Idle -> Requested; the rebuilder builds _built and moves Requested
+  // -> Ready; the audio thread installs it and moves Ready -> Idle. The state
+  // it replaces goes to _retired for the rebuilder to delete.
+  enum RebuildState : int { kRebuildIdle, kRebuildRequested, kRebuildReady };
+
   int _s = 0;
   const Tuning& _tuning;
   const TrackerConfig& _cfg;
-  std::deque<FrameFeatures> _feat; // rolling ~500ms
-  std::vector<NoteEvent>& _events;
-  std::vector<int>& _activeIdx;    // per-string active idx reference
+  FixedRing<FrameFeatures> _feat;  // rolling ~800ms, sized by reservePending()
+  NoteEventStore& _events;
+  std::vector<int>& _activeIdx;    // per-string active event handle reference
+  std::vector<NoteEvent> _staged;  // events opened this block, merged by commitStagedEvents()
+  int _stagedActive = -1;          // index into _staged while the active note is still staged
 
   float _lastOnsetPeakRms = 0.f;
   float _lastOnsetSec = -1.f;
-  float _currentSr = 0.f;
-  int   _hopSamples = 0;
-  int   _fftSize = 0;
-  float _currentHopSec = 0.f;
-  std::uint64_t _paramGeneration = 0;
-  BandpassFilter _filter;
-  std::vector<float> _filteredScratch;
-  bool _aubioReady = false;
+  trackerparams::TrackerParamSnapshot _params;   // refreshed by configureProcessing()
+  std::unique_ptr<Dsp> _dsp;              // audio thread only
+  TrackerRebuilder* _rebuilder = nullptr;
+  std::atomic<int> _rebuildState {kRebuildIdle};
+  DspSpec _request;                      // owned by the rebuilder while Requested
+  Dsp* _built = nullptr;                 // owned by the rebuilder until Ready, then by the audio thread
+  std::atomic<Dsp*> _retired {nullptr};
+  std::uint64_t _dspBuilds = 0;
+  int   _sustainStableHops = 0;          // hops the open note's pitch has held, counted by processBlock()
+  int   _sustainPhase = 0;               // probe-only hops since the last full estimate
+  float _sustainAnchorHz = -1.f;         // raw pitch at the last full estimate
+  float _sustainTrackHz = -1.f;          // raw pitch at the last estimate or probe
+  float _sustainPeakRms = 0.f;           // envelope peak hold for the duty cycle's rise test
+  float _prevOnsetMarker = 0.f;
+  int   _pitchQuietHops = 0;             // consecutive hops below the energy gate's pitch level
+  int   _onsetQuietHops = 0;
+  TrackerGateStats _gateStats;
+  std::vector<float> _pendingRaw;        // analysis-rate samples not yet consumed by a full hop
+  std::vector<float> _pendingFiltered;
+  float _pendingStartSec = 0.f;          // time of _pendingRaw[0]
+  float _expectedBlockSec = -1.f;        // t0 of the next contiguous block
   bool _onsetLatched = false;
   float _pitchConfidenceHz = -1.f;
   int   _pitchConfidenceMidi = -1;
@@ -91,13 +214,5 @@ private:
 #ifndef HAVE_AUBIO
   bool _warnedNoAubio = false;
 #endif
-  std::deque<float> _pitchMedianWindow;
-
-#ifdef HAVE_AUBIO
-  aubio_onset_t* _aubioOnset = nullptr;
-  aubio_pitch_t* _aubioPitch = nullptr;
-  fvec_t*        _aubioIn = nullptr;
-  fvec_t*        _aubioOnsetOut = nullptr;
-  fvec_t*        _aubioPitchOut = nullptr;
-#endif
+  FixedRing<float> _pitchMedianWindow;
 };
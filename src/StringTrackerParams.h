@@ -9,10 +9,44 @@ namespace trackerparams {
 
 constexpr std::array<int, 6>   kFftMultipliers{{8, 7, 6, 5, 4, 4}};
 
+// Every per-string value StringTracker reads, copied from one generation of
+// the store. A tracker pulls a new one at most once per block, so the hot
+// loop reads plain floats and a slider drag cannot land half way through.
+struct TrackerParamSnapshot {
+    std::uint64_t generation = 0;
+    // This string's counters (see NoteStageGenerations); comparing them with
+    // an older snapshot's says which stages an edit touched.
+    std::uint64_t stringGeneration = 0;
+    std::array<std::uint64_t, kNumNoteStages> stageGeneration {};
+    float lowCutMultiplier = 0.f;
+    float highCutMultiplier = 0.f;
+    float onsetThresholdScale = 1.f;
+    float baselineFloor = 0.f;
+    float gateRatio = 0.f;
+    float envelopeFloor = 0.f;
+    float peakReleaseRatio = 0.f;
+    float sustainFloorScale = 1.f;
+    float retriggerGateScale = 1.f;
+    float pitchTolerance = 0.f;
+    float aubioThresholdScale = 1.f;
+    float onsetSilenceDb = 0.f;
+    float pitchSilenceDb = 0.f;
+
+    float onsetThreshold(float base) const { return base * onsetThresholdScale; }
+    bool changedSince(const TrackerParamSnapshot& prev, NoteStage stage) const {
+        const std::size_t k = static_cast<std::size_t>(stage);
+        return stageGeneration[k] != prev.stageGeneration[k];
+    }
+};
+
 inline std::uint64_t settingsGeneration() {
     return NoteDetectionStore::instance().activeGeneration();
 }
 
+inline std::uint64_t stringGeneration(int s) {
+    return NoteDetectionStore::instance().stringGeneration(s);
+}
+
 inline float active(NoteParameter param, int s, float fallback) {
     if (s < 0 || s >= kNumStrings)
         return fallback;
@@ -91,4 +125,35 @@ inline float pitchSilenceDb(int s) {
     return active(NoteParameter::PitchSilenceDb, s, fallback);
 }
 
+// Fills out for string s from the store's active set. Returns false, leaving
+// out as it was, when an edit was being published; the caller keeps its
+// previous snapshot and tries again next block.
+inline bool pullSnapshot(int s, TrackerParamSnapshot& out) {
+    if (s < 0 || s >= kNumStrings)
+        return false;
+    NoteDetectionParameterSet set;
+    std::uint64_t generation = 0;
+    NoteStageGenerations stages;
+    if (!NoteDetectionStore::instance().readActive(set, generation, &stages))
+        return false;
+    const std::size_t i = static_cast<std::size_t>(s);
+    out.generation = generation;
+    out.stringGeneration = stages.any[i];
+    out.stageGeneration = stages.stage[i];
+    out.lowCutMultiplier = set.lowCutMultiplier[i];
+    out.highCutMultiplier = set.highCutMultiplier[i];
+    out.onsetThresholdScale = set.onsetThresholdScale[i];
+    out.baselineFloor = set.baselineFloor[i];
+    out.gateRatio = set.gateRatio[i];
+    out.envelopeFloor = set.envelopeFloor[i];
+    out.peakReleaseRatio = set.peakReleaseRatio[i];
+    out.sustainFloorScale = set.sustainFloorScale[i];
+    out.retriggerGateScale = set.retriggerGateScale[i];
+    out.pitchTolerance = set.pitchTolerance[i];
+    out.aubioThresholdScale = set.aubioThresholdScale[i];
+    out.onsetSilenceDb = set.onsetSilenceDb[i];
+    out.pitchSilenceDb = set.pitchSilenceDb[i];
+    return true;
+}
+
 } // namespace trackerparams
@@ -0,0 +1,341 @@
+#include "SyntheticHexSource.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "util.h"
+
+namespace {
+constexpr float kReleaseSec = 0.008f;       // damping time constant once a note is cut
+constexpr float kTailSec = 0.25f;           // silence rendered after the last note
+constexpr float kSlideGlideSec = 0.06f;
+constexpr float kBendGlideSec = 0.12f;
+constexpr float kRingT60LowSec = 3.0f;      // string 0; higher strings ring shorter
+constexpr float kRingT60StepSec = 0.3f;
+constexpr float kMutedT60Sec = 0.25f;
+constexpr float kHammerExcitation = 0.35f;  // re-pluck strength relative to the attack
+constexpr float kPullExcitation = 0.5f;
+constexpr float kMinNoteGapSec = 0.15f;     // keeps generated notes out of fuseEvents' legato window
+
+// Pitch offset in semitones from the note's fret at time t (seconds from onset).
+float pitchOffset(const SyntheticNote& note, float t) {
+  const float tr = note.transitionSec;
+  switch (note.articulation) {
+  case SyntheticArticulation::Hammer:
+  case SyntheticArticulation::Pull:
+    return t < tr ? 0.f : static_cast<float>(note.targetFret - note.fret);
+  case SyntheticArticulation::Slide: {
+    const float x = std::clamp((t - tr) / kSlideGlideSec, 0.f, 1.f);
+    return x * static_cast<float>(note.targetFret - note.fret);
+  }
+  case SyntheticArticulation::Bend:
+    return std::clamp((t - tr) / kBendGlideSec, 0.f, 1.f) * note.bendSemitones;
+  default:
+    return 0.f;
+  }
+}
+
+// Adds a lowpassed, zero-mean noise burst of `len` samples ending just
+// behind the write position; brighter for harder plucks.
+void excite(std::vector<float>& line, std::size_t mask, std::size_t writePos, int len, float amplitude,
+            float brightness, std::mt19937& rng) {
+  std::uniform_real_distribution<float> uni(-1.f, 1.f);
+  std::vector<float> burst(static_cast<std::size_t>(len));
+  float lp = 0.f;
+  float mean = 0.f;
+  for (float& v : burst) {
+    lp += brightness * (uni(rng) - lp);
+    v = lp;
+    mean += lp;
+  }
+  mean /= static_cast<float>(len);
+  float peak = 1.0e-6f;
+  for (float& v : burst) {
+    v -= mean;
+    peak = std::max(peak, std::fabs(v));
+  }
+  for (int i = 0; i < len; ++i) {
+    const std::size_t pos = (writePos - static_cast<std::size_t>(len) + static_cast<std::size_t>(i)) & mask;
+    line[pos] += amplitude * burst[static_cast<std::size_t>(i)] / peak;
+  }
+}
+} // namespace
+
+SyntheticHexSource::SyntheticHexSource(const Tuning& tuning, const SyntheticHexConfig& cfg)
+  : _tuning(tuning), _cfg(cfg) {}
+
+float SyntheticHexSource::durationSec() const {
+  float end = 0.f;
+  for (const auto& note : _notes)
+    end = std::max(end, note.startSec + note.durationSec);
+  return end + kTailSec;
+}
+
+std::size_t SyntheticHexSource::frames() const {
+  return static_cast<std::size_t>(std::ceil(durationSec() * _cfg.sampleRate));
+}
+
+void SyntheticHexSource::generatePhrase(float seconds, float notesPerSec, float articulationRate) {
+  std::mt19937 rng(_cfg.seed);
+  std::uniform_real_distribution<float> uni(0.f, 1.f);
+  std::exponential_distribution<float> interOnset(std::max(notesPerSec, 0.01f));
+  std::array<float, 6> nextFree {};
+
+  float t = 0.1f;
+  while (true) {
+    t += interOnset(rng);
+    if (t >= seconds)
+      break;
+    int candidates[6];
+    int count = 0;
+    for (int s = 0; s < 6; ++s) {
+      if (nextFree[static_cast<std::size_t>(s)] <= t)
+        candidates[count++] = s;
+    }
+    if (count == 0)
+      continue;
+
+    SyntheticNote note;
+    note.stringIdx = candidates[static_cast<int>(uni(rng) * static_cast<float>(count)) % count];
+    note.startSec = t;
+    note.durationSec = std::min(0.25f + 0.55f * uni(rng), seconds - t);
+    note.fret = static_cast<int>(uni(rng) * 13.f) % 13;
+    note.velocity = 0.45f + 0.55f * uni(rng);
+    if (uni(rng) < articulationRate) {
+      note.articulation = static_cast<SyntheticArticulation>(1 + static_cast<int>(uni(rng) * 5.f) % 5);
+      note.transitionSec = note.durationSec * (0.35f + 0.25f * uni(rng));
+      const int step = 1 + static_cast<int>(uni(rng) * 2.f) % 2;
+      switch (note.articulation) {
+      case SyntheticArticulation::Hammer:
+        note.targetFret = note.fret + step;
+        break;
+      case SyntheticArticulation::Pull:
+        note.fret = std::max(note.fret, step);
+        note.targetFret = note.fret - step;
+        break;
+      case SyntheticArticulation::Slide: {
+        const int delta = 3 + static_cast<int>(uni(rng) * 3.f) % 3;
+        note.targetFret = note.fret + delta <= 15 ? note.fret + delta : note.fret - delta;
+        if (note.targetFret < 0)
+          note.targetFret = note.fret + delta;
+        break;
+      }
+      case SyntheticArticulation::Bend:
+        note.bendSemitones = static_cast<float>(step);
+        break;
+      case SyntheticArticulation::PalmMute:
+        note.durationSec = std::min(0.12f + 0.05f * uni(rng), seconds - t);
+        note.velocity = 0.2f + 0.08f * uni(rng);
+        break;
+      default:
+        break;
+      }
+    }
+    nextFree[static_cast<std::size_t>(note.stringIdx)] = t + note.durationSec + kMinNoteGapSec;
+    _notes.push_back(note);
+  }
+}
+
+void SyntheticHexSource::renderNote(const SyntheticNote& note, float cutSec, unsigned seed,
+                                    std::vector<float>& out) const {
+  const float sr = _cfg.sampleRate;
+  const int openMidi = _tuning.stringMidi[static_cast<std::size_t>(note.stringIdx)];
+  const float baseHz = midiToHz(openMidi + note.fret);
+  float lowestOffset = 0.f;
+  if (note.articulation == SyntheticArticulation::Pull || note.articulation == SyntheticArticulation::Slide)
+    lowestOffset = std::min(0.f, static_cast<float>(note.targetFret - note.fret));
+  const float maxDelay = sr / (baseHz * std::exp2(lowestOffset / 12.f));
+
+  std::size_t size = 16;
+  while (static_cast<float>(size) < maxDelay + 4.f)
+    size <<= 1;
+  const std::size_t mask = size - 1;
+  std::vector<float> line(size, 0.f);
+  std::mt19937 rng(seed);
+
+  const bool muted = note.articulation == SyntheticArticulation::PalmMute;
+  const float t60 = muted ? kMutedT60Sec
+                          : std::max(0.5f, kRingT60LowSec - kRingT60StepSec * static_cast<float>(note.stringIdx));
+  const float brightness = muted ? 0.15f : 0.3f + 0.6f * note.velocity;
+
+  std::size_t writePos = size;  // offset so the first excitation never wraps below zero
+  const int period = std::max(2, static_cast<int>(sr / baseHz));
+  excite(line, mask, writePos, period, note.velocity, brightness, rng);
+
+  const std::size_t first = static_cast<std::size_t>(std::max(0.f, note.startSec * sr));
+  const std::size_t cut = static_cast<std::size_t>(cutSec * sr);
+  const std::size_t last = std::min(out.size(), cut + static_cast<std::size_t>(6.f * kReleaseSec * sr));
+  const std::size_t transition = first + static_cast<std::size_t>(note.transitionSec * sr);
+  const bool reexcite = note.articulation == SyntheticArticulation::Hammer || note.articulation == SyntheticArticulation::Pull;
+  const float releaseCoef = std::exp(-1.f / (kReleaseSec * sr));
+
+  float prev = 0.f;
+  float envelope = 1.f;
+  for (std::size_t i = first; i < last; ++i, ++writePos) {
+    const float t = static_cast<float>(i - first) / sr;
+    const float hz = baseHz * std::exp2(pitchOffset(note, t) / 12.f);
+    if (reexcite && i == transition) {
+      const float strength = note.articulation == SyntheticArticulation::Hammer ? kHammerExcitation : kPullExcitation;
+      excite(line, mask, writePos, std::max(2, static_cast<int>(sr / hz)), strength * note.velocity, brightness, rng);
+    }
+    // The two-point loss filter adds half a sample of delay.
+    const float delay = std::clamp(sr / hz - 0.5f, 1.f, static_cast<float>(size - 2));
+    // Index relative to the wrapped write position keeps the float small.
+    const float readPos = static_cast<float>((writePos & mask) + size) - delay;
+    const float floorPos = std::floor(readPos);
+    const float frac = readPos - floorPos;
+    const std::size_t idx = static_cast<std::size_t>(floorPos);
+    const float y = line[idx & mask] * (1.f - frac) + line[(idx + 1) & mask] * frac;
+    const float loopGain = std::pow(10.f, -3.f / (t60 * hz));
+    line[writePos & mask] = loopGain * 0.5f * (y + prev);
+    prev = y;
+    if (i >= cut)
+      envelope *= releaseCoef;
+    out[i] += y * envelope;
+  }
+}
+
+void SyntheticHexSource::render(std::array<std::vector<float>, 6>& out) const {
+  const std::size_t total = frames();
+  std::array<std::vector<float>, 6> dry;
+  for (auto& ch : dry)
+    ch.assign(total, 0.f);
+
+  std::vector<std::size_t> order(_notes.size());
+  for (std::size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+    return _notes[a].startSec < _notes[b].startSec;
+  });
+
+  for (std::size_t k = 0; k < order.size(); ++k) {
+    const SyntheticNote& note = _notes[order[k]];
+    if (note.stringIdx < 0 || note.stringIdx >= 6)
+      continue;
+    float cutSec = note.startSec + note.durationSec;
+    for (std::size_t j = k + 1; j < order.size(); ++j) {
+      if (_notes[order[j]].stringIdx == note.stringIdx) {
+        cutSec = std::min(cutSec, _notes[order[j]].startSec);
+        break;
+      }
+    }
+    renderNote(note, cutSec, _cfg.seed * 7919u + static_cast<unsigned>(order[k]), dry[static_cast<std::size_t>(note.stringIdx)]);
+  }
+
+  for (int s = 0; s < 6; ++s) {
+    auto& ch = out[static_cast<std::size_t>(s)];
+    ch = dry[static_cast<std::size_t>(s)];
+    if (_cfg.crosstalk > 0.f) {
+      for (const int n : {s - 1, s + 1}) {
+        if (n < 0 || n >= 6)
+          continue;
+        const auto& src = dry[static_cast<std::size_t>(n)];
+        for (std::size_t i = 0; i < total; ++i)
+          ch[i] += _cfg.crosstalk * src[i];
+      }
+    }
+    if (_cfg.noiseFloor > 0.f) {
+      std::mt19937 rng(_cfg.seed ^ (0x9e3779b9u + static_cast<unsigned>(s)));
+      std::normal_distribution<float> noise(0.f, _cfg.noiseFloor);
+      for (float& v : ch)
+        v += noise(rng);
+    }
+  }
+}
+
+std::vector<NoteEvent> SyntheticHexSource::groundTruth() const {
+  std::vector<NoteEvent> events;
+  events.reserve(_notes.size() * 2);
+
+  // Notes on the same string are cut by the next onset, as in render().
+  std::vector<const SyntheticNote*> sorted;
+  for (const auto& note : _notes)
+    sorted.push_back(&note);
+  std::sort(sorted.begin(), sorted.end(), [](const SyntheticNote* a, const SyntheticNote* b) {
+    return a->startSec < b->startSec;
+  });
+
+  for (std::size_t k = 0; k < sorted.size(); ++k) {
+    const SyntheticNote& note = *sorted[k];
+    if (note.stringIdx < 0 || note.stringIdx >= 6)
+      continue;
+    float endSec = note.startSec + note.durationSec;
+    for (std::size_t j = k + 1; j < sorted.size(); ++j) {
+      if (sorted[j]->stringIdx == note.stringIdx) {
+        endSec = std::min(endSec, sorted[j]->startSec);
+        break;
+      }
+    }
+
+    NoteEvent ev;
+    ev.stringIdx = note.stringIdx;
+    ev.fret = note.fret;
+    ev.midi = _tuning.stringMidi[static_cast<std::size_t>(note.stringIdx)] + note.fret;
+    ev.startSec = note.startSec;
+    ev.endSec = endSec;
+    ev.velocity = note.velocity;
+
+    const bool splits = note.articulation == SyntheticArticulation::Hammer
+        || note.articulation == SyntheticArticulation::Pull
+        || note.articulation == SyntheticArticulation::Slide;
+    const float transitionSec = note.startSec + note.transitionSec;
+    if (splits && transitionSec < endSec) {
+      NoteEvent second = ev;
+      ev.endSec = transitionSec;
+      second.fret = note.targetFret;
+      second.midi = _tuning.stringMidi[static_cast<std::size_t>(note.stringIdx)] + note.targetFret;
+      second.startSec = transitionSec;
+      if (note.articulation == SyntheticArticulation::Slide) {
+        ev.articulation = Articulation::Slide;
+        second.articulation = Articulation::Slide;
+      } else {
+        second.articulation = note.articulation == SyntheticArticulation::Hammer ? Articulation::Hammer : Articulation::Pull;
+      }
+      events.push_back(ev);
+      events.push_back(second);
+      continue;
+    }
+    if (note.articulation == SyntheticArticulation::Bend)
+      ev.articulation = Articulation::Bend;
+    else if (note.articulation == SyntheticArticulation::PalmMute)
+      ev.articulation = Articulation::PalmMute;
+    events.push_back(ev);
+  }
+
+  std::stable_sort(events.begin(), events.end(), [](const NoteEvent& a, const NoteEvent& b) {
+    return a.startSec < b.startSec;
+  });
+  return events;
+}
+
+SyntheticScore scoreEvents(const std::vector<NoteEvent>& truth, const std::vector<NoteEvent>& detected,
+                           float toleranceSec) {
+  SyntheticScore score;
+  score.truth = truth.size();
+  score.detected = detected.size();
+  std::vector<bool> used(detected.size(), false);
+  double errorSum = 0.0;
+  for (const auto& want : truth) {
+    std::size_t best = detected.size();
+    float bestError = toleranceSec;
+    for (std::size_t d = 0; d < detected.size(); ++d) {
+      const auto& got = detected[d];
+      if (used[d] || got.stringIdx != want.stringIdx || got.fret != want.fret)
+        continue;
+      const float error = std::fabs(got.startSec - want.startSec);
+      if (error <= bestError) {
+        bestError = error;
+        best = d;
+      }
+    }
+    if (best == detected.size())
+      continue;
+    used[best] = true;
+    ++score.matched;
+    if (detected[best].articulation == want.articulation)
+      ++score.articulationMatched;
+    errorSum += static_cast<double>(detected[best].startSec - want.startSec);
+  }
+  if (score.matched)
+    score.meanOnsetErrorSec = static_cast<float>(errorSum / static_cast<double>(score.matched));
+  return score;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <array>
+#include <vector>
+#include "TabEngine.h"
+
+// Deterministic six-channel hex-pickup signal for benchmarks and accuracy
+// runs. Each note is a Karplus-Strong string (fractional delay line with a
+// one-pole loss filter) tuned from Tuning::stringMidi, so pitch glides and
+// re-excitation model hammer-ons, pull-offs, slides and bends; palm mutes
+// darken and shorten the loop. Adjacent strings bleed into each other and
+// every channel carries a noise floor. All randomness comes from the seed, so
+// a score renders to the same samples every time, and groundTruth() returns
+// the NoteEvents a perfect tracker would report for it.
+
+enum class SyntheticArticulation { None, Hammer, Pull, Slide, Bend, PalmMute };
+
+struct SyntheticNote {
+  int   stringIdx = 0;
+  int   fret = 0;
+  float startSec = 0.f;
+  float durationSec = 0.5f;
+  float velocity = 0.8f;          // 0..1
+  SyntheticArticulation articulation = SyntheticArticulation::None;
+  int   targetFret = -1;          // hammer/pull/slide destination
+  float bendSemitones = 1.f;      // bend depth
+  float transitionSec = 0.25f;    // from startSec to the hammer/pull/slide/bend
+};
+
+struct SyntheticHexConfig {
+  float sampleRate = 48000.f;
+  float crosstalk = 0.01f;        // fraction of each string leaking into its neighbours
+  float noiseFloor = 1.0e-4f;     // white noise RMS on every channel
+  unsigned seed = 1;
+};
+
+// Greedy one-to-one match of detected events against ground truth: same
+// string and fret, onsets within toleranceSec.
+struct SyntheticScore {
+  std::size_t truth = 0;
+  std::size_t detected = 0;
+  std::size_t matched = 0;
+  std::size_t articulationMatched = 0; // matched pairs that also agree on articulation
+  float meanOnsetErrorSec = 0.f;       // detected minus truth, over matched pairs
+
+  float recall() const { return truth ? static_cast<float>(matched) / static_cast<float>(truth) : 0.f; }
+  float precision() const { return detected ? static_cast<float>(matched) / static_cast<float>(detected) : 0.f; }
+};
+
+SyntheticScore scoreEvents(const std::vector<NoteEvent>& truth, const std::vector<NoteEvent>& detected,
+                           float toleranceSec = 0.05f);
+
+class SyntheticHexSource {
+public:
+  SyntheticHexSource(const Tuning& tuning, const SyntheticHexConfig& cfg);
+
+  void clear() { _notes.clear(); }
+  void addNote(const SyntheticNote& note) { _notes.push_back(note); }
+  // Seeded random phrase over all strings: about notesPerSec onsets per second,
+  // articulationRate of them hammered, pulled, slid, bent or palm muted. Notes
+  // on one string never overlap.
+  void generatePhrase(float seconds, float notesPerSec, float articulationRate);
+
+  // Renders the whole score; every out[s] gets frames() samples. A note is cut
+  // (with a short damping) when the next note on its string starts.
+  void render(std::array<std::vector<float>, 6>& out) const;
+  // Events a perfect tracker would emit, ordered by start time. Hammer, pull
+  // and slide notes split into two events at the transition.
+  std::vector<NoteEvent> groundTruth() const;
+
+  const std::vector<SyntheticNote>& notes() const { return _notes; }
+  float sampleRate() const { return _cfg.sampleRate; }
+  float durationSec() const;
+  std::size_t frames() const;
+
+private:
+  void renderNote(const SyntheticNote& note, float cutSec, unsigned seed, std::vector<float>& out) const;
+
+  Tuning _tuning;
+  SyntheticHexConfig _cfg;
+  std::vector<SyntheticNote> _notes;
+};
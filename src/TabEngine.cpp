@@ -1,13 +1,16 @@
 #include "TabEngine.h"
+#include "EventFuser.h"
+#include "EventSerializer.h"
+#include "HexBlockKernel.h"
 #include "StringTracker.h"
+#include "TrackerPool.h"
+#include "TrackerRebuilder.h"
 #include "util.h"
 #include <algorithm>
 #include <array>
-#include <sstream>
-#include <iomanip>
 
 TabEngine::TabEngine(const Tuning& t, const TrackerConfig& c)
-: _tuning(t), _cfg(c), _activeIdx(6, -1)
+: _tuning(t), _cfg(c), _activeIdx(6, -1), _fuser(std::make_unique<EventFuser>())
 {
   _trkPtrs.reserve(6);
   for (int s = 0; s < 6; ++s) {
@@ -15,77 +18,103 @@ TabEngine::TabEngine(const Tuning& t, const TrackerConfig& c)
     tracker->setCalibration(_calibration);
     _trkPtrs.push_back(tracker);
   }
+  _rebuilder = std::make_unique<TrackerRebuilder>(_trkPtrs);
+  for (auto* tracker : _trkPtrs)
+    tracker->setRebuilder(_rebuilder.get());
 }
 
 TabEngine::~TabEngine() {
+  _pool.reset();
+  _rebuilder.reset();
   for (auto* ptr : _trkPtrs) {
     delete ptr;
   }
   _trkPtrs.clear();
 }
 
-void TabEngine::processBlock(const float* const channels[6], int n, float sr, float t0) {
-  for (int s = 0; s < 6; ++s) {
-    _trkPtrs[s]->processBlock(channels[s], n, sr, t0);
-  }
+void TabEngine::processBlock(const float* const channels[6], int n, float sr, float t0,
+                             const HexBlockStats* stats) {
+  // Serial: installs state the rebuilder finished and requests new builds.
+  for (auto* trk : _trkPtrs)
+    trk->prepareBlock(sr, n);
+
+  BlockJob job;
+  job.engine = this;
+  job.channels = channels;
+  job.stats = stats;
+  job.n = n;
+  job.sr = sr;
+  job.t0 = t0;
+  if (_pool)
+    _pool->run(static_cast<int>(_trkPtrs.size()), &TabEngine::runTrackerJob, &job);
+  else
+    for (int s = 0; s < static_cast<int>(_trkPtrs.size()); ++s)
+      runTrackerJob(&job, s);
+
+  // Deterministic merge: staged events land in string order, exactly as the
+  // serial loop used to append them.
+  for (auto* trk : _trkPtrs)
+    trk->commitStagedEvents();
   fuseEvents(t0);
+  _settled = _fuser->settledHandle(_events, _activeIdx, t0 + static_cast<float>(n) / sr);
+
+  int pinned = _events.endHandle();
+  for (int idx : _activeIdx)
+    if (idx >= 0)
+      pinned = std::min(pinned, idx);
+  _events.compact(pinned);
 }
 
-void TabEngine::fuseEvents(float /*t0*/) {
-  std::array<int, 6> lastFinished{};
-  lastFinished.fill(-1);
+void TabEngine::prepare(float sr, int n) {
+  for (auto* trk : _trkPtrs)
+    trk->prepare(sr, n);
+}
 
-  const int total = static_cast<int>(_events.size());
-  for (int i = 0; i < total; ++i) {
-    auto& ev = _events[i];
-    if (ev.stringIdx < 0 || ev.stringIdx >= 6)
-      continue;
+void TabEngine::runTrackerJob(void* ctx, int s) {
+  const auto& job = *static_cast<const BlockJob*>(ctx);
+  const std::size_t slot = static_cast<std::size_t>(s);
+  const bool known = job.stats && job.stats->frames == job.n && job.stats->present[slot];
+  const float peak = known ? job.stats->peak[slot] : -1.f;
+  job.engine->_trkPtrs[slot]->processBlock(job.channels[s], job.n, job.sr, job.t0, peak);
+}
 
-    const bool finished = ev.endSec > ev.startSec;
-    if (!finished)
-      continue;
+void TabEngine::setTrackerThreads(int workerThreads) {
+  const int count = std::clamp(workerThreads, 0, 5);
+  if (count == trackerThreads())
+    return;
+  _pool.reset();
+  if (count > 0)
+    _pool = std::make_unique<TrackerPool>(count);
+}
 
-    const int prevIdx = lastFinished[ev.stringIdx];
-    if (prevIdx >= 0 && prevIdx < total) {
-      auto& prev = _events[prevIdx];
-      if (prev.endSec > prev.startSec) {
-        const float gap = ev.startSec - prev.endSec;
-        if (gap >= 0.f && gap < 0.12f) {
-          const int delta = ev.fret - prev.fret;
-          const int absDelta = delta >= 0 ? delta : -delta;
-
-          if (absDelta >= 2) {
-            if (ev.articulation.empty())
-              ev.articulation = "slide";
-            if (prev.articulation.empty())
-              prev.articulation = "slide";
-          } else if (delta == 1 || delta == 2) {
-            if (ev.articulation.empty())
-              ev.articulation = "hammer";
-          } else if (delta == -1 || delta == -2) {
-            if (ev.articulation.empty())
-              ev.articulation = "pull";
-          } else if (absDelta == 0 && gap < 0.06f) {
-            if (ev.velocity < prev.velocity * 0.7f && ev.articulation.empty())
-              ev.articulation = "pm";
-          }
-        }
-      }
-    }
+int TabEngine::trackerThreads() const {
+  return _pool ? _pool->workerThreads() : 0;
+}
 
-    if (ev.articulation.empty()) {
-      const float duration = ev.endSec - ev.startSec;
-      if (duration < 0.18f && ev.velocity < 0.30f)
-        ev.articulation = "pm";
-    }
+void TabEngine::setFretBank(int stringIdx, bool enabled) {
+  if (stringIdx < 0 || stringIdx >= 6)
+    return;
+  const unsigned bit = 1u << stringIdx;
+  setFretBankStrings(enabled ? (_cfg.fretBankStrings | bit) : (_cfg.fretBankStrings & ~bit));
+}
 
-    lastFinished[ev.stringIdx] = i;
-  }
+TrackerGateStats TabEngine::gateStats(int stringIdx) const {
+  if (stringIdx < 0 || stringIdx >= static_cast<int>(_trkPtrs.size()))
+    return {};
+  return _trkPtrs[static_cast<std::size_t>(stringIdx)]->gateStats();
+}
+
+void TabEngine::fuseEvents(float /*t0*/) {
+  _fuser->run(_events, _activeIdx);
 }
 
 void TabEngine::importEvents(const std::vector<NoteEvent>& events) {
-  _events = events;
+  _events.assign(events);
   std::fill(_activeIdx.begin(), _activeIdx.end(), -1);
+  _fuser->reset();
+  // Imported events are fused now and count as final.
+  _fuser->run(_events, _activeIdx);
+  _settled = _events.endHandle();
   if (events.empty()) {
     for (auto* trk : _trkPtrs) {
       if (trk)
@@ -118,23 +147,7 @@ std::array<float, 6> TabEngine::tuningDeviationCents() const {
 }
 
 std::string TabEngine::toJson(bool onlyFinished) const {
-  std::ostringstream oss;
-  oss << "[";
-  bool first = true;
-  for (const auto& e : _events) {
-    if (onlyFinished && e.endSec <= e.startSec) continue;
-    if (!first) oss << ",";
-    first = false;
-    oss << "{"
-        << "\"string\":" << e.stringIdx
-        << ",\"fret\":" << e.fret
-        << ",\"midi\":" << e.midi
-        << ",\"start\":" << std::fixed << std::setprecision(6) << e.startSec
-        << ",\"end\":"   << std::fixed << std::setprecision(6) << e.endSec
-        << ",\"vel\":"   << std::fixed << std::setprecision(3) << e.velocity
-        << ",\"art\":\"" << e.articulation << "\""
-        << "}";
-  }
-  oss << "]";
-  return oss.str();
+  std::string json;
+  writeEventsJson(json, _events, onlyFinished);
+  return json;
 }
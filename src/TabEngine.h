@@ -1,5 +1,8 @@
 #pragma once
+#include "NoteEventStore.h"
 #include <array>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -8,22 +11,19 @@ struct Tuning {
   std::array<int, 6> stringMidi {40, 45, 50, 55, 59, 64}; // E2 A2 D3 G3 B3 E4
 };
 
-struct NoteEvent {
-  int         stringIdx = -1;     // 0..5
-  int         fret      = -1;     // 0..24
-  int         midi      = -1;     // absolute MIDI pitch
-  float       startSec  = 0.f;    // seconds
-  float       endSec    = 0.f;    // seconds (filled on close)
-  float       velocity  = 0.f;    // 0..1 (relative)
-  std::string articulation;       // "", "slide", "bend", "hammer", "pull", "pm"
-};
-
 struct TrackerConfig {
   float onsetThreshold   = 0.020f;
   float minNoteDurSec    = 0.045f;
   float hopSec           = 0.010f; // 10 ms
+  int   analysisHopSamples = 128;  // tracker hop at the input rate, independent of the block size
   float slideDeltaCents  = 120.f;  // >120c over ~60ms => slide
   float bendDeltaCents   = 35.f;   // >35c sustained => bend
+  bool  multirateLowStrings = false; // decimate low strings before onset/pitch (see Decimator)
+  bool  spectralFrontEnd = false;    // one shared FFT per hop for onset and pitch instead of aubio (see SpectralFrontEnd)
+  bool  nativePitch = false;         // pitch from PitchEstimator instead of aubio or the front end
+  unsigned fretBankStrings = 0;      // bit s: pitch for string s from FretBank, ahead of the above
+  bool  energyGate = false;          // skip pitch (and onset, when quieter still) on hops far below the onset gate
+  int   sustainPitchStride = 1;      // full pitch estimate every Nth hop while a note's pitch holds (see DriftProbe)
 };
 
 struct CalibrationProfile {
@@ -41,7 +41,24 @@ struct FrameFeatures {
   float envelopeRms = 0.f;
 };
 
+// Analysis hops per string since the tracker was created, split by whether
+// the energy gate let pitch and onset detection run (see TrackerConfig::energyGate)
+// and whether the sustain duty cycle left pitch to the drift probe
+// (TrackerConfig::sustainPitchStride). pitchEvaluated + pitchProbed + pitchSkipped == hops.
+struct TrackerGateStats {
+  std::uint64_t hops = 0;
+  std::uint64_t pitchEvaluated = 0;
+  std::uint64_t pitchProbed = 0;
+  std::uint64_t pitchSkipped = 0;
+  std::uint64_t onsetEvaluated = 0;
+  std::uint64_t onsetSkipped = 0;
+};
+
 class StringTracker; // fwd
+class TrackerPool;
+class TrackerRebuilder;
+class EventFuser;
+struct HexBlockStats;
 
 class TabEngine {
 public:
@@ -49,24 +66,94 @@ public:
   ~TabEngine();
   TabEngine(const TabEngine&) = delete;
   TabEngine& operator=(const TabEngine&) = delete;
-  // channels[s] points to mono float buffer for string s; nullptr => silence
-  void processBlock(const float* const channels[6], int n, float sr, float t0);
+  // channels[s] points to mono float buffer for string s; nullptr => silence.
+  // stats (optional) carries per-string peaks already computed by processHexBlock.
+  void processBlock(const float* const channels[6], int n, float sr, float t0,
+                    const HexBlockStats* stats = nullptr);
+  // Builds the trackers' analysis state for sr and blocks of up to n frames
+  // on the calling thread. Call it once the configuration is set and before
+  // audio starts: without it the first processBlock() hands the build to
+  // the rebuilder and the trackers stay silent until it is installed.
+  // Allocates.
+  void prepare(float sr, int n);
 
-  const std::vector<NoteEvent>& events() const { return _events; }
+  // Every kept event, archive first; see setEventRetention().
+  const NoteEventStore& events() const { return _events; }
   std::string toJson(bool onlyFinished=true) const;
+  // Events below this handle are final (see EventFuser::settledHandle());
+  // the bridge's model updates stop re-copying them.
+  int settledHandle() const { return _settled; }
   void importEvents(const std::vector<NoteEvent>& events);
   void applyCalibration(const CalibrationProfile& profile);
   std::array<float, 6> tuningDeviationCents() const;
   std::array<float, 6> calibrationGains() const;
   void setCalibrationGain(int stringIndex, float gain);
+  // Extra worker threads for running the string trackers in parallel; 0 runs
+  // them serially on the calling thread. Output is identical either way.
+  void setTrackerThreads(int workerThreads);
+  int trackerThreads() const;
+  // Runs onset/pitch for strings whose band allows it at 12/16 kHz instead of
+  // the input rate. Trackers reconfigure on their next block.
+  void setMultirateAnalysis(bool enabled) { _cfg.multirateLowStrings = enabled; }
+  bool multirateAnalysis() const { return _cfg.multirateLowStrings; }
+  void setSpectralFrontEnd(bool enabled) { _cfg.spectralFrontEnd = enabled; }
+  bool spectralFrontEnd() const { return _cfg.spectralFrontEnd; }
+  void setNativePitch(bool enabled) { _cfg.nativePitch = enabled; }
+  bool nativePitch() const { return _cfg.nativePitch; }
+  // Per-string fret-constrained classifier (bit s = string s, low E first);
+  // the chosen trackers reconfigure on their next block.
+  void setFretBankStrings(unsigned mask) { _cfg.fretBankStrings = mask & 0x3Fu; }
+  unsigned fretBankStrings() const { return _cfg.fretBankStrings; }
+  void setFretBank(int stringIdx, bool enabled);
+  // Pauses pitch and onset estimation on strings whose envelope sits well
+  // below the onset gate; filter and envelope state keep running.
+  void setEnergyGate(bool enabled) { _cfg.energyGate = enabled; }
+  bool energyGate() const { return _cfg.energyGate; }
+  // Once a note's pitch has held for a few hops, runs the full estimator on
+  // every Nth hop only and follows the note with DriftProbe in between; an
+  // envelope rise, an onset or drift past half the bend threshold returns to
+  // every hop. 1 estimates every hop. Applies to aubio and front-end pitch
+  // only: fret-bank and native-pitch strings (every string without aubio)
+  // update their estimators incrementally and would save nothing.
+  void setSustainPitchStride(int hops) { _cfg.sustainPitchStride = hops; }
+  int sustainPitchStride() const { return _cfg.sustainPitchStride; }
+  // Read from the thread that calls processBlock().
+  TrackerGateStats gateStats(int stringIdx) const;
+  // Analysis hop at the input rate; blocks of any size are accumulated into it.
+  void setAnalysisHop(int samples) { _cfg.analysisHopSamples = samples; }
+  int analysisHop() const { return _cfg.analysisHopSamples; }
+  // Hot events kept once a block is done (rounded to whole chunks, and never
+  // cutting off a sounding note); 0 keeps every event. Older ones go to the
+  // archive when setEventArchive(true), otherwise they are dropped. Allocates.
+  void setEventRetention(std::size_t events) { _events.setRetention(events); }
+  std::size_t eventRetention() const { return _events.retention(); }
+  void setEventArchive(bool enabled) { _events.setArchive(enabled); }
+  // Archived events a recording holds before the audio thread has to
+  // allocate chunks for it (see NoteEventStore::setArchiveReserve()). Allocates.
+  void setEventArchiveReserve(std::size_t events) { _events.setArchiveReserve(events); }
+  std::size_t eventArchiveReserve() const { return _events.archiveReserve(); }
 
 private:
+  struct BlockJob {
+    TabEngine* engine = nullptr;
+    const float* const* channels = nullptr;
+    const HexBlockStats* stats = nullptr;
+    int n = 0;
+    float sr = 0.f;
+    float t0 = 0.f;
+  };
+  static void runTrackerJob(void* ctx, int stringIdx);
+
   void fuseEvents(float t0); // TODO(Copilot): rules (hammer/pull/slide/bend/pm)
 
   Tuning _tuning;
   TrackerConfig _cfg;
   CalibrationProfile _calibration;
-  std::vector<NoteEvent> _events;
-  std::vector<int> _activeIdx; // per-string active event index or -1
+  NoteEventStore _events;
+  std::vector<int> _activeIdx; // per-string active event handle or -1
   std::vector<StringTracker*> _trkPtrs; // owned
+  std::unique_ptr<TrackerPool> _pool;
+  std::unique_ptr<TrackerRebuilder> _rebuilder;
+  std::unique_ptr<EventFuser> _fuser;
+  int _settled = 0;
 };
@@ -1,5 +1,6 @@
 #include "TabEngineBridge.h"
 
+#include "EventSerializer.h"
 #include "SessionLogger.h"
 #include "NoteDetectionStore.h"
 #include "audio/HexAudioClient.h"
@@ -23,10 +24,13 @@
 #include <limits>
 #include <sndfile.h>
 #include <system_error>
+#include <thread>
 #include <cmath>
 
 namespace {
 constexpr float kSessionWaveTapSeconds = 8.0f;
+constexpr std::size_t kPreviewEvents = 1024;
+constexpr std::size_t kArchiveEvents = std::size_t {1} << 16;   // 1 MiB of events per take
 QString calibrationStringName(int index) {
     static const std::array<const char*, 6> kNames{{"Low E", "A", "D", "G", "B", "High e"}};
     if (index < 0 || index >= static_cast<int>(kNames.size()))
@@ -40,6 +44,56 @@ TabEngineBridge::TabEngineBridge(QObject* parent)
     , m_engine(std::make_unique<TabEngine>(m_tuning, m_cfg))
 {
     m_debugNoteLogging = qEnvironmentVariableIsSet("GUITARPI_TEST_LOG_NOTES");
+    // Leave one core for JACK and one for the UI; the rest run string trackers.
+    const int cores = static_cast<int>(std::thread::hardware_concurrency());
+    const int trackerThreads = qEnvironmentVariableIsSet("GUITARPI_TRACKER_THREADS")
+        ? qEnvironmentVariableIntValue("GUITARPI_TRACKER_THREADS")
+        : std::clamp(cores - 2, 0, 3);
+    m_engine->setTrackerThreads(trackerThreads);
+    qInfo() << "TabBridge" << "tracker-threads" << m_engine->trackerThreads();
+    if (qEnvironmentVariableIsSet("GUITARPI_ANALYSIS_HOP"))
+        m_engine->setAnalysisHop(qEnvironmentVariableIntValue("GUITARPI_ANALYSIS_HOP"));
+    qInfo() << "TabBridge" << "analysis-hop" << m_engine->analysisHop();
+    if (qEnvironmentVariableIntValue("GUITARPI_MULTIRATE") > 0) {
+        m_engine->setMultirateAnalysis(true);
+        qInfo() << "TabBridge" << "multirate-analysis" << "enabled";
+    }
+    if (qEnvironmentVariableIntValue("GUITARPI_SPECTRAL_FRONTEND") > 0) {
+        m_engine->setSpectralFrontEnd(true);
+        qInfo() << "TabBridge" << "spectral-front-end" << "enabled";
+    }
+    if (qEnvironmentVariableIntValue("GUITARPI_NATIVE_PITCH") > 0) {
+        m_engine->setNativePitch(true);
+        qInfo() << "TabBridge" << "native-pitch" << "enabled";
+    }
+    // Bit mask of strings (bit 0 = low E), decimal or 0x-prefixed.
+    if (qEnvironmentVariableIntValue("GUITARPI_FRET_BANK") > 0) {
+        m_engine->setFretBankStrings(static_cast<unsigned>(qEnvironmentVariableIntValue("GUITARPI_FRET_BANK")));
+        qInfo() << "TabBridge" << "fret-bank" << "strings-mask" << m_engine->fretBankStrings();
+    }
+    if (qEnvironmentVariableIntValue("GUITARPI_ENERGY_GATE") > 0) {
+        m_engine->setEnergyGate(true);
+        qInfo() << "TabBridge" << "energy-gate" << "enabled";
+    }
+    if (qEnvironmentVariableIntValue("GUITARPI_SUSTAIN_PITCH_STRIDE") > 1) {
+        m_engine->setSustainPitchStride(qEnvironmentVariableIntValue("GUITARPI_SUSTAIN_PITCH_STRIDE"));
+        qInfo() << "TabBridge" << "sustain-pitch-stride" << m_engine->sustainPitchStride();
+    }
+    // Hot events kept for the live preview; capture archives older ones instead.
+    m_engine->setEventRetention(qEnvironmentVariableIsSet("GUITARPI_PREVIEW_EVENTS")
+        ? static_cast<std::size_t>(std::max(0, qEnvironmentVariableIntValue("GUITARPI_PREVIEW_EVENTS")))
+        : kPreviewEvents);
+    qInfo() << "TabBridge" << "preview-events" << m_engine->eventRetention();
+    // Chunks a recording archives come from this reserve, so the analysis
+    // worker does not allocate them mid-take.
+    m_engine->setEventArchiveReserve(qEnvironmentVariableIsSet("GUITARPI_ARCHIVE_EVENTS")
+        ? static_cast<std::size_t>(std::max(0, qEnvironmentVariableIntValue("GUITARPI_ARCHIVE_EVENTS")))
+        : kArchiveEvents);
+    qInfo() << "TabBridge" << "archive-events" << m_engine->eventArchiveReserve();
+    // Model updates carry the unsettled and new events of a block or a few;
+    // sized so publishing them does not allocate on the worker either.
+    m_eventUpdate.events.reserve(kPreviewEvents);
+    m_appliedEventUpdate.events.reserve(kPreviewEvents);
     if (m_debugNoteLogging)
         qInfo() << "TabBridge" << "debug-note-logging" << "enabled";
     m_lastLiveTriggerSec.fill(-1.f);
@@ -223,19 +277,14 @@ void TabEngineBridge::requestRefresh() {
 }
 
 void TabEngineBridge::clear() {
-    if (m_engine) {
-        m_engine->importEvents({});
-    }
+    // The engine belongs to the analysis worker; it clears the events and the
+    // live state on its next block and publishes the empty store to the model.
     {
         std::lock_guard<std::mutex> guard(m_liveMutex);
         m_livePending.clear();
+        m_pendingImport.clear();
     }
-    m_liveTimeSec = 0.f;
-    m_liveSampleRate = 0.f;
-    m_lastDispatchedEvent.store(0, std::memory_order_release);
-    m_lastLiveTriggerSec.fill(-1.f);
-    m_lastLiveFret.fill(-1);
-    syncFromEngine();
+    m_resetRequested.store(true, std::memory_order_release);
 }
 
 void TabEngineBridge::seedMockSession() {
@@ -252,7 +301,7 @@ void TabEngineBridge::seedMockSession() {
     ev.startSec = 0.0f;
     ev.endSec = 1.4f;
     ev.velocity = 0.78f;
-    ev.articulation.clear();
+    ev.articulation = Articulation::None;
     mock.push_back(ev);
 
     ev.stringIdx = 4;
@@ -261,7 +310,7 @@ void TabEngineBridge::seedMockSession() {
     ev.startSec = 0.45f;
     ev.endSec = 1.2f;
     ev.velocity = 0.65f;
-    ev.articulation = "hammer";
+    ev.articulation = Articulation::Hammer;
     mock.push_back(ev);
 
     ev.stringIdx = 3;
@@ -270,7 +319,7 @@ void TabEngineBridge::seedMockSession() {
     ev.startSec = 1.0f;
     ev.endSec = 1.6f;
     ev.velocity = 0.62f;
-    ev.articulation = "slide";
+    ev.articulation = Articulation::Slide;
     mock.push_back(ev);
 
     ev.stringIdx = 3;
@@ -279,7 +328,7 @@ void TabEngineBridge::seedMockSession() {
     ev.startSec = 1.62f;
     ev.endSec = 2.1f;
     ev.velocity = 0.72f;
-    ev.articulation = "slide";
+    ev.articulation = Articulation::Slide;
     mock.push_back(ev);
 
     ev.stringIdx = 2;
@@ -288,11 +337,14 @@ void TabEngineBridge::seedMockSession() {
     ev.startSec = 2.2f;
     ev.endSec = 2.8f;
     ev.velocity = 0.35f;
-    ev.articulation = "pm";
+    ev.articulation = Articulation::PalmMute;
     mock.push_back(ev);
 
-    m_engine->importEvents(mock);
-    syncFromEngine();
+    {
+        std::lock_guard<std::mutex> guard(m_liveMutex);
+        m_pendingImport = std::move(mock);
+    }
+    m_resetRequested.store(true, std::memory_order_release);
 }
 
 void TabEngineBridge::setRecording(bool value) {
@@ -306,6 +358,10 @@ void TabEngineBridge::setRecording(bool value) {
 
     if (value) {
         // Starting a new capture should clear any accumulated timeline so taps begin fresh.
+        {
+            std::lock_guard<std::mutex> guard(m_liveMutex);
+            m_pendingImport.clear();
+        }
         m_resetRequested.store(true, std::memory_order_release);
         if (m_pendingCaptureValid) {
             SessionLogger::instance().log("live-record", "pending capture discarded (new recording started before labeling)");
@@ -389,7 +445,14 @@ void TabEngineBridge::setAudioClient(HexAudioClient* client) {
     }
 }
 
-void TabEngineBridge::processLiveAudioBlock(const float* const channels[6], int n, float sr) {
+void TabEngineBridge::prepareAnalysis(float sr, int maxBlockFrames) {
+    if (!m_engine || sr <= 0.f || maxBlockFrames <= 0)
+        return;
+    m_engine->prepare(sr, maxBlockFrames);
+}
+
+void TabEngineBridge::processLiveAudioBlock(const float* const channels[6], int n, float sr,
+                                            const HexBlockStats* stats, std::uint64_t gapFrames) {
     if (!m_engine || n <= 0 || sr <= 0.f)
         return;
 
@@ -400,15 +463,30 @@ void TabEngineBridge::processLiveAudioBlock(const float* const channels[6], int
 
     bool reset = m_resetRequested.exchange(false, std::memory_order_acq_rel);
     if (reset || std::fabs(m_liveSampleRate - sr) > 1e-4f) {
-        m_engine->importEvents({});
+        std::vector<NoteEvent> imported;
+        {
+            std::lock_guard<std::mutex> guard(m_liveMutex);
+            imported.swap(m_pendingImport);
+        }
+        m_engine->importEvents(imported);
         m_liveTimeSec = 0.f;
         m_liveSampleRate = sr;
         m_lastDispatchedEvent.store(0, std::memory_order_release);
         m_lastLiveTriggerSec.fill(-1.f);
         m_lastLiveFret.fill(-1);
         reset = true;
-        if (m_debugNoteLogging)
+        if (m_debugNoteLogging) {
             qInfo() << "TabBridge" << "engine-reset" << "sr" << sr << "capturing" << capturing;
+            if (m_engine->energyGate() || m_engine->sustainPitchStride() > 1) {
+                QStringList gateSummary;
+                for (int i = 0; i < 6; ++i) {
+                    const TrackerGateStats gate = m_engine->gateStats(i);
+                    gateSummary << QStringLiteral("s%1=%2/%3/%4/%5").arg(i + 1).arg(gate.hops).arg(gate.pitchProbed)
+                                       .arg(gate.pitchSkipped).arg(gate.onsetSkipped);
+                }
+                qInfo() << "TabBridge" << "pitch-schedule" << "hops/pitch-probed/pitch-skipped/onset-skipped" << gateSummary.join(' ');
+            }
+        }
     }
 
     if (!capturing && reset) {
@@ -416,14 +494,28 @@ void TabEngineBridge::processLiveAudioBlock(const float* const channels[6], int
         m_liveTimeSec = 0.f;
     }
 
+    if (gapFrames > 0 && !reset) {
+        // The trackers see the jump in block time and restart their hop
+        // history instead of stitching audio across the hole.
+        m_liveTimeSec += static_cast<float>(static_cast<double>(gapFrames) / sr);
+    }
+
     if (capturing) {
         if (m_captureSampleRate <= 0.f || std::fabs(m_captureSampleRate - sr) > 1e-3f)
             m_captureSampleRate = sr;
+        if (gapFrames > 0 && !reset) {
+            // Silence keeps the exported audio aligned with the event times.
+            const float* const silence[6] {};
+            const auto padFrames = std::min<std::uint64_t>(gapFrames, std::numeric_limits<int>::max());
+            appendCaptureAudio(silence, static_cast<int>(padFrames));
+        }
         appendCaptureAudio(channels, n);
     }
 
     std::array<float, 6> blockRms {};
-    if (n > 0) {
+    if (stats && stats->frames == n) {
+        blockRms = stats->rms;
+    } else {
         for (int i = 0; i < 6; ++i) {
             const float* data = channels[static_cast<std::size_t>(i)];
             if (!data)
@@ -448,20 +540,29 @@ void TabEngineBridge::processLiveAudioBlock(const float* const channels[6], int
     }
 
     const float blockStart = m_liveTimeSec;
-    m_engine->processBlock(channels, n, sr, blockStart);
+    m_engine->setEventArchive(capturing);
+    m_engine->processBlock(channels, n, sr, blockStart, stats);
+    const std::uint64_t chunkAllocations = m_engine->events().chunkAllocations();
+    if (chunkAllocations != m_eventChunkAllocations) {
+        m_eventChunkAllocations = chunkAllocations;
+        if (capturing)
+            SessionLogger::instance().logf("live-record", "take outgrew GUITARPI_ARCHIVE_EVENTS=%zu; event chunk allocated on the analysis thread (%llu so far)",
+                                           m_engine->eventArchiveReserve(), static_cast<unsigned long long>(chunkAllocations));
+    }
+    publishEvents();
     updateTuningDeviation();
     m_liveTimeSec += static_cast<float>(n) / sr;
 
     const auto& events = m_engine->events();
-    const int total = static_cast<int>(events.size());
-    int last = m_lastDispatchedEvent.load(std::memory_order_acquire);
+    const int total = events.endHandle();
+    const int last = std::max(m_lastDispatchedEvent.load(std::memory_order_acquire), events.firstHandle());
     if (total <= last)
         return;
 
     std::vector<LiveEvent> newEvents;
     newEvents.reserve(static_cast<std::size_t>(total - last));
     for (int i = last; i < total; ++i) {
-        const auto& ev = events[std::size_t(i)];
+        const auto& ev = events[i];
         if (ev.stringIdx < 0 || ev.stringIdx >= 6)
             continue;
         if (ev.fret < 0 || ev.fret > 24)
@@ -476,8 +577,8 @@ void TabEngineBridge::processLiveAudioBlock(const float* const channels[6], int
         newEvents.push_back({ev.stringIdx, ev.fret, ev.velocity, ev.startSec});
         if (m_debugNoteLogging) {
             qInfo() << "TabBridge" << "note"
-                    << "string" << ev.stringIdx
-                    << "fret" << ev.fret
+                    << "string" << static_cast<int>(ev.stringIdx)
+                    << "fret" << static_cast<int>(ev.fret)
                     << "velocity" << QString::number(ev.velocity, 'f', 3)
                     << "start" << QString::number(ev.startSec, 'f', 3);
         }
@@ -494,13 +595,6 @@ void TabEngineBridge::processLiveAudioBlock(const float* const channels[6], int
     }
 
     scheduleLiveDispatch();
-
-    if (!capturing) {
-        const int maxPreviewEvents = 256;
-        if (total > maxPreviewEvents) {
-            m_resetRequested.store(true, std::memory_order_release);
-        }
-    }
 }
 
 void TabEngineBridge::postMeterSnapshot(const std::array<float, 6>& meters) {
@@ -509,34 +603,43 @@ void TabEngineBridge::postMeterSnapshot(const std::array<float, 6>& meters) {
                               Qt::QueuedConnection);
 }
 
-void TabEngineBridge::syncFromEngine() {
-    if (!m_engine) {
-        if (!m_events.isEmpty()) {
-            m_events.clear();
-            m_eventsJson = "[]";
-            emit eventsChanged();
-        }
-        return;
+void TabEngineBridge::publishEvents() {
+    const NoteEventStore& events = m_engine->events();
+    const std::uint64_t epoch = events.epoch();
+    const int first = events.firstHandle();
+    const int end = events.endHandle();
+    const bool cleared = epoch != m_publishedEpoch;
+    int from = cleared ? first : std::max(m_publishedSettled, first);
+    {
+        std::lock_guard<std::mutex> guard(m_liveMutex);
+        // The GUI has not applied the previous update yet; carry its events too.
+        if (m_eventUpdate.ready && m_eventUpdate.epoch == epoch)
+            from = std::max(std::min(from, m_eventUpdate.from), first);
+        if (!cleared && from >= end && first == m_publishedFirst)
+            return;
+        m_eventUpdate.epoch = epoch;
+        m_eventUpdate.first = first;
+        m_eventUpdate.from = from;
+        m_eventUpdate.events.clear();
+        for (int handle = from; handle < end; ++handle)
+            m_eventUpdate.events.push_back(events[handle]);
+        m_eventUpdate.ready = true;
     }
+    m_publishedEpoch = epoch;
+    m_publishedFirst = first;
+    m_publishedSettled = std::min(m_engine->settledHandle(), end);
+    scheduleLiveDispatch();
+}
 
-    QVariantList list;
-    list.reserve(static_cast<int>(m_engine->events().size()));
-    for (const auto& ev : m_engine->events()) {
-        QVariantMap map;
-        map.insert(QStringLiteral("string"), ev.stringIdx);
-        map.insert(QStringLiteral("fret"), ev.fret);
-        map.insert(QStringLiteral("midi"), ev.midi);
-        map.insert(QStringLiteral("start"), ev.startSec);
-        map.insert(QStringLiteral("end"), ev.endSec);
-        map.insert(QStringLiteral("velocity"), ev.velocity);
-        map.insert(QStringLiteral("articulation"), QString());
-        list.push_back(map);
+void TabEngineBridge::syncFromEngine() {
+    {
+        std::lock_guard<std::mutex> guard(m_liveMutex);
+        if (!m_eventUpdate.ready)
+            return;
+        std::swap(m_eventUpdate, m_appliedEventUpdate);
+        m_eventUpdate.ready = false;
     }
-
-    m_events = list;
-    const QJsonDocument doc = QJsonDocument::fromVariant(list);
-    m_eventsJson = QString::fromUtf8(doc.toJson(QJsonDocument::Compact));
-    emit eventsChanged();
+    m_eventModel.apply(m_appliedEventUpdate);
 }
 
 void TabEngineBridge::scheduleLiveDispatch() {
@@ -557,6 +660,8 @@ void TabEngineBridge::updateTuningDeviation() {
 }
 
 void TabEngineBridge::dispatchLiveEvents() {
+    syncFromEngine();
+
     std::vector<LiveEvent> batch;
     {
         std::lock_guard<std::mutex> guard(m_liveMutex);
@@ -802,7 +907,11 @@ void TabEngineBridge::finalizeCaptureBuffers() {
     }
     m_pendingSampleRate = m_captureSampleRate;
     m_pendingCaptureValid = hasSamples && m_pendingSampleRate > 0.f;
-    m_pendingEventsJsonSnapshot = m_eventsJson;
+    m_pendingEvents.clear();
+    for (const NoteEvent& ev : m_eventModel.events()) {
+        if (ev.endSec > ev.startSec)
+            m_pendingEvents.push_back(ev);
+    }
     m_captureSampleRate = 0.f;
     if (!m_pendingCaptureValid)
         clearPendingCapture();
@@ -901,7 +1010,7 @@ void TabEngineBridge::clearPendingCapture() {
         buffer.clear();
     m_pendingSampleRate = 0.f;
     m_pendingCaptureValid = false;
-    m_pendingEventsJsonSnapshot.clear();
+    m_pendingEvents.clear();
 }
 
 QString TabEngineBridge::stringNoteToken(int stringIdx) const {
@@ -1098,9 +1207,14 @@ bool TabEngineBridge::exportPendingCapture(const QString& rawLabel) {
     const QString eventsPath = QString::fromStdString((sessionDir / "events.json").string());
     QFile eventsFile(eventsPath);
     if (eventsFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-        eventsFile.write(m_pendingEventsJsonSnapshot.toUtf8());
+        std::string eventsJson;
+        writeEventsJson(eventsJson, m_pendingEvents, true);
+        eventsFile.write(eventsJson.data(), static_cast<qint64>(eventsJson.size()));
         eventsFile.close();
     }
+    // Same events, columnar, for reloading long takes without parsing JSON.
+    if (!writeEventsBinary((sessionDir / "events.bin").string(), m_pendingEvents))
+        SessionLogger::instance().log("live-record", "failed to write events.bin");
 
     SessionLogger::instance().logf("live-record",
                                    "saved session folder='%s' duration=%.2f",
@@ -3,19 +3,21 @@
 #include <QVariantList>
 #include <array>
 #include <atomic>
+#include <cstdint>
 #include <filesystem>
 #include <memory>
 #include <mutex>
 #include <vector>
 
+#include "HexBlockKernel.h"
+#include "NoteEventModel.h"
 #include "TabEngine.h"
 
 class HexAudioClient;
 
 class TabEngineBridge : public QObject {
     Q_OBJECT
-    Q_PROPERTY(QVariantList events READ events NOTIFY eventsChanged)
-    Q_PROPERTY(QString eventsJson READ eventsJson NOTIFY eventsChanged)
+    Q_PROPERTY(QObject* eventModel READ eventModelObject CONSTANT)
     Q_PROPERTY(bool recording READ recording WRITE setRecording NOTIFY recordingChanged)
     Q_PROPERTY(QVariantList hexMeters READ hexMeters NOTIFY hexMetersChanged)
     Q_PROPERTY(bool calibrationRunning READ calibrationRunning NOTIFY calibrationStatusChanged)
@@ -29,8 +31,8 @@ public:
     explicit TabEngineBridge(QObject* parent=nullptr);
     ~TabEngineBridge();
 
-    QVariantList events() const { return m_events; }
-    QString eventsJson() const { return m_eventsJson; }
+    QObject* eventModelObject() { return &m_eventModel; }
+    const NoteEventModel& eventModel() const { return m_eventModel; }
     bool recording() const { return m_captureEnabled.load(std::memory_order_acquire); }
     QVariantList hexMeters() const { return m_hexMeters; }
     bool calibrationRunning() const { return m_calibrationRunning; }
@@ -52,7 +54,14 @@ public:
 
     void setAudioClient(HexAudioClient* client);
     void getCalibrationMultipliers(std::array<float, 6>& multipliers) const;
-    void processLiveAudioBlock(const float* const channels[6], int n, float sr);
+    // gapFrames: audio dropped before this block (analysis queue overrun);
+    // analysis time skips it so later events stay on the capture clock.
+    // Builds the engine's analysis state for a capture about to start, so the
+    // analysis thread does not; call before its first block is delivered.
+    void prepareAnalysis(float sr, int maxBlockFrames);
+    void processLiveAudioBlock(const float* const channels[6], int n, float sr,
+                               const HexBlockStats* stats = nullptr,
+                               std::uint64_t gapFrames = 0);
     bool exportPendingCapture(const QString& label);
     bool hasPendingCapture() const { return m_pendingCaptureValid; }
     void discardPendingCapture();
@@ -71,7 +80,6 @@ public slots:
                                    const std::array<float, 6>& peaks);
 
 signals:
-    void eventsChanged();
     void recordingChanged();
     void liveNoteTriggered(int stringIndex, int fretIndex, float velocity);
     void hexMetersChanged();
@@ -88,6 +96,7 @@ private:
         float startSec = 0.f;
     };
 
+    void publishEvents();
     void syncFromEngine();
     void scheduleLiveDispatch();
     void dispatchLiveEvents();
@@ -114,8 +123,7 @@ private:
     Tuning m_tuning;
     TrackerConfig m_cfg;
     std::unique_ptr<TabEngine> m_engine;
-    QVariantList m_events;
-    QString m_eventsJson {"[]"};
+    NoteEventModel m_eventModel;
     QVariantList m_hexMeters;
     bool m_calibrationRunning {false};
     QString m_calibrationMessage {QStringLiteral("Uncalibrated")};
@@ -132,6 +140,10 @@ private:
     std::atomic<bool> m_captureEnabled {false};
     std::atomic<bool> m_resetRequested {true};
     std::atomic<int> m_lastDispatchedEvent {0};
+    std::uint64_t m_eventChunkAllocations {0};   // analysis thread only
+    std::uint64_t m_publishedEpoch {0};          // analysis thread only
+    int m_publishedFirst {0};                    // analysis thread only
+    int m_publishedSettled {0};                  // analysis thread only
     float m_liveTimeSec {0.f};
     float m_liveSampleRate {0.f};
     std::atomic<int> m_lastProcessBlockFrames {0};
@@ -139,6 +151,13 @@ private:
     HexAudioClient* m_audioClient {nullptr};
     std::mutex m_liveMutex;
     std::vector<LiveEvent> m_livePending;
+    // Events for m_eventModel, published by the analysis worker after each
+    // block; the GUI swaps it into m_appliedEventUpdate and never reads the
+    // engine's store.
+    NoteEventUpdate m_eventUpdate;
+    NoteEventUpdate m_appliedEventUpdate;   // GUI thread only
+    // Events clear()/seedMockSession() hand to the worker's next engine reset.
+    std::vector<NoteEvent> m_pendingImport;
     std::atomic<bool> m_dispatchQueued {false};
     std::array<float, 6> m_lastLiveTriggerSec {};
     std::array<int, 6> m_lastLiveFret {};
@@ -153,7 +172,7 @@ private:
     float m_sessionWaveTapSampleRate {0.f};
     bool m_sessionWaveTapDirty {false};
     bool m_pendingCaptureValid {false};
-    QString m_pendingEventsJsonSnapshot;
+    std::vector<NoteEvent> m_pendingEvents;   // finished events of the pending capture
     bool m_debugNoteLogging {false};
     bool m_externalMetersActive {false};
     bool m_tuningModeEnabled {false};
@@ -0,0 +1,198 @@
+#include "TraceRing.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+namespace {
+// A few seconds of the debug string's onset decisions at the default hop;
+// the logger drains every few tens of milliseconds.
+constexpr std::size_t kRingRecords = 1024;
+
+struct EventInfo {
+  const char* name;
+  // printf conversions, %d or %f only: the first takes Record::tSec, the
+  // rest take values in order.
+  const char* fields;
+};
+
+constexpr const char* kOnsetDecisionFields =
+    "t=%.4f env=%.6f gate=%.6f envDelta=%.6f envFloor=%.6f onset=%.6f thresh=%.6f onsetDelta=%.6f "
+    "baseline=%.6f floor=%.6f adapt=%.6f lastPeak=%.6f baseParam=%.6f gateRatio=%.4f envParam=%.6f "
+    "onsetScale=%.3f retriggerScale=%.3f guard=%.3f guardRemain=%.3f activeAge=%.3f retrigRemain=%.3f "
+    "pitchHz=%.2f pitchCents=%.1f";
+
+constexpr EventInfo kEvents[] = {
+    {"spectral-raw", "t=%.4f onset=%.6f flux=%.6f hfc=%.3f clarity=%.3f env=%.6f peak=%.6f"},
+    {"aubio-raw", "t=%.4f onset=%.6f env=%.6f peak=%.6f gain=%.3f"},
+    {"onset-below-threshold", kOnsetDecisionFields},
+    {"onset-latched", kOnsetDecisionFields},
+    {"onset-below-gate", kOnsetDecisionFields},
+    {"onset-below-env-floor", kOnsetDecisionFields},
+    {"onset-separation-guard", kOnsetDecisionFields},
+    {"onset-active-guard", kOnsetDecisionFields},
+    {"onset-accepted", kOnsetDecisionFields},
+    {"onset", "t=%.3f env=%.5f gate=%.5f envDelta=%.5f envFloor=%.5f onset=%.3f thresh=%.3f onsetDelta=%.5f "
+              "baseline=%.5f adaptive=%.5f lastPeak=%.5f guard=%.3f activeAge=%.3f pitch=%.2fHz pitchCents=%.1f"},
+    {"harmonic-bias", "t=%.3f pitch=%.2fHz ratio=%.2f harmonic=%d midi=%d->%d"},
+    {"release-quiet", "t=%.3f avgEnv=%.5f floor=%.5f quietFrames=%d"},
+    {"release-retrigger", "t=%.3f onset=%.3f gate=%.3f age=%.3f"},
+    {"note-ended (new onset)", "t=%.3f fret=%d dur=%.3f"},
+    {"open-hold", "t=%.3f hold=%.3fs"},
+    {"note-start", "t=%.3f fret=%d midi=%d vel=%.2f env=%.5f"},
+    {"note-ended", "t=%.3f fret=%d dur=%.3f"},
+};
+static_assert(std::size(kEvents) == static_cast<std::size_t>(Event::Count), "one EventInfo per Event");
+
+// Single producer (the owning thread), single consumer (drain()).
+struct Ring {
+  std::array<Record, kRingRecords> slots;
+  std::atomic<std::uint64_t> head {0};   // records written
+  std::atomic<std::uint64_t> tail {0};   // records drained
+  std::atomic<bool> owned {false};
+};
+
+std::atomic<bool> gEnabled {false};
+std::atomic<std::uint64_t> gDropped {0};
+// Rings outlive their threads; a new thread takes over an idle, empty one.
+std::mutex gRegistryMutex;
+std::vector<std::unique_ptr<Ring>> gRings;
+
+struct ThreadRing {
+  Ring* ring = nullptr;
+  ~ThreadRing() {
+    if (ring)
+      ring->owned.store(false, std::memory_order_release);
+  }
+};
+
+thread_local ThreadRing tRing;
+
+Ring* threadRing() {
+  if (tRing.ring)
+    return tRing.ring;
+  std::lock_guard<std::mutex> guard(gRegistryMutex);
+  for (const auto& ring : gRings) {
+    if (!ring->owned.load(std::memory_order_acquire)
+        && ring->head.load(std::memory_order_relaxed) == ring->tail.load(std::memory_order_acquire)) {
+      tRing.ring = ring.get();
+      break;
+    }
+  }
+  if (!tRing.ring) {
+    gRings.push_back(std::make_unique<Ring>());
+    tRing.ring = gRings.back().get();
+  }
+  tRing.ring->owned.store(true, std::memory_order_relaxed);
+  return tRing.ring;
+}
+
+void append(std::string& out, const char* spec, std::size_t specLen, float value) {
+  char conversion[16];
+  char text[64];
+  if (specLen >= sizeof(conversion))
+    return;
+  std::copy(spec, spec + specLen, conversion);
+  conversion[specLen] = '\0';
+  const int written = conversion[specLen - 1] == 'd'
+      ? std::snprintf(text, sizeof(text), conversion, static_cast<int>(value))
+      : std::snprintf(text, sizeof(text), conversion, static_cast<double>(value));
+  if (written > 0)
+    out.append(text, std::min(static_cast<std::size_t>(written), sizeof(text) - 1));
+}
+}
+
+bool enabled() {
+  return gEnabled.load(std::memory_order_relaxed);
+}
+
+void setEnabled(bool on) {
+  gEnabled.store(on, std::memory_order_relaxed);
+}
+
+void prepareThread() {
+  threadRing();
+}
+
+void emit(Event event, int string, float tSec, std::initializer_list<float> values) {
+  if (!enabled())
+    return;
+  Ring& ring = *threadRing();
+  const std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+  if (head - ring.tail.load(std::memory_order_acquire) >= kRingRecords) {
+    gDropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  Record& record = ring.slots[head % kRingRecords];
+  record.event = event;
+  record.string = static_cast<std::int8_t>(string);
+  record.tSec = tSec;
+  std::size_t count = 0;
+  for (float value : values) {
+    if (count == kMaxValues)
+      break;
+    record.values[count++] = value;
+  }
+  record.count = static_cast<std::uint8_t>(count);
+  ring.head.store(head + 1, std::memory_order_release);
+}
+
+std::size_t drain(const std::function<void(const Record&)>& sink) {
+  std::lock_guard<std::mutex> guard(gRegistryMutex);
+  std::size_t drained = 0;
+  for (const auto& ring : gRings) {
+    const std::uint64_t head = ring->head.load(std::memory_order_acquire);
+    std::uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    for (; tail != head; ++tail, ++drained)
+      sink(ring->slots[tail % kRingRecords]);
+    ring->tail.store(tail, std::memory_order_release);
+  }
+  return drained;
+}
+
+std::uint64_t takeDropped() {
+  return gDropped.exchange(0, std::memory_order_relaxed);
+}
+
+std::string format(const Record& record) {
+  if (record.event >= Event::Count)
+    return {};
+  const EventInfo& info = kEvents[static_cast<std::size_t>(record.event)];
+  std::string out;
+  out.reserve(256);
+  if (record.string >= 0) {
+    out += "[s";
+    out += std::to_string(record.string + 1);
+    out += "] ";
+  }
+  out += info.name;
+  out += ' ';
+
+  // Walk the field list, substituting tSec and then each value for the next
+  // conversion; a record with fewer values than conversions prints nan.
+  std::size_t next = 0;
+  for (const char* p = info.fields; *p;) {
+    if (*p != '%') {
+      out += *p++;
+      continue;
+    }
+    const char* end = p + 1;
+    while (*end && *end != 'd' && *end != 'f')
+      ++end;
+    if (!*end)
+      break;
+    const float value = next == 0 ? record.tSec
+        : (next - 1 < record.count ? record.values[next - 1] : std::numeric_limits<float>::quiet_NaN());
+    append(out, p, static_cast<std::size_t>(end - p + 1), value);
+    ++next;
+    p = end + 1;
+  }
+  return out;
+}
+
+} // namespace trace
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+
+// Binary decision traces for the detection hot path. emit() copies an event
+// id, the string, the audio time and up to kMaxValues raw floats into a ring
+// owned by the calling thread: no formatting, no locks, no allocation after
+// the thread's first record (or prepareThread()). SessionLogger's worker
+// drains every ring and formats the records as the tracker's old log lines;
+// a full ring drops the record and counts it.
+namespace trace {
+
+enum class Event : std::uint16_t {
+  SpectralRaw,
+  AubioRaw,
+  OnsetBelowThreshold,
+  OnsetLatched,
+  OnsetBelowGate,
+  OnsetBelowEnvFloor,
+  OnsetSeparationGuard,
+  OnsetActiveGuard,
+  OnsetAccepted,
+  Onset,
+  HarmonicBias,
+  ReleaseQuiet,
+  ReleaseRetrigger,
+  NoteEndedByOnset,
+  OpenHold,
+  NoteStart,
+  NoteEnded,
+  Count
+};
+
+constexpr std::size_t kMaxValues = 24;
+
+struct Record {
+  Event event = Event::Count;
+  std::int8_t string = -1;       // 0-based, -1 for none
+  std::uint8_t count = 0;        // values used
+  float tSec = 0.f;              // audio time the record describes
+  float values[kMaxValues] {};
+};
+
+// Off until SessionLogger has a file to drain into; emit() is then a load and
+// a branch.
+bool enabled();
+void setEnabled(bool on);
+
+// Registers the calling thread's ring ahead of its first record, so the
+// allocation happens outside the realtime section.
+void prepareThread();
+void emit(Event event, int string, float tSec, std::initializer_list<float> values);
+
+// Consumer side, one thread at a time: passes every queued record to sink,
+// oldest first per thread, and returns how many.
+std::size_t drain(const std::function<void(const Record&)>& sink);
+// Records dropped on full rings since the last call.
+std::uint64_t takeDropped();
+
+// "[s1] note-start t=0.316 fret=10 ..." (no timestamp or component).
+std::string format(const Record& record);
+
+} // namespace trace
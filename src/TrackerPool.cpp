@@ -0,0 +1,116 @@
+#include "TrackerPool.h"
+#include "SessionLogger.h"
+#include "TraceRing.h"
+#include <algorithm>
+#include <pthread.h>
+#include <sched.h>
+
+namespace {
+constexpr int kBarrierSpinIterations = 2000;
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+} // namespace
+
+TrackerPool::TrackerPool(int workerThreads) {
+  const int count = std::max(0, workerThreads);
+  _threads.reserve(static_cast<std::size_t>(count));
+  for (int i = 0; i < count; ++i)
+    _threads.emplace_back([this]() { workerLoop(); });
+}
+
+TrackerPool::~TrackerPool() {
+  _stopping.store(true, std::memory_order_release);
+  _generation.fetch_add(1, std::memory_order_acq_rel);
+  _generation.notify_all();
+  for (auto& thread : _threads) {
+    if (thread.joinable())
+      thread.join();
+  }
+}
+
+void TrackerPool::run(int jobCount, JobFn fn, void* ctx) {
+  if (_threads.empty() || jobCount <= 1) {
+    for (int i = 0; i < jobCount; ++i)
+      fn(ctx, i);
+    return;
+  }
+
+  matchCallerScheduling();
+
+  _fn = fn;
+  _ctx = ctx;
+  _jobCount = jobCount;
+  _nextJob.store(0, std::memory_order_relaxed);
+  _parked.store(0, std::memory_order_relaxed);
+  _generation.fetch_add(1, std::memory_order_release);
+  _generation.notify_all();
+
+  drainJobs();
+
+  // Barrier: every worker must have left drainJobs() before the job fields are
+  // reused by the next block.
+  const int expected = workerThreads();
+  int parked = _parked.load(std::memory_order_acquire);
+  int spins = 0;
+  while (parked < expected) {
+    if (spins < kBarrierSpinIterations) {
+      ++spins;
+      cpuRelax();
+    } else {
+      _parked.wait(parked, std::memory_order_acquire);
+    }
+    parked = _parked.load(std::memory_order_acquire);
+  }
+}
+
+void TrackerPool::drainJobs() {
+  for (int index = _nextJob.fetch_add(1, std::memory_order_acq_rel);
+       index < _jobCount;
+       index = _nextJob.fetch_add(1, std::memory_order_acq_rel)) {
+    _fn(_ctx, index);
+  }
+}
+
+void TrackerPool::workerLoop() {
+  // Workers start before the first run(), so generation 0 is never missed.
+  std::uint32_t seen = 0;
+  trace::prepareThread();
+  while (true) {
+    _generation.wait(seen, std::memory_order_acquire);
+    seen = _generation.load(std::memory_order_acquire);
+    if (_stopping.load(std::memory_order_acquire))
+      return;
+    drainJobs();
+    _parked.fetch_add(1, std::memory_order_acq_rel);
+    _parked.notify_one();
+  }
+}
+
+void TrackerPool::matchCallerScheduling() {
+  if (_schedulingMatched)
+    return;
+  _schedulingMatched = true;
+
+  int policy = SCHED_OTHER;
+  sched_param param {};
+  if (pthread_getschedparam(pthread_self(), &policy, &param) != 0 || policy == SCHED_OTHER)
+    return;
+
+  int failures = 0;
+  for (auto& thread : _threads) {
+    if (pthread_setschedparam(thread.native_handle(), policy, &param) != 0)
+      ++failures;
+  }
+  SessionLogger::instance().logf("tracker",
+                                 "pool workers=%d policy=%d priority=%d failures=%d",
+                                 workerThreads(),
+                                 policy,
+                                 param.sched_priority,
+                                 failures);
+}
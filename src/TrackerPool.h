@@ -0,0 +1,38 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads used by TabEngine to run the six string
+// trackers of a block in parallel. run() hands out job indices from a shared
+// counter, takes part in the work on the calling thread and returns only once
+// every job has finished and every worker has parked again (per-block barrier).
+// Nothing is allocated after construction.
+class TrackerPool {
+public:
+  using JobFn = void (*)(void* ctx, int index);
+
+  explicit TrackerPool(int workerThreads);
+  ~TrackerPool();
+  TrackerPool(const TrackerPool&) = delete;
+  TrackerPool& operator=(const TrackerPool&) = delete;
+
+  int workerThreads() const { return static_cast<int>(_threads.size()); }
+  void run(int jobCount, JobFn fn, void* ctx);
+
+private:
+  void workerLoop();
+  void drainJobs();
+  void matchCallerScheduling();
+
+  std::vector<std::thread> _threads;
+  JobFn _fn = nullptr;
+  void* _ctx = nullptr;
+  int _jobCount = 0;
+  bool _schedulingMatched = false;
+  alignas(64) std::atomic<int> _nextJob {0};
+  alignas(64) std::atomic<std::uint32_t> _generation {0};
+  alignas(64) std::atomic<int> _parked {0};
+  std::atomic<bool> _stopping {false};
+};
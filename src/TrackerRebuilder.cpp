@@ -0,0 +1,36 @@
+#include "TrackerRebuilder.h"
+#include "StringTracker.h"
+#include <utility>
+
+TrackerRebuilder::TrackerRebuilder(std::vector<StringTracker*> trackers)
+: _trackers(std::move(trackers))
+{
+  _thread = std::thread([this]() { workerLoop(); });
+}
+
+TrackerRebuilder::~TrackerRebuilder() {
+  _stopping.store(true, std::memory_order_release);
+  _requests.fetch_add(1, std::memory_order_acq_rel);
+  _requests.notify_one();
+  if (_thread.joinable())
+    _thread.join();
+}
+
+void TrackerRebuilder::wake() {
+  _requests.fetch_add(1, std::memory_order_release);
+  _requests.notify_one();
+}
+
+void TrackerRebuilder::workerLoop() {
+  // A wake() during a pass changes _requests, so the next wait returns at
+  // once and no request is missed.
+  std::uint32_t seen = 0;
+  while (true) {
+    _requests.wait(seen, std::memory_order_acquire);
+    seen = _requests.load(std::memory_order_acquire);
+    if (_stopping.load(std::memory_order_acquire))
+      return;
+    for (StringTracker* tracker : _trackers)
+      tracker->serviceRebuild();
+  }
+}
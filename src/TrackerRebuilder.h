@@ -0,0 +1,30 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+class StringTracker;
+
+// Background thread that builds replacement DSP state for TabEngine's string
+// trackers (filters, decimators, estimators, aubio objects) and deletes the
+// state they retire, so a parameter edit never allocates, frees or logs on
+// the audio thread. wake() is an atomic increment and a futex wake, safe to
+// call from the audio thread; the work itself runs at normal priority.
+class TrackerRebuilder {
+public:
+  explicit TrackerRebuilder(std::vector<StringTracker*> trackers);
+  ~TrackerRebuilder();
+  TrackerRebuilder(const TrackerRebuilder&) = delete;
+  TrackerRebuilder& operator=(const TrackerRebuilder&) = delete;
+
+  void wake();
+
+private:
+  void workerLoop();
+
+  std::vector<StringTracker*> _trackers;
+  std::atomic<std::uint32_t> _requests {0};
+  std::atomic<bool> _stopping {false};
+  std::thread _thread;
+};
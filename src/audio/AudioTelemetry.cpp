@@ -0,0 +1,147 @@
+#include "AudioTelemetry.h"
+
+#include "CarlaClient.h"
+#include "HexCaptureClient.h"
+#include "../SessionLogger.h"
+
+#include <QVariantMap>
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+constexpr int kPollIntervalMs = 250;
+constexpr std::size_t kFlightLogEntries = CallbackTelemetry::kMissRingSize;
+} // namespace
+
+AudioTelemetry::AudioTelemetry(QObject* parent)
+    : QObject(parent) {
+    m_timer.setTimerType(Qt::CoarseTimer);
+    m_timer.setInterval(kPollIntervalMs);
+    connect(&m_timer, &QTimer::timeout, this, &AudioTelemetry::poll);
+    m_headroomText = QStringLiteral("DSP —");
+}
+
+void AudioTelemetry::setHexClient(HexCaptureClient* client) {
+    m_hexClient = client;
+    m_hexMissSequence = 0;
+    m_hexEpoch = 0;
+    if (!m_timer.isActive())
+        m_timer.start();
+}
+
+void AudioTelemetry::setCarlaClient(CarlaClient* client) {
+    m_carlaClient = client;
+    m_carlaMissSequence = 0;
+    m_carlaEpoch = 0;
+    if (!m_timer.isActive())
+        m_timer.start();
+}
+
+void AudioTelemetry::collectMisses(const char* source,
+                                   const CallbackTelemetry::Snapshot& snapshot,
+                                   std::uint64_t& lastSequence) {
+    for (const CallbackTelemetry::Miss& miss : snapshot.recentMisses) {
+        SessionLogger::instance().logf("callback",
+                                       "over-budget %s #%llu dur=%uus budget=%uus frames=%u strings=%u",
+                                       source,
+                                       static_cast<unsigned long long>(miss.sequence),
+                                       miss.durationUs,
+                                       miss.budgetUs,
+                                       miss.frames,
+                                       miss.activeStrings);
+        m_flightLog.push_back(FlightEntry{source, miss});
+        if (m_flightLog.size() > kFlightLogEntries)
+            m_flightLog.pop_front();
+    }
+    lastSequence = std::max(lastSequence, snapshot.overBudget);
+}
+
+void AudioTelemetry::poll() {
+    int xruns = 0;
+    int overBudget = 0;
+    qreal jackLoad = -1.0;
+    float budget = 0.f;
+
+    if (m_hexClient) {
+        CallbackTelemetry& telemetry = m_hexClient->callbackTelemetry();
+        // A restarted client resets its counters; start the miss cursor over.
+        if (telemetry.epoch() != m_hexEpoch) {
+            m_hexEpoch = telemetry.epoch();
+            m_hexMissSequence = 0;
+        }
+        const CallbackTelemetry::Snapshot snapshot = telemetry.takeSnapshot(m_hexMissSequence);
+        m_hexLoad = static_cast<qreal>(snapshot.averageLoad) * 100.0;
+        m_hexPeakLoad = static_cast<qreal>(snapshot.peakLoad) * 100.0;
+        m_hexMaxUs = static_cast<int>(snapshot.maxUs);
+        m_hexHistogram.clear();
+        for (const std::uint64_t count : snapshot.histogram)
+            m_hexHistogram.push_back(static_cast<qulonglong>(count));
+        collectMisses("hex", snapshot, m_hexMissSequence);
+        overBudget += static_cast<int>(snapshot.overBudget);
+        xruns = std::max(xruns, m_hexClient->xruns());
+        jackLoad = m_hexClient->jackCpuLoad();
+        budget = telemetry.budgetFraction();
+    }
+
+    if (m_carlaClient) {
+        CallbackTelemetry& telemetry = m_carlaClient->callbackTelemetry();
+        if (telemetry.epoch() != m_carlaEpoch) {
+            m_carlaEpoch = telemetry.epoch();
+            m_carlaMissSequence = 0;
+        }
+        const CallbackTelemetry::Snapshot snapshot = telemetry.takeSnapshot(m_carlaMissSequence);
+        m_carlaLoad = static_cast<qreal>(snapshot.averageLoad) * 100.0;
+        m_carlaPeakLoad = static_cast<qreal>(snapshot.peakLoad) * 100.0;
+        collectMisses("carla", snapshot, m_carlaMissSequence);
+        overBudget += static_cast<int>(snapshot.overBudget);
+        xruns = std::max(xruns, m_carlaClient->xruns());
+        if (jackLoad < 0.0)
+            jackLoad = m_carlaClient->jackCpuLoad();
+        if (budget <= 0.f)
+            budget = telemetry.budgetFraction();
+    }
+
+    m_xruns = xruns;
+    m_overBudgetCount = overBudget;
+    m_jackCpuLoad = jackLoad;
+    m_budgetPercent = static_cast<int>(budget * 100.f + 0.5f);
+    const qreal used = std::max(jackLoad, m_hexLoad + m_carlaLoad);
+    m_headroom = std::clamp(100.0 - used, 0.0, 100.0);
+
+    if (!m_hexClient && !m_carlaClient) {
+        m_headroomText = QStringLiteral("DSP —");
+    } else {
+        QString text = QStringLiteral("DSP %1% (peak %2%)")
+                           .arg(m_hexLoad + m_carlaLoad, 0, 'f', 0)
+                           .arg(std::max(m_hexPeakLoad, m_carlaPeakLoad), 0, 'f', 0);
+        if (jackLoad >= 0.0)
+            text += QStringLiteral(" · JACK %1%").arg(jackLoad, 0, 'f', 0);
+        text += QStringLiteral(" · headroom %1%").arg(m_headroom, 0, 'f', 0);
+        if (xruns > 0)
+            text += QStringLiteral(" · %1 xruns").arg(xruns);
+        m_headroomText = text;
+    }
+    emit changed();
+}
+
+QVariantList AudioTelemetry::recentMisses() const {
+    const auto nowUs = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                                      std::chrono::steady_clock::now().time_since_epoch())
+                                                      .count());
+    QVariantList list;
+    list.reserve(static_cast<qsizetype>(m_flightLog.size()));
+    for (auto it = m_flightLog.rbegin(); it != m_flightLog.rend(); ++it) {
+        const CallbackTelemetry::Miss& miss = it->miss;
+        QVariantMap entry;
+        entry.insert(QStringLiteral("source"), QString::fromLatin1(it->source));
+        entry.insert(QStringLiteral("durationUs"), miss.durationUs);
+        entry.insert(QStringLiteral("budgetUs"), miss.budgetUs);
+        entry.insert(QStringLiteral("frames"), miss.frames);
+        entry.insert(QStringLiteral("activeStrings"), miss.activeStrings);
+        entry.insert(QStringLiteral("ageSec"),
+                     nowUs > miss.timestampUs ? static_cast<double>(nowUs - miss.timestampUs) / 1.0e6 : 0.0);
+        list.push_back(entry);
+    }
+    return list;
+}
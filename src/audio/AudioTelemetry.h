@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CallbackTelemetry.h"
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <QVariantList>
+
+#include <cstdint>
+#include <deque>
+
+class CarlaClient;
+class HexCaptureClient;
+
+// QML-facing view of the realtime callback telemetry. Polls the hex and Carla
+// clients a few times per second, converts their CallbackTelemetry snapshots
+// into bindable properties and writes every new over-budget callback to the
+// session log (the deadline-miss flight log).
+class AudioTelemetry : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(qreal hexLoad READ hexLoad NOTIFY changed)
+    Q_PROPERTY(qreal hexPeakLoad READ hexPeakLoad NOTIFY changed)
+    Q_PROPERTY(int hexMaxCallbackUs READ hexMaxCallbackUs NOTIFY changed)
+    Q_PROPERTY(qreal carlaLoad READ carlaLoad NOTIFY changed)
+    Q_PROPERTY(qreal carlaPeakLoad READ carlaPeakLoad NOTIFY changed)
+    Q_PROPERTY(qreal jackCpuLoad READ jackCpuLoad NOTIFY changed)
+    Q_PROPERTY(qreal headroom READ headroom NOTIFY changed)
+    Q_PROPERTY(int xruns READ xruns NOTIFY changed)
+    Q_PROPERTY(int overBudgetCount READ overBudgetCount NOTIFY changed)
+    Q_PROPERTY(int budgetPercent READ budgetPercent NOTIFY changed)
+    Q_PROPERTY(QString headroomText READ headroomText NOTIFY changed)
+    Q_PROPERTY(QVariantList hexHistogram READ hexHistogram NOTIFY changed)
+    Q_PROPERTY(QVariantList recentMisses READ recentMisses NOTIFY changed)
+public:
+    explicit AudioTelemetry(QObject* parent=nullptr);
+
+    void setHexClient(HexCaptureClient* client);
+    void setCarlaClient(CarlaClient* client);
+
+    // Loads and headroom are percentages of the JACK period.
+    qreal hexLoad() const { return m_hexLoad; }
+    qreal hexPeakLoad() const { return m_hexPeakLoad; }
+    int hexMaxCallbackUs() const { return m_hexMaxUs; }
+    qreal carlaLoad() const { return m_carlaLoad; }
+    qreal carlaPeakLoad() const { return m_carlaPeakLoad; }
+    qreal jackCpuLoad() const { return m_jackCpuLoad; }   // -1 when no client is connected
+    qreal headroom() const { return m_headroom; }
+    int xruns() const { return m_xruns; }
+    int overBudgetCount() const { return m_overBudgetCount; }
+    int budgetPercent() const { return m_budgetPercent; }
+    QString headroomText() const { return m_headroomText; }
+    QVariantList hexHistogram() const { return m_hexHistogram; }
+    QVariantList recentMisses() const;
+
+signals:
+    void changed();
+
+private:
+    struct FlightEntry {
+        const char* source {""};
+        CallbackTelemetry::Miss miss;
+    };
+
+    void poll();
+    void collectMisses(const char* source, const CallbackTelemetry::Snapshot& snapshot, std::uint64_t& lastSequence);
+
+    QTimer m_timer;
+    QPointer<HexCaptureClient> m_hexClient;
+    QPointer<CarlaClient> m_carlaClient;
+    std::uint64_t m_hexMissSequence {0};
+    std::uint64_t m_carlaMissSequence {0};
+    std::uint32_t m_hexEpoch {0};
+    std::uint32_t m_carlaEpoch {0};
+    std::deque<FlightEntry> m_flightLog;
+
+    qreal m_hexLoad {0.0};
+    qreal m_hexPeakLoad {0.0};
+    int m_hexMaxUs {0};
+    qreal m_carlaLoad {0.0};
+    qreal m_carlaPeakLoad {0.0};
+    qreal m_jackCpuLoad {-1.0};
+    qreal m_headroom {100.0};
+    int m_xruns {0};
+    int m_overBudgetCount {0};
+    int m_budgetPercent {0};
+    QString m_headroomText;
+    QVariantList m_hexHistogram;
+};
@@ -0,0 +1,145 @@
+#include "CallbackTelemetry.h"
+
+#include "../SessionLogger.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+
+namespace {
+constexpr float kLoadSmoothing = 0.05f;
+constexpr int kDefaultBudgetPercent = 50;
+
+int histogramBucket(std::uint32_t micros) {
+    if (micros == 0)
+        return 0;
+    const int bucket = std::bit_width(micros);
+    return std::min(bucket, CallbackTelemetry::kHistogramBuckets - 1);
+}
+} // namespace
+
+CallbackTelemetry::CallbackTelemetry() {
+    reset(0.5f);
+}
+
+void CallbackTelemetry::reset(float budgetFraction) {
+    for (auto& bucket : m_histogram)
+        bucket.store(0, std::memory_order_relaxed);
+    for (auto& slot : m_misses)
+        slot.sequence.store(0, std::memory_order_relaxed);
+    m_callbacks.store(0, std::memory_order_relaxed);
+    m_overBudget.store(0, std::memory_order_relaxed);
+    m_maxUs.store(0, std::memory_order_relaxed);
+    m_lastUs.store(0, std::memory_order_relaxed);
+    m_averageLoad.store(0.f, std::memory_order_relaxed);
+    m_peakLoad.store(0.f, std::memory_order_relaxed);
+    m_budgetFraction.store(std::clamp(budgetFraction, 0.05f, 1.0f), std::memory_order_relaxed);
+    m_epoch.fetch_add(1, std::memory_order_release);
+}
+
+float CallbackTelemetry::budgetFractionFromEnvironment() {
+    int percent = kDefaultBudgetPercent;
+    if (qEnvironmentVariableIsSet("GUITARPI_CALLBACK_BUDGET_PCT"))
+        percent = qEnvironmentVariableIntValue("GUITARPI_CALLBACK_BUDGET_PCT");
+    return static_cast<float>(std::clamp(percent, 5, 100)) / 100.f;
+}
+
+void CallbackTelemetry::record(std::chrono::steady_clock::time_point start,
+                               std::chrono::steady_clock::time_point end,
+                               std::uint32_t frames,
+                               std::uint32_t sampleRate,
+                               std::uint32_t activeStrings) noexcept {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    const std::uint32_t micros = static_cast<std::uint32_t>(std::max<long long>(0, elapsed));
+
+    auto& bucket = m_histogram[static_cast<std::size_t>(histogramBucket(micros))];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    m_callbacks.store(m_callbacks.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    m_lastUs.store(micros, std::memory_order_relaxed);
+    if (micros > m_maxUs.load(std::memory_order_relaxed))
+        m_maxUs.store(micros, std::memory_order_relaxed);
+
+    if (frames == 0 || sampleRate == 0)
+        return;
+
+    const double periodUs = static_cast<double>(frames) * 1.0e6 / static_cast<double>(sampleRate);
+    const float load = static_cast<float>(static_cast<double>(micros) / periodUs);
+    const float average = m_averageLoad.load(std::memory_order_relaxed);
+    m_averageLoad.store(average + kLoadSmoothing * (load - average), std::memory_order_relaxed);
+    if (load > m_peakLoad.load(std::memory_order_relaxed))
+        m_peakLoad.store(load, std::memory_order_relaxed);
+
+    const std::uint32_t budgetUs = static_cast<std::uint32_t>(periodUs * m_budgetFraction.load(std::memory_order_relaxed));
+    if (micros <= budgetUs)
+        return;
+
+    // Per-slot seqlock: readers discard a slot whose sequence changed under them.
+    const std::uint64_t sequence = m_overBudget.load(std::memory_order_relaxed) + 1;
+    MissSlot& slot = m_misses[static_cast<std::size_t>((sequence - 1) % kMissRingSize)];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timestampUs.store(static_cast<std::uint64_t>(
+                               std::chrono::duration_cast<std::chrono::microseconds>(start.time_since_epoch()).count()),
+                           std::memory_order_relaxed);
+    slot.durationUs.store(micros, std::memory_order_relaxed);
+    slot.budgetUs.store(budgetUs, std::memory_order_relaxed);
+    slot.frames.store(frames, std::memory_order_relaxed);
+    slot.activeStrings.store(activeStrings, std::memory_order_relaxed);
+    slot.sequence.store(sequence, std::memory_order_release);
+    m_overBudget.store(sequence, std::memory_order_release);
+}
+
+CallbackTelemetry::Snapshot CallbackTelemetry::takeSnapshot(std::uint64_t sinceSequence) {
+    Snapshot snapshot;
+    snapshot.callbacks = m_callbacks.load(std::memory_order_acquire);
+    snapshot.overBudget = m_overBudget.load(std::memory_order_acquire);
+    snapshot.maxUs = m_maxUs.load(std::memory_order_relaxed);
+    snapshot.lastUs = m_lastUs.load(std::memory_order_relaxed);
+    snapshot.averageLoad = m_averageLoad.load(std::memory_order_relaxed);
+    snapshot.peakLoad = m_peakLoad.exchange(0.f, std::memory_order_relaxed);
+    for (int b = 0; b < kHistogramBuckets; ++b)
+        snapshot.histogram[static_cast<std::size_t>(b)] = m_histogram[static_cast<std::size_t>(b)].load(std::memory_order_relaxed);
+
+    const std::uint64_t total = snapshot.overBudget;
+    std::uint64_t first = total > kMissRingSize ? total - kMissRingSize + 1 : 1;
+    first = std::max(first, sinceSequence + 1);
+    for (std::uint64_t sequence = first; sequence <= total; ++sequence) {
+        const MissSlot& slot = m_misses[static_cast<std::size_t>((sequence - 1) % kMissRingSize)];
+        if (slot.sequence.load(std::memory_order_acquire) != sequence)
+            continue;
+        Miss miss;
+        miss.sequence = sequence;
+        miss.timestampUs = slot.timestampUs.load(std::memory_order_relaxed);
+        miss.durationUs = slot.durationUs.load(std::memory_order_relaxed);
+        miss.budgetUs = slot.budgetUs.load(std::memory_order_relaxed);
+        miss.frames = slot.frames.load(std::memory_order_relaxed);
+        miss.activeStrings = slot.activeStrings.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+            continue;
+        snapshot.recentMisses.push_back(miss);
+    }
+    return snapshot;
+}
+
+void CallbackTelemetry::logSummary(const char* source) const {
+    char histogram[256];
+    int used = 0;
+    for (int b = 0; b < kHistogramBuckets && used < static_cast<int>(sizeof(histogram)); ++b) {
+        used += std::snprintf(histogram + used,
+                              sizeof(histogram) - static_cast<std::size_t>(used),
+                              b == 0 ? "%llu" : ",%llu",
+                              static_cast<unsigned long long>(m_histogram[static_cast<std::size_t>(b)].load(std::memory_order_relaxed)));
+    }
+    SessionLogger::instance().logf("callback",
+                                   "%s callbacks=%llu overBudget=%llu max=%uus avgLoad=%.1f%% budget=%.0f%% log2us=[%s]",
+                                   source,
+                                   static_cast<unsigned long long>(m_callbacks.load(std::memory_order_relaxed)),
+                                   static_cast<unsigned long long>(m_overBudget.load(std::memory_order_relaxed)),
+                                   m_maxUs.load(std::memory_order_relaxed),
+                                   static_cast<double>(m_averageLoad.load(std::memory_order_relaxed) * 100.f),
+                                   static_cast<double>(m_budgetFraction.load(std::memory_order_relaxed) * 100.f),
+                                   histogram);
+}
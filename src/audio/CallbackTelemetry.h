@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Per-client process-callback timing. The JACK thread records one sample per
+// callback (wall time, period length, active strings) into relaxed atomics: a
+// log2 microsecond histogram, a smoothed/peak DSP load against the period and a
+// fixed ring of the most recent over-budget callbacks. Nothing allocates or
+// locks on the record path; readers take snapshots from the GUI thread.
+class CallbackTelemetry {
+public:
+    // Bucket 0 counts callbacks under 1 us, bucket b >= 1 counts [2^(b-1), 2^b) us
+    // and the last bucket is open-ended (>= 32.8 ms).
+    static constexpr int kHistogramBuckets = 17;
+    static constexpr std::size_t kMissRingSize = 32;
+
+    struct Miss {
+        std::uint64_t sequence {0};      // 1-based over-budget index
+        std::uint64_t timestampUs {0};   // steady_clock, callback start
+        std::uint32_t durationUs {0};
+        std::uint32_t budgetUs {0};
+        std::uint32_t frames {0};
+        std::uint32_t activeStrings {0};
+    };
+
+    struct Snapshot {
+        std::uint64_t callbacks {0};
+        std::uint64_t overBudget {0};
+        std::uint32_t maxUs {0};
+        std::uint32_t lastUs {0};
+        float averageLoad {0.f};         // 0..1 of the period, smoothed
+        float peakLoad {0.f};            // 0..1, maximum since the previous takeSnapshot()
+        std::array<std::uint64_t, kHistogramBuckets> histogram {};
+        std::vector<Miss> recentMisses;  // oldest first
+    };
+
+    class Scope {
+    public:
+        Scope(CallbackTelemetry& telemetry, std::uint32_t frames, std::uint32_t sampleRate) noexcept
+            : m_telemetry(telemetry)
+            , m_frames(frames)
+            , m_sampleRate(sampleRate)
+            , m_start(std::chrono::steady_clock::now()) {}
+        ~Scope() { m_telemetry.record(m_start, std::chrono::steady_clock::now(), m_frames, m_sampleRate, m_activeStrings); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        void setActiveStrings(int count) noexcept { m_activeStrings = count > 0 ? static_cast<std::uint32_t>(count) : 0u; }
+
+    private:
+        CallbackTelemetry& m_telemetry;
+        std::uint32_t m_frames;
+        std::uint32_t m_sampleRate;
+        std::uint32_t m_activeStrings {0};
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    CallbackTelemetry();
+
+    // Not RT-safe with respect to concurrent record(); call while the client is stopped.
+    void reset(float budgetFraction);
+    [[nodiscard]] float budgetFraction() const noexcept { return m_budgetFraction.load(std::memory_order_relaxed); }
+    // Bumped by every reset(), so readers can tell a restarted client apart.
+    [[nodiscard]] std::uint32_t epoch() const noexcept { return m_epoch.load(std::memory_order_acquire); }
+
+    // RT-safe, single writer.
+    void record(std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end,
+                std::uint32_t frames,
+                std::uint32_t sampleRate,
+                std::uint32_t activeStrings) noexcept;
+
+    // GUI thread. Consumes the windowed peak load; misses with a sequence at or
+    // below sinceSequence are left out of recentMisses.
+    [[nodiscard]] Snapshot takeSnapshot(std::uint64_t sinceSequence = 0);
+
+    void logSummary(const char* source) const;
+
+    // GUITARPI_CALLBACK_BUDGET_PCT, default 50% of the period.
+    static float budgetFractionFromEnvironment();
+
+private:
+    struct MissSlot {
+        std::atomic<std::uint64_t> sequence {0};
+        std::atomic<std::uint64_t> timestampUs {0};
+        std::atomic<std::uint32_t> durationUs {0};
+        std::atomic<std::uint32_t> budgetUs {0};
+        std::atomic<std::uint32_t> frames {0};
+        std::atomic<std::uint32_t> activeStrings {0};
+    };
+
+    std::array<std::atomic<std::uint64_t>, kHistogramBuckets> m_histogram {};
+    std::array<MissSlot, kMissRingSize> m_misses {};
+    std::atomic<std::uint64_t> m_callbacks {0};
+    std::atomic<std::uint64_t> m_overBudget {0};
+    std::atomic<std::uint32_t> m_maxUs {0};
+    std::atomic<std::uint32_t> m_lastUs {0};
+    std::atomic<float> m_averageLoad {0.f};
+    std::atomic<float> m_peakLoad {0.f};
+    std::atomic<float> m_budgetFraction {0.5f};
+    std::atomic<std::uint32_t> m_epoch {0};
+};
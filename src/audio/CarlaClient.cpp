@@ -1,4 +1,5 @@
 #include "CarlaClient.h"
+#include "../RtCheck.h"
 
 #include <QMetaObject>
 #include <QTimer>
@@ -110,6 +111,8 @@ bool CarlaClient::start() {
         requestJackBufferSize(requestedFrames);
     }
 
+    m_callbackTelemetry.reset(CallbackTelemetry::budgetFractionFromEnvironment());
+
     if (jack_activate(m_client) != 0) {
         qWarning("CarlaClient: failed to activate JACK client");
         stop();
@@ -147,6 +150,7 @@ void CarlaClient::stop() {
         jack_client_t* client = m_client;
         m_client = nullptr;
         jack_client_close(client);
+        m_callbackTelemetry.logSummary("carla");
     }
 
     m_inputL = nullptr;
@@ -322,6 +326,10 @@ bool CarlaClient::launchJackServer(const QString& command) const {
 
 int CarlaClient::processCallback(jack_nframes_t nframes, void* arg) {
     auto* self = static_cast<CarlaClient*>(arg);
+    GUITARPI_RT_SCOPE("CarlaClient::processCallback");
+    CallbackTelemetry::Scope timing(self->m_callbackTelemetry,
+                                    nframes,
+                                    static_cast<std::uint32_t>(self->m_currentSampleRate.load(std::memory_order_relaxed)));
 
     const auto* inL = static_cast<const jack_default_audio_sample_t*>(jack_port_get_buffer(self->m_inputL, nframes));
     const auto* inR = static_cast<const jack_default_audio_sample_t*>(jack_port_get_buffer(self->m_inputR, nframes));
@@ -378,6 +386,10 @@ void CarlaClient::emitMeters() {
     emit metersSnapshot(m_inMeterL.load(), m_inMeterR.load(), m_outMeterL.load(), m_outMeterR.load());
 }
 
+qreal CarlaClient::jackCpuLoad() const {
+    return m_client ? static_cast<qreal>(jack_cpu_load(m_client)) : -1.0;
+}
+
 void CarlaClient::handleClientShutdown() {
     stop();
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "AudioEngine.h"
+#include "CallbackTelemetry.h"
 #include <QObject>
 #include <atomic>
 #include <memory>
@@ -28,6 +29,9 @@ public:
 
     int bufferSize() const { return m_currentBufferSize.load(); }
     int sampleRate() const { return m_currentSampleRate.load(); }
+    CallbackTelemetry& callbackTelemetry() noexcept { return m_callbackTelemetry; }
+    int xruns() const { return m_xruns.load(std::memory_order_relaxed); }
+    qreal jackCpuLoad() const;                  // percent, -1 while disconnected
 
 signals:
     void xrunsChanged(int count);
@@ -74,6 +78,7 @@ private:
     std::atomic<int> m_pendingBufferSize {0};
     std::atomic<int> m_pendingSampleRate {0};
     std::atomic<int> m_xruns {0};
+    CallbackTelemetry m_callbackTelemetry;
 
     std::atomic<float> m_inMeterL {0.0f};
     std::atomic<float> m_inMeterR {0.0f};
@@ -0,0 +1,176 @@
+#include "HexAnalysisWorker.h"
+
+#include "../TabEngineBridge.h"
+#include "../SessionLogger.h"
+#include "../TraceRing.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace {
+constexpr std::size_t kQueueBlocks = 64;
+constexpr int kBlockFrames = 1024;
+} // namespace
+
+HexAnalysisWorker::HexAnalysisWorker() {
+    sem_init(&m_wake, 0, 0);
+}
+
+HexAnalysisWorker::~HexAnalysisWorker() {
+    stop();
+    sem_destroy(&m_wake);
+}
+
+bool HexAnalysisWorker::start(int rtPriority) {
+    if (m_running.load(std::memory_order_acquire))
+        return true;
+
+    m_queue.reset(kQueueBlocks, kBlockFrames);
+    m_highWater.store(0, std::memory_order_relaxed);
+    m_processed.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_gapFrames = 0;
+    while (sem_trywait(&m_wake) == 0) {}
+
+    m_stopRequested.store(false, std::memory_order_release);
+    m_running.store(true, std::memory_order_release);
+    try {
+        m_thread = std::thread([this]() { run(); });
+    } catch (const std::system_error& error) {
+        m_running.store(false, std::memory_order_release);
+        qWarning() << "HexAnalysisWorker" << "thread-start-failed" << error.what();
+        SessionLogger::instance().logf("analysis", "worker thread failed to start (%s)", error.what());
+        return false;
+    }
+    applySchedulingPolicy(rtPriority);
+    return true;
+}
+
+void HexAnalysisWorker::stop() {
+    if (!m_thread.joinable())
+        return;
+    m_stopRequested.store(true, std::memory_order_release);
+    sem_post(&m_wake);
+    m_thread.join();
+    m_running.store(false, std::memory_order_release);
+
+    const Stats snapshot = stats();
+    SessionLogger::instance().logf("analysis",
+                                   "worker stopped processed=%llu dropped=%llu highWater=%zu/%zu",
+                                   static_cast<unsigned long long>(snapshot.processed),
+                                   static_cast<unsigned long long>(snapshot.dropped),
+                                   snapshot.highWater,
+                                   snapshot.capacity);
+}
+
+void HexAnalysisWorker::applySchedulingPolicy(int rtPriority) {
+    if (rtPriority <= 0)
+        return;
+
+    const int maxPriority = sched_get_priority_max(SCHED_FIFO);
+    const int minPriority = sched_get_priority_min(SCHED_FIFO);
+    sched_param param {};
+    param.sched_priority = std::clamp(rtPriority, minPriority, maxPriority);
+    const int rc = pthread_setschedparam(m_thread.native_handle(), SCHED_FIFO, &param);
+    if (rc != 0) {
+        qWarning() << "HexAnalysisWorker" << "sched-fifo-failed" << param.sched_priority << std::strerror(rc);
+        SessionLogger::instance().logf("analysis", "SCHED_FIFO %d unavailable (%s); running at normal priority",
+                                       param.sched_priority, std::strerror(rc));
+        return;
+    }
+    qInfo() << "HexAnalysisWorker" << "sched-fifo" << param.sched_priority;
+    SessionLogger::instance().logf("analysis", "worker running SCHED_FIFO priority=%d", param.sched_priority);
+}
+
+bool HexAnalysisWorker::push(const float* const channels[6], int frames, float sampleRate,
+                             const HexBlockStats* stats) noexcept {
+    if (!m_running.load(std::memory_order_acquire) || frames <= 0)
+        return false;
+
+    bool queued = false;
+    const int chunkFrames = m_queue.maxFrames();
+    for (int offset = 0; offset < frames; offset += chunkFrames) {
+        HexBlockQueue::Block* block = m_queue.beginWrite();
+        if (!block) {
+            // Queuing later chunks of this period would splice them onto the
+            // audio before the hole; drop them as well.
+            const int remaining = frames - offset;
+            m_dropped.fetch_add(static_cast<std::uint64_t>((remaining + chunkFrames - 1) / chunkFrames),
+                                std::memory_order_relaxed);
+            m_gapFrames += static_cast<std::uint64_t>(remaining);
+            break;
+        }
+        const int count = std::min(chunkFrames, frames - offset);
+        block->frames = count;
+        block->sampleRate = sampleRate;
+        block->gapFrames = m_gapFrames;
+        m_gapFrames = 0;
+        block->hasStats = (stats != nullptr && count == frames);
+        if (block->hasStats)
+            block->stats = *stats;
+        for (int s = 0; s < HexBlockQueue::kChannels; ++s) {
+            const float* src = channels[s];
+            const std::size_t slot = static_cast<std::size_t>(s);
+            block->present[slot] = (src != nullptr);
+            if (src)
+                std::memcpy(block->samples[slot], src + offset, static_cast<std::size_t>(count) * sizeof(float));
+        }
+        m_queue.commitWrite();
+        queued = true;
+    }
+
+    if (!queued)
+        return false;
+
+    const std::size_t depth = m_queue.size();
+    std::size_t high = m_highWater.load(std::memory_order_relaxed);
+    while (depth > high && !m_highWater.compare_exchange_weak(high, depth, std::memory_order_relaxed)) {}
+
+    sem_post(&m_wake);
+    return true;
+}
+
+HexAnalysisWorker::Stats HexAnalysisWorker::stats() const noexcept {
+    Stats snapshot;
+    snapshot.depth = m_queue.size();
+    snapshot.highWater = m_highWater.load(std::memory_order_relaxed);
+    snapshot.capacity = m_queue.capacity();
+    snapshot.processed = m_processed.load(std::memory_order_relaxed);
+    snapshot.dropped = m_dropped.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void HexAnalysisWorker::run() {
+    std::array<const float*, 6> channels {};
+    trace::prepareThread();
+    while (true) {
+        while (sem_wait(&m_wake) != 0 && errno == EINTR) {}
+
+        while (const HexBlockQueue::Block* block = m_queue.front()) {
+            TabEngineBridge* bridge = m_bridge.load(std::memory_order_acquire);
+            if (bridge) {
+                for (int s = 0; s < HexBlockQueue::kChannels; ++s) {
+                    const std::size_t slot = static_cast<std::size_t>(s);
+                    channels[slot] = block->present[slot] ? block->samples[slot] : nullptr;
+                }
+                bridge->processLiveAudioBlock(channels.data(),
+                                              block->frames,
+                                              block->sampleRate,
+                                              block->hasStats ? &block->stats : nullptr,
+                                              block->gapFrames);
+            }
+            m_queue.popFront();
+            m_processed.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (m_stopRequested.load(std::memory_order_acquire))
+            break;
+    }
+}
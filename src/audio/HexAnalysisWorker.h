@@ -0,0 +1,63 @@
+#pragma once
+
+#include "HexBlockQueue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include <semaphore.h>
+
+class TabEngineBridge;
+
+// Runs TabEngine analysis on a dedicated SCHED_FIFO thread that sits below the
+// JACK process thread. The capture callback copies calibrated samples into the
+// block queue via push() and returns; the worker drains the queue and feeds
+// TabEngineBridge::processLiveAudioBlock.
+class HexAnalysisWorker {
+public:
+    struct Stats {
+        std::size_t depth {0};
+        std::size_t highWater {0};
+        std::size_t capacity {0};
+        std::uint64_t processed {0};
+        std::uint64_t dropped {0};
+    };
+
+    HexAnalysisWorker();
+    ~HexAnalysisWorker();
+
+    HexAnalysisWorker(const HexAnalysisWorker&) = delete;
+    HexAnalysisWorker& operator=(const HexAnalysisWorker&) = delete;
+
+    bool start(int rtPriority);
+    void stop();
+    [[nodiscard]] bool running() const noexcept { return m_running.load(std::memory_order_acquire); }
+
+    void setBridge(TabEngineBridge* bridge) noexcept { m_bridge.store(bridge, std::memory_order_release); }
+
+    // RT-safe. Returns false (and counts a drop) when the queue is full; the
+    // rest of that period is dropped with it and the next queued block carries
+    // the gap, so analysis time keeps following the capture clock.
+    // stats are forwarded with the block when it fits in a single queue slot.
+    bool push(const float* const channels[6], int frames, float sampleRate,
+              const HexBlockStats* stats = nullptr) noexcept;
+
+    [[nodiscard]] Stats stats() const noexcept;
+
+private:
+    void run();
+    void applySchedulingPolicy(int rtPriority);
+
+    HexBlockQueue m_queue;
+    std::atomic<TabEngineBridge*> m_bridge {nullptr};
+    std::atomic<bool> m_running {false};
+    std::atomic<bool> m_stopRequested {false};
+    std::atomic<std::size_t> m_highWater {0};
+    std::atomic<std::uint64_t> m_processed {0};
+    std::atomic<std::uint64_t> m_dropped {0};
+    std::uint64_t m_gapFrames {0};   // producer only: dropped since the last queued block
+    sem_t m_wake {};
+    std::thread m_thread;
+};
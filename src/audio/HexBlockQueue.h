@@ -0,0 +1,90 @@
+#pragma once
+
+#include "../HexBlockKernel.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Single-producer/single-consumer ring of fixed-size six-channel blocks. All
+// storage is allocated in reset(); beginWrite/commitWrite/front/popFront never
+// allocate or lock, so the producer side is safe to call from the JACK thread.
+class HexBlockQueue {
+public:
+    static constexpr int kChannels = 6;
+
+    struct Block {
+        int frames {0};
+        float sampleRate {0.f};
+        std::uint64_t gapFrames {0};   // frames dropped just before this block
+        std::array<bool, kChannels> present {};
+        std::array<float*, kChannels> samples {};
+        HexBlockStats stats {};
+        bool hasStats {false};
+    };
+
+    void reset(std::size_t capacity, int maxFrames) {
+        std::size_t slotCount = 2;
+        while (slotCount < capacity)
+            slotCount <<= 1;
+        m_maxFrames = maxFrames > 0 ? maxFrames : 1;
+        m_storage.assign(slotCount * kChannels * static_cast<std::size_t>(m_maxFrames), 0.f);
+        m_blocks.assign(slotCount, Block{});
+        for (std::size_t i = 0; i < slotCount; ++i) {
+            for (int c = 0; c < kChannels; ++c) {
+                const std::size_t offset = (i * kChannels + static_cast<std::size_t>(c)) * static_cast<std::size_t>(m_maxFrames);
+                m_blocks[i].samples[static_cast<std::size_t>(c)] = m_storage.data() + offset;
+            }
+        }
+        m_mask = slotCount - 1;
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] int maxFrames() const noexcept { return m_maxFrames; }
+    [[nodiscard]] std::size_t capacity() const noexcept { return m_blocks.size(); }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        const std::size_t head = m_head.load(std::memory_order_acquire);
+        const std::size_t tail = m_tail.load(std::memory_order_acquire);
+        return head - tail;
+    }
+
+    // Producer: returns nullptr when the ring is full.
+    Block* beginWrite() noexcept {
+        if (m_blocks.empty())
+            return nullptr;
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        const std::size_t tail = m_tail.load(std::memory_order_acquire);
+        if (head - tail >= m_blocks.size())
+            return nullptr;
+        return &m_blocks[head & m_mask];
+    }
+
+    void commitWrite() noexcept {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer: returns nullptr when the ring is empty.
+    const Block* front() const noexcept {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        const std::size_t head = m_head.load(std::memory_order_acquire);
+        if (head == tail)
+            return nullptr;
+        return &m_blocks[tail & m_mask];
+    }
+
+    void popFront() noexcept {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    std::vector<float> m_storage;
+    std::vector<Block> m_blocks;
+    std::size_t m_mask {0};
+    int m_maxFrames {0};
+    alignas(64) std::atomic<std::size_t> m_head {0};
+    alignas(64) std::atomic<std::size_t> m_tail {0};
+};
@@ -0,0 +1,360 @@
+#include "HexCaptureClient.h"
+#include "../HexBlockKernel.h"
+#include "../TabEngineBridge.h"
+#include "../SessionLogger.h"
+
+#include <QMetaObject>
+#include <QTimer>
+#include <QDebug>
+#include <QStringList>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+constexpr float kCalibrationCaptureSecPerString = 1.25f;
+constexpr float kCalibrationTriggerLevel = 0.008f;
+constexpr int kAnalysisPriorityBelowCapture = 10;
+constexpr int kFallbackAnalysisPriority = 60;
+// Strings at or above this calibrated RMS count as active in callback telemetry.
+constexpr float kActiveStringRms = kCalibrationTriggerLevel;
+// Calibrated and monitor buffers are sized for this period up front so the
+// callback never allocates for any realistic buffer size.
+constexpr std::size_t kMaxCallbackFrames = 4096;
+
+} // namespace
+
+class HexCaptureClient::MeterPump {
+public:
+    explicit MeterPump(HexCaptureClient* owner) : m_owner(owner) {
+        m_timer = std::make_unique<QTimer>();
+        m_timer->setTimerType(Qt::CoarseTimer);
+        m_timer->setInterval(40);
+        QObject::connect(m_timer.get(), &QTimer::timeout, owner, [owner]() { owner->emitMeters(); });
+        m_timer->start();
+    }
+
+private:
+    HexCaptureClient* m_owner;
+    std::unique_ptr<QTimer> m_timer;
+};
+
+HexCaptureClient::HexCaptureClient(QObject* parent)
+    : AudioEngine(parent) {
+    qRegisterMetaType<std::array<float, 6>>("FloatMeterArray");
+    for (auto& meter : m_detectionMeters)
+        meter.store(0.0f);
+    for (auto& buffer : m_calibratedBuffers)
+        buffer.assign(kMaxCallbackFrames, 0.0f);
+    m_monitorMixBuffer.assign(kMaxCallbackFrames * 2, 0.0f);
+    m_meterLoggingEnabled = qEnvironmentVariableIntValue("GUITARPI_HEX_METER_LOGS") > 0;
+}
+
+HexCaptureClient::~HexCaptureClient() = default;
+
+int HexCaptureClient::analysisPriorityBelow(int callbackPriority) {
+    int analysisPriority = (callbackPriority > 0) ? callbackPriority - kAnalysisPriorityBelowCapture : kFallbackAnalysisPriority;
+    if (qEnvironmentVariableIsSet("GUITARPI_ANALYSIS_PRIORITY"))
+        analysisPriority = qEnvironmentVariableIntValue("GUITARPI_ANALYSIS_PRIORITY");
+    return std::max(1, analysisPriority);
+}
+
+void HexCaptureClient::beginCapture(int analysisPriority) {
+    m_reportedAnalysisDrops = 0;
+    // The first tracker configuration is built here rather than on the
+    // analysis worker or, inline, in the capture callback.
+    if (m_bridge)
+        m_bridge->prepareAnalysis(static_cast<float>(sampleRate()), bufferSize());
+    m_analysisWorker.setBridge(m_bridge);
+    if (!m_analysisWorker.start(analysisPriority)) {
+        qWarning() << "HexCaptureClient" << "analysis-worker-unavailable" << "falling back to inline analysis";
+        SessionLogger::instance().log("analysis", "worker unavailable; analysing inline in the capture callback");
+    }
+    m_callbackTelemetry.reset(CallbackTelemetry::budgetFractionFromEnvironment());
+}
+
+void HexCaptureClient::captureStarted() {
+    m_meterPump = std::make_unique<MeterPump>(this);
+
+    if (m_monitorRequested.load(std::memory_order_acquire))
+        ensureMonitorSink();
+
+    QMetaObject::invokeMethod(this, [this]() {
+        emit bufferConfigChanged(sampleRate(), bufferSize());
+        emit xrunsChanged(m_xruns.load());
+    }, Qt::QueuedConnection);
+}
+
+void HexCaptureClient::endCapture(const char* telemetrySource) {
+    if (m_meterPump)
+        m_meterPump.reset();
+
+    if (telemetrySource)
+        m_callbackTelemetry.logSummary(telemetrySource);
+    m_analysisWorker.stop();
+
+    m_currentBufferSize.store(0);
+    m_currentSampleRate.store(0);
+    destroyMonitorSink();
+}
+
+void HexCaptureClient::countXrun() {
+    const int count = m_xruns.fetch_add(1) + 1;
+    QMetaObject::invokeMethod(this, [this, count]() { emit xrunsChanged(count); }, Qt::QueuedConnection);
+}
+
+void HexCaptureClient::setTabBridge(TabEngineBridge* bridge) {
+    m_bridge = bridge;
+    m_analysisWorker.setBridge(bridge);
+}
+
+void HexCaptureClient::connectMeters(TabEngineBridge* bridge) {
+    if (!bridge)
+        return;
+    QObject::connect(this, &HexCaptureClient::hexMetersSnapshot, bridge, &TabEngineBridge::updateLiveMeters, Qt::QueuedConnection);
+}
+
+void HexCaptureClient::connectCalibration(TabEngineBridge* bridge) {
+    if (!bridge)
+        return;
+    QObject::connect(this, &HexCaptureClient::calibrationStarted, bridge, &TabEngineBridge::handleCalibrationStarted, Qt::QueuedConnection);
+    QObject::connect(this, &HexCaptureClient::calibrationStepChanged, bridge, &TabEngineBridge::handleCalibrationStepChanged, Qt::QueuedConnection);
+    QObject::connect(this, &HexCaptureClient::calibrationFinished, bridge, &TabEngineBridge::handleCalibrationFinished, Qt::QueuedConnection);
+}
+
+void HexCaptureClient::requestCalibration(int stringIndex) {
+    const int target = (stringIndex >= 0 && stringIndex < 6) ? stringIndex : -1;
+    m_pendingCalibrationTarget.store(target, std::memory_order_release);
+}
+
+void HexCaptureClient::setLiveMonitorEnabled(bool enabled) {
+    m_monitorRequested.store(enabled, std::memory_order_release);
+    if (enabled) {
+        ensureMonitorSink();
+    } else {
+        destroyMonitorSink();
+    }
+}
+
+void HexCaptureClient::processCapturedBlock(std::array<const float*, 6>& channels, int nframes) {
+    const float sr = static_cast<float>(m_currentSampleRate.load(std::memory_order_acquire));
+    CallbackTelemetry::Scope timing(m_callbackTelemetry,
+                                    static_cast<std::uint32_t>(nframes),
+                                    static_cast<std::uint32_t>(sr));
+
+    // Apply calibration multipliers to create calibrated buffers
+    std::array<float, 6> multipliers {};
+    if (m_bridge) {
+        m_bridge->getCalibrationMultipliers(multipliers);
+    } else {
+        multipliers.fill(1.0f);
+    }
+
+    if (m_monitorMixBuffer.size() < static_cast<std::size_t>(nframes) * 2) {
+        for (auto& buf : m_calibratedBuffers)
+            buf.resize(static_cast<std::size_t>(nframes));
+        m_monitorMixBuffer.resize(static_cast<std::size_t>(nframes) * 2);
+    }
+
+    // One pass: calibration gain, per-string RMS/peak and the monitor mix.
+    std::array<float*, 6> calibrated {};
+    for (int s = 0; s < 6; ++s)
+        calibrated[static_cast<std::size_t>(s)] = m_calibratedBuffers[static_cast<std::size_t>(s)].data();
+    const bool monitorRequested = m_monitorRequested.load(std::memory_order_acquire);
+    HexBlockStats stats;
+    processHexBlock(channels.data(),
+                    calibrated.data(),
+                    multipliers.data(),
+                    nframes,
+                    m_monitorGain,
+                    monitorRequested ? m_monitorMixBuffer.data() : nullptr,
+                    stats);
+    for (int s = 0; s < 6; ++s) {
+        if (channels[static_cast<std::size_t>(s)])
+            channels[static_cast<std::size_t>(s)] = calibrated[static_cast<std::size_t>(s)];
+    }
+
+    int activeStrings = 0;
+    for (int s = 0; s < 6; ++s) {
+        if (stats.rms[static_cast<std::size_t>(s)] >= kActiveStringRms)
+            ++activeStrings;
+    }
+    timing.setActiveStrings(activeStrings);
+
+    // Meters follow the CALIBRATED audio (after multiplier applied)
+    for (int s = 0; s < 6; ++s) {
+        float level = std::clamp(stats.rms[static_cast<std::size_t>(s)], 0.0f, 1.0f);
+        const float prev = m_detectionMeters[static_cast<std::size_t>(s)].load(std::memory_order_relaxed);
+        const float mix = (s == 0) ? 0.35f : (s == 1 ? 0.45f : 1.0f);
+        if (mix < 1.0f) {
+            level = prev * (1.0f - mix) + level * mix;
+        }
+        m_detectionMeters[static_cast<std::size_t>(s)].store(level, std::memory_order_relaxed);
+    }
+
+    const int pendingTarget = m_pendingCalibrationTarget.exchange(-2, std::memory_order_acq_rel);
+    if (pendingTarget != -2)
+        handleCalibrationRequest(pendingTarget);
+
+    float levelSnapshot[6] {};
+    for (int s = 0; s < 6; ++s)
+        levelSnapshot[s] = m_detectionMeters[static_cast<std::size_t>(s)].load(std::memory_order_relaxed);
+
+    if (m_calibrationState.active)
+        advanceCalibration(levelSnapshot, nframes);
+
+    // Analysis runs on the worker thread; only fall back to inline processing
+    // when the worker could not be started.
+    if (m_analysisWorker.running()) {
+        m_analysisWorker.push(channels.data(), nframes, sr, &stats);
+    } else if (m_bridge) {
+        m_bridge->processLiveAudioBlock(channels.data(), nframes, sr, &stats);
+    }
+
+    if (monitorRequested) {
+        pushMonitorBlock(nframes);
+    }
+}
+
+void HexCaptureClient::emitMeters() {
+    std::array<float, 6> snapshot {};
+    for (int s = 0; s < 6; ++s)
+        snapshot[static_cast<std::size_t>(s)] = m_detectionMeters[static_cast<std::size_t>(s)].load();
+    emit hexMetersSnapshot(snapshot);
+
+    const HexAnalysisWorker::Stats analysis = m_analysisWorker.stats();
+    if (analysis.dropped > m_reportedAnalysisDrops) {
+        qWarning() << "HexCaptureClient" << "analysis-drops" << analysis.dropped
+                   << "depth" << analysis.depth << "highWater" << analysis.highWater << "/" << analysis.capacity;
+        SessionLogger::instance().logf("analysis", "dropped blocks=%llu depth=%zu highWater=%zu/%zu",
+                                       static_cast<unsigned long long>(analysis.dropped),
+                                       analysis.depth,
+                                       analysis.highWater,
+                                       analysis.capacity);
+        m_reportedAnalysisDrops = analysis.dropped;
+    }
+
+    if (!m_meterLoggingEnabled)
+        return;
+
+    if (!m_meterLogTimer.isValid())
+        m_meterLogTimer.start();
+
+    if (m_meterLogTimer.elapsed() >= 50) {
+        m_meterLogTimer.restart();
+        static const std::array<const char*, 6> kStringNames {"E", "A", "D", "G", "B", "e"};
+        QStringList parts;
+        parts.reserve(6);
+        for (int s = 0; s < 6; ++s) {
+            const char* name = kStringNames[static_cast<std::size_t>(s)];
+            parts.push_back(QString::asprintf("%s | %.3f", name, snapshot[static_cast<std::size_t>(s)]));
+        }
+        const QString logLine = QStringLiteral("Hex input RMS -> %1").arg(parts.join(QStringLiteral("    ")));
+        qInfo().noquote() << logLine;
+        SessionLogger::instance().log("meters", logLine.toStdString());
+    }
+}
+
+void HexCaptureClient::announceCalibrationStep(int stringIndex, bool capturing) {
+    QMetaObject::invokeMethod(this,
+                              [this, stringIndex, capturing]() {
+                                  emit calibrationStepChanged(stringIndex, capturing);
+                              },
+                              Qt::QueuedConnection);
+}
+
+void HexCaptureClient::handleCalibrationRequest(int targetString) {
+    if (m_calibrationState.active)
+        return;
+    const int currentSr = std::max(1, m_currentSampleRate.load(std::memory_order_acquire));
+    auto& state = m_calibrationState;
+    state = CalibrationState{};
+    state.active = true;
+    state.capturing = false;
+    state.partial = (targetString >= 0 && targetString < 6);
+    state.sequenceCount = state.partial ? 1 : 6;
+    for (int i = 0; i < state.sequenceCount; ++i)
+        state.sequence[static_cast<std::size_t>(i)] = state.partial ? targetString : i;
+    state.sequenceIndex = 0;
+    state.currentString = state.sequence[0];
+    state.framesRemaining = 0;
+    state.captureFramesPerString = std::max(1, static_cast<int>(currentSr * kCalibrationCaptureSecPerString));
+    state.updated.fill(false);
+    state.sumRms.fill(0.0);
+    state.samples.fill(0);
+    state.peakRms.fill(0.0f);
+    QMetaObject::invokeMethod(this, [this]() { emit calibrationStarted(); }, Qt::QueuedConnection);
+    announceCalibrationStep(state.currentString, false);
+}
+
+void HexCaptureClient::advanceCalibration(float levels[6], int nframes) {
+    auto& state = m_calibrationState;
+    if (!state.active)
+        return;
+
+    if (state.currentString < 0 || state.currentString >= 6) {
+        state.active = false;
+        announceCalibrationStep(-1, false);
+        return;
+    }
+
+    const int idx = state.currentString;
+    if (!state.capturing) {
+        const float level = std::max(0.f, levels[idx]);
+        if (level >= kCalibrationTriggerLevel) {
+            state.capturing = true;
+            state.framesRemaining = state.captureFramesPerString;
+            state.sumRms[static_cast<std::size_t>(idx)] = 0.0;
+            state.samples[static_cast<std::size_t>(idx)] = 0;
+            state.peakRms[static_cast<std::size_t>(idx)] = 0.0f;
+            announceCalibrationStep(idx, true);
+        }
+        return;
+    }
+
+    const std::size_t slot = static_cast<std::size_t>(idx);
+    const float level = std::max(0.f, levels[idx]);
+    state.sumRms[slot] += level;
+    state.samples[slot] += 1;
+    state.peakRms[slot] = std::max(state.peakRms[slot], level);
+    state.framesRemaining -= static_cast<int>(nframes);
+
+    if (state.framesRemaining > 0)
+        return;
+
+    state.capturing = false;
+    state.framesRemaining = 0;
+    state.updated[slot] = true;
+    state.sequenceIndex += 1;
+
+    if (state.sequenceIndex >= state.sequenceCount) {
+        state.active = false;
+        announceCalibrationStep(-1, false);
+
+        std::array<float, 6> averages {};
+        std::array<float, 6> peaks {};
+        for (int s = 0; s < 6; ++s) {
+            const std::size_t slotIdx = static_cast<std::size_t>(s);
+            if (state.updated[slotIdx]) {
+                const int count = state.samples[slotIdx];
+                averages[slotIdx] = (count > 0)
+                    ? static_cast<float>(state.sumRms[slotIdx] / static_cast<double>(count))
+                    : 0.f;
+                peaks[slotIdx] = state.peakRms[slotIdx];
+            } else {
+                averages[slotIdx] = -1.f;
+                peaks[slotIdx] = -1.f;
+            }
+        }
+
+        QMetaObject::invokeMethod(this, [this, averages, peaks]() {
+            emit calibrationFinished(averages, peaks);
+        }, Qt::QueuedConnection);
+        state = CalibrationState{};
+        return;
+    }
+
+    state.currentString = state.sequence[static_cast<std::size_t>(state.sequenceIndex)];
+    announceCalibrationStep(state.currentString, false);
+}
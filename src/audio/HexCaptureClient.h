@@ -0,0 +1,125 @@
+#pragma once
+
+#include "AudioEngine.h"
+#include "CallbackTelemetry.h"
+#include "HexAnalysisWorker.h"
+#include "HexAudioClient.h"
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QMetaType>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class TabEngineBridge;
+
+using HexMeterArray = std::array<float, 6>;
+
+// Backend-independent half of the hex capture path. A concrete client owns the
+// clock (JACK process callback, null timer thread) and hands every period of
+// raw per-string input to processCapturedBlock(), which applies calibration
+// gains, updates meters and the calibration state machine, queues the block
+// for the analysis worker and mixes the monitor feed. Only the monitor sink and
+// the device lifecycle are left to subclasses.
+class HexCaptureClient : public AudioEngine, public HexAudioClient {
+    Q_OBJECT
+public:
+    explicit HexCaptureClient(QObject* parent=nullptr);
+    ~HexCaptureClient() override;
+
+    void setTabBridge(TabEngineBridge* bridge) override;
+    void connectMeters(TabEngineBridge* bridge) override;
+    void connectCalibration(TabEngineBridge* bridge) override;
+    void requestCalibration(int stringIndex = -1) override;
+    void setLiveMonitorEnabled(bool enabled);
+    bool liveMonitorEnabled() const noexcept { return m_monitorRequested.load(std::memory_order_acquire); }
+
+    int bufferSize() const { return m_currentBufferSize.load(std::memory_order_acquire); }
+    int sampleRate() const { return m_currentSampleRate.load(std::memory_order_acquire); }
+    HexAnalysisWorker::Stats analysisStats() const noexcept { return m_analysisWorker.stats(); }
+    CallbackTelemetry& callbackTelemetry() noexcept { return m_callbackTelemetry; }
+    int xruns() const { return m_xruns.load(std::memory_order_relaxed); }
+    virtual qreal jackCpuLoad() const { return -1.0; }  // percent, -1 when not backed by JACK
+
+signals:
+    void bufferConfigChanged(int sampleRate, int bufferSize);
+    void xrunsChanged(int count);
+    void hexMetersSnapshot(const HexMeterArray& meters);
+    void calibrationStarted();
+    void calibrationStepChanged(int stringIndex, bool capturing);
+    void calibrationFinished(const std::array<float, 6>& averages,
+                             const std::array<float, 6>& peaks);
+
+protected:
+    // Analysis worker priority for a capture thread running at callbackPriority
+    // (<= 0 when unknown). GUITARPI_ANALYSIS_PRIORITY overrides.
+    static int analysisPriorityBelow(int callbackPriority);
+
+    // Call before the first period is delivered / after the last one returned.
+    void beginCapture(int analysisPriority);
+    void captureStarted();
+    void endCapture(const char* telemetrySource);
+
+    // RT-safe. channels[s] may be null for an absent string.
+    void processCapturedBlock(std::array<const float*, 6>& channels, int nframes);
+    void countXrun();
+
+    // Monitor sink hooks; pushMonitorBlock() runs on the capture thread and
+    // reads the interleaved stereo mix from m_monitorMixBuffer.
+    virtual bool ensureMonitorSink() = 0;
+    virtual void destroyMonitorSink() = 0;
+    virtual void pushMonitorBlock(int frames) = 0;
+
+    std::atomic<int> m_currentBufferSize {0};
+    std::atomic<int> m_currentSampleRate {0};
+    std::atomic<int> m_pendingBufferSize {0};
+    std::atomic<int> m_pendingSampleRate {0};
+    std::atomic<int> m_xruns {0};
+    std::atomic<bool> m_monitorRequested {false};
+    std::vector<float> m_monitorMixBuffer;
+    TabEngineBridge* m_bridge {nullptr};
+
+private:
+    void emitMeters();
+    void handleCalibrationRequest(int targetString);
+    void advanceCalibration(float levels[6], int nframes);
+    void announceCalibrationStep(int stringIndex, bool capturing);
+
+    std::array<std::atomic<float>, 6> m_detectionMeters {};
+    QElapsedTimer m_meterLogTimer;
+    bool m_meterLoggingEnabled {false};
+
+    HexAnalysisWorker m_analysisWorker;
+    std::uint64_t m_reportedAnalysisDrops {0};
+    CallbackTelemetry m_callbackTelemetry;
+
+    class MeterPump;
+    std::unique_ptr<MeterPump> m_meterPump;
+
+    float m_monitorGain {0.35f};
+
+    // Calibrated audio buffers (per-string)
+    std::array<std::vector<float>, 6> m_calibratedBuffers;
+
+    struct CalibrationState {
+        bool active {false};
+        bool capturing {false};
+        bool partial {false};
+        int currentString {0};
+        int sequenceIndex {0};
+        int sequenceCount {0};
+        int framesRemaining {0};
+        int captureFramesPerString {0};
+        std::array<int, 6> sequence {};
+        std::array<bool, 6> updated {};
+        std::array<double, 6> sumRms {};
+        std::array<int, 6> samples {};
+        std::array<float, 6> peakRms {};
+    };
+
+    std::atomic<int> m_pendingCalibrationTarget {-2};
+    CalibrationState m_calibrationState;
+};
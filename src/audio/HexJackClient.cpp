@@ -1,66 +1,29 @@
 #include "HexJackClient.h"
 #include "JackMonitorSink.h"
-#include "../TabEngineBridge.h"
-#include "../SessionLogger.h"
+#include "../RtCheck.h"
+#include "../TraceRing.h"
 
 #include <QMetaObject>
 #include <QProcess>
 #include <QElapsedTimer>
 #include <QThread>
-#include <QTimer>
 #include <QDebug>
-#include <QStringList>
 
 #include <jack/jack.h>
 
 #include <algorithm>
 #include <array>
-#include <cmath>
 #include <string>
 
 namespace {
 constexpr int kTabCaptureBaseChannel = 3;
 constexpr const char* kHexClientName = "guitarpi_hex";
 constexpr const char* kDefaultJackCommand = "JACK_NO_AUDIO_RESERVATION=1 jackd -R -P70 -d alsa -d hw:2,0 -p128 -n3 -r48000 -s~";
-constexpr float kCalibrationCaptureSecPerString = 1.25f;
-constexpr float kCalibrationTriggerLevel = 0.008f;
-
-float computeLevel(const jack_default_audio_sample_t* buffer, jack_nframes_t frames) {
-    if (!buffer || frames == 0)
-        return 0.0f;
-    double sum = 0.0;
-    for (jack_nframes_t i = 0; i < frames; ++i) {
-        const double sample = buffer[i];
-        sum += sample * sample;
-    }
-    const double rms = std::sqrt(sum / static_cast<double>(frames));
-    return static_cast<float>(std::clamp(rms, 0.0, 1.0));
-}
 
 } // namespace
 
-class HexJackClient::MeterPump {
-public:
-    explicit MeterPump(HexJackClient* owner) : m_owner(owner) {
-        m_timer = std::make_unique<QTimer>();
-        m_timer->setTimerType(Qt::CoarseTimer);
-        m_timer->setInterval(40);
-        QObject::connect(m_timer.get(), &QTimer::timeout, owner, [owner]() { owner->emitMeters(); });
-        m_timer->start();
-    }
-
-private:
-    HexJackClient* m_owner;
-    std::unique_ptr<QTimer> m_timer;
-};
-
 HexJackClient::HexJackClient(QObject* parent)
-    : AudioEngine(parent) {
-    qRegisterMetaType<std::array<float, 6>>("FloatMeterArray");
-    for (auto& meter : m_detectionMeters)
-        meter.store(0.0f);
-    m_meterLoggingEnabled = qEnvironmentVariableIntValue("GUITARPI_HEX_METER_LOGS") > 0;
-}
+    : HexCaptureClient(parent) {}
 
 HexJackClient::~HexJackClient() {
     stop();
@@ -88,6 +51,7 @@ bool HexJackClient::start() {
     jack_set_sample_rate_callback(m_client, &HexJackClient::sampleRateCallback, this);
     jack_set_xrun_callback(m_client, &HexJackClient::xrunCallback, this);
     jack_on_shutdown(m_client, &HexJackClient::shutdownCallback, this);
+    jack_set_thread_init_callback(m_client, &HexJackClient::threadInitCallback, this);
 
     for (int s = 0; s < 6; ++s) {
         const std::string portName = "hex_in_" + std::to_string(s + 1);
@@ -111,6 +75,8 @@ bool HexJackClient::start() {
         jack_set_buffer_size(m_client, static_cast<jack_nframes_t>(pendingFrames));
     }
 
+    beginCapture(analysisPriorityBelow(jack_client_real_time_priority(m_client)));
+
     if (jack_activate(m_client) != 0) {
         qWarning("HexJackClient: failed to activate JACK client");
         stop();
@@ -118,24 +84,13 @@ bool HexJackClient::start() {
     }
 
     connectSystemPorts();
-
-    m_meterPump = std::make_unique<MeterPump>(this);
-
-    if (m_monitorRequested.load(std::memory_order_acquire))
-        ensureMonitorSink();
-
-    QMetaObject::invokeMethod(this, [this]() {
-        emit bufferConfigChanged(sampleRate(), bufferSize());
-        emit xrunsChanged(m_xruns.load());
-    }, Qt::QueuedConnection);
+    captureStarted();
 
     return true;
 }
 
 void HexJackClient::stop() {
-    if (m_meterPump)
-        m_meterPump.reset();
-
+    const bool wasRunning = (m_client != nullptr);
     if (m_client) {
         jack_client_t* client = m_client;
         m_client = nullptr;
@@ -143,9 +98,7 @@ void HexJackClient::stop() {
     }
 
     m_inputs.fill(nullptr);
-    m_currentBufferSize.store(0);
-    m_currentSampleRate.store(0);
-    destroyMonitorSink();
+    endCapture(wasRunning ? "hex" : nullptr);
 }
 
 void HexJackClient::setBufferSize(int frames) {
@@ -162,38 +115,6 @@ void HexJackClient::setSampleRate(int sr) {
     }
 }
 
-void HexJackClient::setTabBridge(TabEngineBridge* bridge) {
-    m_bridge = bridge;
-}
-
-void HexJackClient::connectMeters(TabEngineBridge* bridge) {
-    if (!bridge)
-        return;
-    QObject::connect(this, &HexJackClient::hexMetersSnapshot, bridge, &TabEngineBridge::updateLiveMeters, Qt::QueuedConnection);
-}
-
-void HexJackClient::connectCalibration(TabEngineBridge* bridge) {
-    if (!bridge)
-        return;
-    QObject::connect(this, &HexJackClient::calibrationStarted, bridge, &TabEngineBridge::handleCalibrationStarted, Qt::QueuedConnection);
-    QObject::connect(this, &HexJackClient::calibrationStepChanged, bridge, &TabEngineBridge::handleCalibrationStepChanged, Qt::QueuedConnection);
-    QObject::connect(this, &HexJackClient::calibrationFinished, bridge, &TabEngineBridge::handleCalibrationFinished, Qt::QueuedConnection);
-}
-
-void HexJackClient::requestCalibration(int stringIndex) {
-    const int target = (stringIndex >= 0 && stringIndex < 6) ? stringIndex : -1;
-    m_pendingCalibrationTarget.store(target, std::memory_order_release);
-}
-
-void HexJackClient::setLiveMonitorEnabled(bool enabled) {
-    m_monitorRequested.store(enabled, std::memory_order_release);
-    if (enabled) {
-        ensureMonitorSink();
-    } else {
-        destroyMonitorSink();
-    }
-}
-
 bool HexJackClient::ensureMonitorSink() {
     if (!m_monitorRequested.load(std::memory_order_acquire))
         return false;
@@ -229,36 +150,21 @@ void HexJackClient::destroyMonitorSink() {
         old->stop();
 }
 
-void HexJackClient::pushMonitorBlock(const float* const channels[6], int frames) {
-    if (!channels || frames <= 0)
+void HexJackClient::pushMonitorBlock(int frames) {
+    if (frames <= 0)
         return;
 
     auto sink = std::atomic_load(&m_monitorSink);
     if (!sink || !sink->isActive())
         return;
 
-    const std::size_t sampleCount = static_cast<std::size_t>(frames) * 2;
-    if (m_monitorMixBuffer.size() < sampleCount)
-        m_monitorMixBuffer.resize(sampleCount);
-
-    for (int frame = 0; frame < frames; ++frame) {
-        float sum = 0.f;
-        for (int stringIndex = 0; stringIndex < 6; ++stringIndex) {
-            const float sample = channels[stringIndex] ? channels[stringIndex][frame] : 0.f;
-            sum += sample;
-        }
-        const float mono = (sum / 6.f) * m_monitorGain;
-        const std::size_t base = static_cast<std::size_t>(frame) * 2;
-        m_monitorMixBuffer[base] = mono;
-        m_monitorMixBuffer[base + 1] = mono;
-    }
-
     sink->push(m_monitorMixBuffer.data(), frames);
 }
 
 int HexJackClient::processCallback(jack_nframes_t nframes, void* arg) {
     auto* self = static_cast<HexJackClient*>(arg);
     std::array<const float*, 6> channels {};
+    GUITARPI_RT_SCOPE("HexJackClient::processCallback");
 
     // Get raw JACK input buffers
     for (int s = 0; s < 6; ++s) {
@@ -267,63 +173,7 @@ int HexJackClient::processCallback(jack_nframes_t nframes, void* arg) {
         channels[static_cast<std::size_t>(s)] = buffer ? reinterpret_cast<const float*>(buffer) : nullptr;
     }
 
-    // Apply calibration multipliers to create calibrated buffers
-    std::array<float, 6> multipliers {};
-    if (self->m_bridge) {
-        self->m_bridge->getCalibrationMultipliers(multipliers);
-    } else {
-        multipliers.fill(1.0f);
-    }
-
-    for (int s = 0; s < 6; ++s) {
-        const float* src = channels[static_cast<std::size_t>(s)];
-        if (!src) continue;
-
-        auto& buf = self->m_calibratedBuffers[static_cast<std::size_t>(s)];
-        buf.resize(nframes);
-        
-        const float mult = multipliers[static_cast<std::size_t>(s)];
-        for (jack_nframes_t i = 0; i < nframes; ++i) {
-            buf[i] = src[i] * mult;
-        }
-        
-        channels[static_cast<std::size_t>(s)] = buf.data();
-    }
-
-    // Calculate meters from CALIBRATED audio (after multiplier applied)
-    for (int s = 0; s < 6; ++s) {
-        const float* calibratedBuffer = channels[static_cast<std::size_t>(s)];
-        float level = calibratedBuffer ? computeLevel(calibratedBuffer, nframes) : 0.0f;
-        const float prev = self->m_detectionMeters[static_cast<std::size_t>(s)].load(std::memory_order_relaxed);
-        const float mix = (s == 0) ? 0.35f : (s == 1 ? 0.45f : 1.0f);
-        if (mix < 1.0f) {
-            level = prev * (1.0f - mix) + level * mix;
-        }
-        self->m_detectionMeters[static_cast<std::size_t>(s)].store(level, std::memory_order_relaxed);
-    }
-
-    const int pendingTarget = self->m_pendingCalibrationTarget.exchange(-2, std::memory_order_acq_rel);
-    if (pendingTarget != -2)
-        self->handleCalibrationRequest(pendingTarget);
-
-    float levelSnapshot[6] {};
-    for (int s = 0; s < 6; ++s)
-        levelSnapshot[s] = self->m_detectionMeters[static_cast<std::size_t>(s)].load(std::memory_order_relaxed);
-
-    if (self->m_calibrationState.active)
-        self->advanceCalibration(levelSnapshot, nframes);
-
-    const float sr = static_cast<float>(self->m_currentSampleRate.load(std::memory_order_acquire));
-    
-    // Now both processing and monitor see calibrated audio
-    if (self->m_bridge) {
-        self->m_bridge->processLiveAudioBlock(channels.data(), static_cast<int>(nframes), sr);
-    }
-
-    if (self->m_monitorRequested.load(std::memory_order_acquire)) {
-        self->pushMonitorBlock(channels.data(), static_cast<int>(nframes));
-    }
-
+    self->processCapturedBlock(channels, static_cast<int>(nframes));
     return 0;
 }
 
@@ -342,9 +192,7 @@ int HexJackClient::sampleRateCallback(jack_nframes_t nframes, void* arg) {
 }
 
 int HexJackClient::xrunCallback(void* arg) {
-    auto* self = static_cast<HexJackClient*>(arg);
-    const int count = self->m_xruns.fetch_add(1) + 1;
-    QMetaObject::invokeMethod(self, [self, count]() { emit self->xrunsChanged(count); }, Qt::QueuedConnection);
+    static_cast<HexJackClient*>(arg)->countXrun();
     return 0;
 }
 
@@ -353,31 +201,15 @@ void HexJackClient::shutdownCallback(void* arg) {
     QMetaObject::invokeMethod(self, [self]() { self->handleClientShutdown(); }, Qt::QueuedConnection);
 }
 
-void HexJackClient::emitMeters() {
-    std::array<float, 6> snapshot {};
-    for (int s = 0; s < 6; ++s)
-        snapshot[static_cast<std::size_t>(s)] = m_detectionMeters[static_cast<std::size_t>(s)].load();
-    emit hexMetersSnapshot(snapshot);
-
-    if (!m_meterLoggingEnabled)
-        return;
+void HexJackClient::threadInitCallback(void*) {
+    // Runs on the process thread before its first cycle. Analysis falls back
+    // to that thread when the worker cannot start, so its trace ring is
+    // registered here rather than by the first record.
+    trace::prepareThread();
+}
 
-    if (!m_meterLogTimer.isValid())
-        m_meterLogTimer.start();
-
-    if (m_meterLogTimer.elapsed() >= 50) {
-        m_meterLogTimer.restart();
-        static const std::array<const char*, 6> kStringNames {"E", "A", "D", "G", "B", "e"};
-        QStringList parts;
-        parts.reserve(6);
-        for (int s = 0; s < 6; ++s) {
-            const char* name = kStringNames[static_cast<std::size_t>(s)];
-            parts.push_back(QString::asprintf("%s | %.3f", name, snapshot[static_cast<std::size_t>(s)]));
-        }
-        const QString logLine = QStringLiteral("Hex input RMS -> %1").arg(parts.join(QStringLiteral("    ")));
-        qInfo().noquote() << logLine;
-        SessionLogger::instance().log("meters", logLine.toStdString());
-    }
+qreal HexJackClient::jackCpuLoad() const {
+    return m_client ? static_cast<qreal>(jack_cpu_load(m_client)) : -1.0;
 }
 
 void HexJackClient::handleClientShutdown() {
@@ -478,106 +310,3 @@ void HexJackClient::connectSystemPorts() {
         connect(source.c_str(), dest);
     }
 }
-
-void HexJackClient::announceCalibrationStep(int stringIndex, bool capturing) {
-    QMetaObject::invokeMethod(this,
-                              [this, stringIndex, capturing]() {
-                                  emit calibrationStepChanged(stringIndex, capturing);
-                              },
-                              Qt::QueuedConnection);
-}
-
-void HexJackClient::handleCalibrationRequest(int targetString) {
-    if (m_calibrationState.active)
-        return;
-    const int currentSr = std::max(1, m_currentSampleRate.load(std::memory_order_acquire));
-    auto& state = m_calibrationState;
-    state = CalibrationState{};
-    state.active = true;
-    state.capturing = false;
-    state.partial = (targetString >= 0 && targetString < 6);
-    state.sequenceCount = state.partial ? 1 : 6;
-    for (int i = 0; i < state.sequenceCount; ++i)
-        state.sequence[static_cast<std::size_t>(i)] = state.partial ? targetString : i;
-    state.sequenceIndex = 0;
-    state.currentString = state.sequence[0];
-    state.framesRemaining = 0;
-    state.captureFramesPerString = std::max(1, static_cast<int>(currentSr * kCalibrationCaptureSecPerString));
-    state.updated.fill(false);
-    state.sumRms.fill(0.0);
-    state.samples.fill(0);
-    state.peakRms.fill(0.0f);
-    QMetaObject::invokeMethod(this, [this]() { emit calibrationStarted(); }, Qt::QueuedConnection);
-    announceCalibrationStep(state.currentString, false);
-}
-
-void HexJackClient::advanceCalibration(float levels[6], jack_nframes_t nframes) {
-    auto& state = m_calibrationState;
-    if (!state.active)
-        return;
-
-    if (state.currentString < 0 || state.currentString >= 6) {
-        state.active = false;
-        announceCalibrationStep(-1, false);
-        return;
-    }
-
-    const int idx = state.currentString;
-    if (!state.capturing) {
-        const float level = std::max(0.f, levels[idx]);
-        if (level >= kCalibrationTriggerLevel) {
-            state.capturing = true;
-            state.framesRemaining = state.captureFramesPerString;
-            state.sumRms[static_cast<std::size_t>(idx)] = 0.0;
-            state.samples[static_cast<std::size_t>(idx)] = 0;
-            state.peakRms[static_cast<std::size_t>(idx)] = 0.0f;
-            announceCalibrationStep(idx, true);
-        }
-        return;
-    }
-
-    const std::size_t slot = static_cast<std::size_t>(idx);
-    const float level = std::max(0.f, levels[idx]);
-    state.sumRms[slot] += level;
-    state.samples[slot] += 1;
-    state.peakRms[slot] = std::max(state.peakRms[slot], level);
-    state.framesRemaining -= static_cast<int>(nframes);
-
-    if (state.framesRemaining > 0)
-        return;
-
-    state.capturing = false;
-    state.framesRemaining = 0;
-    state.updated[slot] = true;
-    state.sequenceIndex += 1;
-
-    if (state.sequenceIndex >= state.sequenceCount) {
-        state.active = false;
-        announceCalibrationStep(-1, false);
-
-        std::array<float, 6> averages {};
-        std::array<float, 6> peaks {};
-        for (int s = 0; s < 6; ++s) {
-            const std::size_t slotIdx = static_cast<std::size_t>(s);
-            if (state.updated[slotIdx]) {
-                const int count = state.samples[slotIdx];
-                averages[slotIdx] = (count > 0)
-                    ? static_cast<float>(state.sumRms[slotIdx] / static_cast<double>(count))
-                    : 0.f;
-                peaks[slotIdx] = state.peakRms[slotIdx];
-            } else {
-                averages[slotIdx] = -1.f;
-                peaks[slotIdx] = -1.f;
-            }
-        }
-
-        QMetaObject::invokeMethod(this, [this, averages, peaks]() {
-            emit calibrationFinished(averages, peaks);
-        }, Qt::QueuedConnection);
-        state = CalibrationState{};
-        return;
-    }
-
-    state.currentString = state.sequence[static_cast<std::size_t>(state.sequenceIndex)];
-    announceCalibrationStep(state.currentString, false);
-}
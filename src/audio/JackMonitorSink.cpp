@@ -1,4 +1,5 @@
 #include "JackMonitorSink.h"
+#include "../RtCheck.h"
 
 #include <QDebug>
 #include <algorithm>
@@ -110,6 +111,7 @@ bool JackMonitorSink::push(const float* interleavedStereo, int frames) {
 }
 
 int JackMonitorSink::processCallback(jack_nframes_t nframes, void* arg) {
+    GUITARPI_RT_SCOPE("JackMonitorSink::processCallback");
     auto* self = static_cast<JackMonitorSink*>(arg);
     return self ? self->process(nframes) : 0;
 }
@@ -0,0 +1,385 @@
+#include "NullHexClient.h"
+#include "../RtCheck.h"
+#include "../SessionLogger.h"
+#include "../TraceRing.h"
+#include "../util.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMetaObject>
+#include <QStringList>
+#include <QtGlobal>
+
+#include <sndfile.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+namespace {
+constexpr int kDefaultSampleRate = 48000;
+constexpr int kDefaultBufferFrames = 128;
+constexpr int kMinBufferFrames = 16;
+constexpr int kMaxBufferFrames = 4096;
+// Matches the -P70 the JACK launcher uses, so the analysis worker lands at the
+// same priority it would under jackd.
+constexpr int kDefaultRtPriority = 70;
+constexpr std::int64_t kNanosPerSecond = 1000000000;
+
+// Generator: one pluck every kPluckIntervalSec, walking strings and frets so
+// every tracker and the calibration trigger see signal.
+constexpr double kPluckIntervalSec = 0.6;
+constexpr float kPluckAmplitude = 0.2f;
+constexpr float kPluckDecaySec = 0.8f;
+constexpr std::array<int, 6> kOpenStringMidi {{40, 45, 50, 55, 59, 64}};
+
+std::int64_t monotonicNanos() {
+    timespec ts {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<std::int64_t>(ts.tv_sec) * kNanosPerSecond + ts.tv_nsec;
+}
+
+void sleepUntil(std::int64_t deadlineNs) {
+    timespec ts {};
+    ts.tv_sec = static_cast<time_t>(deadlineNs / kNanosPerSecond);
+    ts.tv_nsec = static_cast<long>(deadlineNs % kNanosPerSecond);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+}
+
+std::int64_t periodNanos(int frames, int sampleRate) {
+    return static_cast<std::int64_t>(frames) * kNanosPerSecond / sampleRate;
+}
+
+bool readWav(const QString& path, SF_INFO& info, std::vector<float>& interleaved) {
+    info = {};
+    SNDFILE* file = sf_open(QFile::encodeName(path).constData(), SFM_READ, &info);
+    if (!file) {
+        qWarning() << "NullHexClient" << "open-failed" << path << sf_strerror(nullptr);
+        return false;
+    }
+    interleaved.assign(static_cast<std::size_t>(info.frames) * static_cast<std::size_t>(info.channels), 0.f);
+    const sf_count_t read = sf_readf_float(file, interleaved.data(), info.frames);
+    sf_close(file);
+    interleaved.resize(static_cast<std::size_t>(std::max<sf_count_t>(0, read)) * static_cast<std::size_t>(info.channels));
+    return read > 0;
+}
+} // namespace
+
+NullHexClient::NullHexClient(QObject* parent)
+    : HexCaptureClient(parent) {
+    for (auto& buffer : m_inputBuffers)
+        buffer.assign(kMaxBufferFrames, 0.0f);
+    const QByteArray spec = qgetenv("GUITARPI_NULL_HEX_SOURCE");
+    setSource(spec.isEmpty() ? QStringLiteral("silence") : QString::fromUtf8(spec));
+}
+
+NullHexClient::~NullHexClient() {
+    stop();
+}
+
+bool NullHexClient::requestedByEnvironment() {
+    return qgetenv("GUITARPI_HEX_BACKEND").trimmed().toLower() == "null";
+}
+
+void NullHexClient::setSource(const QString& spec) {
+    const QString trimmed = spec.trimmed();
+    if (trimmed.compare(QStringLiteral("generator"), Qt::CaseInsensitive) == 0) {
+        m_source = Source::Generator;
+        m_sourcePath.clear();
+    } else if (trimmed.isEmpty() || trimmed.compare(QStringLiteral("silence"), Qt::CaseInsensitive) == 0) {
+        m_source = Source::Silence;
+        m_sourcePath.clear();
+    } else {
+        m_source = Source::File;
+        m_sourcePath = trimmed;
+    }
+}
+
+bool NullHexClient::start() {
+    if (m_thread.joinable())
+        return true;
+
+    int sr = m_pendingSampleRate.load();
+    if (sr <= 0)
+        sr = kDefaultSampleRate;
+
+    m_activeSource = m_source;
+    if (m_activeSource == Source::File && !loadFileSource()) {
+        qWarning() << "NullHexClient" << "file-source-unavailable" << m_sourcePath << "using silence";
+        m_activeSource = Source::Silence;
+    }
+    if (m_activeSource == Source::File && m_fileSampleRate != sr) {
+        qInfo() << "NullHexClient" << "sample-rate" << m_fileSampleRate << "from file; requested" << sr;
+        sr = m_fileSampleRate;
+    }
+
+    int frames = m_pendingBufferSize.load();
+    if (frames <= 0)
+        frames = kDefaultBufferFrames;
+    frames = std::clamp(frames, kMinBufferFrames, kMaxBufferFrames);
+
+    m_currentSampleRate.store(sr);
+    m_currentBufferSize.store(frames);
+
+    m_voices = {};
+    m_generatorFrame = 0;
+    m_noteCounter = 0;
+    m_decayPerSample = std::exp(-1.0f / (kPluckDecaySec * static_cast<float>(sr)));
+    m_filePosition = 0;
+    m_periods = 0;
+    m_maxWakeLateNs = 0;
+    m_monitorFrames.store(0, std::memory_order_relaxed);
+    m_monitorPeak.store(0.f, std::memory_order_relaxed);
+
+    m_rtPriority = kDefaultRtPriority;
+    if (qEnvironmentVariableIsSet("GUITARPI_NULL_HEX_PRIORITY"))
+        m_rtPriority = qEnvironmentVariableIntValue("GUITARPI_NULL_HEX_PRIORITY");
+
+    beginCapture(analysisPriorityBelow(m_rtPriority));
+
+    m_stopRequested.store(false, std::memory_order_release);
+    m_thread = std::thread([this]() { run(); });
+    applySchedulingPolicy(m_rtPriority);
+
+    static const char* const kSourceNames[] {"silence", "generator", "file"};
+    SessionLogger::instance().logf("null-hex", "started source=%s sr=%d period=%d",
+                                   kSourceNames[static_cast<int>(m_activeSource)], sr, frames);
+    qInfo() << "NullHexClient" << "started" << kSourceNames[static_cast<int>(m_activeSource)]
+            << "sr" << sr << "period" << frames;
+
+    captureStarted();
+    return true;
+}
+
+void NullHexClient::stop() {
+    const bool wasRunning = m_thread.joinable();
+    if (wasRunning) {
+        m_stopRequested.store(true, std::memory_order_release);
+        m_thread.join();
+        SessionLogger::instance().logf("null-hex",
+                                       "stopped periods=%llu xruns=%d maxWakeLate=%lldus monitorFrames=%llu monitorPeak=%.3f",
+                                       static_cast<unsigned long long>(m_periods),
+                                       xruns(),
+                                       static_cast<long long>(m_maxWakeLateNs / 1000),
+                                       static_cast<unsigned long long>(m_monitorFrames.load(std::memory_order_relaxed)),
+                                       static_cast<double>(m_monitorPeak.load(std::memory_order_relaxed)));
+    }
+    endCapture(wasRunning ? "hex" : nullptr);
+}
+
+void NullHexClient::setBufferSize(int frames) {
+    // Picked up by the timer thread at the next period boundary.
+    m_pendingBufferSize.store(frames);
+}
+
+void NullHexClient::setSampleRate(int sr) {
+    m_pendingSampleRate.store(sr);
+    if (m_thread.joinable() && sr > 0 && sr != sampleRate()) {
+        qWarning("NullHexClient: running at %d Hz; restart capture for %d Hz", sampleRate(), sr);
+    }
+}
+
+void NullHexClient::applySchedulingPolicy(int rtPriority) {
+    if (rtPriority <= 0)
+        return;
+
+    const int maxPriority = sched_get_priority_max(SCHED_FIFO);
+    const int minPriority = sched_get_priority_min(SCHED_FIFO);
+    sched_param param {};
+    param.sched_priority = std::clamp(rtPriority, minPriority, maxPriority);
+    const int rc = pthread_setschedparam(m_thread.native_handle(), SCHED_FIFO, &param);
+    if (rc != 0) {
+        qWarning() << "NullHexClient" << "sched-fifo-failed" << param.sched_priority << std::strerror(rc);
+        SessionLogger::instance().logf("null-hex", "SCHED_FIFO %d unavailable (%s); running at normal priority",
+                                       param.sched_priority, std::strerror(rc));
+        return;
+    }
+    qInfo() << "NullHexClient" << "sched-fifo" << param.sched_priority;
+}
+
+bool NullHexClient::loadFileSource() {
+    for (auto& track : m_fileTracks)
+        track.clear();
+    m_fileFrames = 0;
+    m_fileSampleRate = 0;
+
+    const QFileInfo info(m_sourcePath);
+    QStringList paths;
+    if (info.isDir()) {
+        const QDir dir(info.absoluteFilePath());
+        for (const QString& name : dir.entryList({QStringLiteral("*.wav"), QStringLiteral("*.WAV")}, QDir::Files, QDir::Name))
+            paths.push_back(dir.filePath(name));
+    } else {
+        paths.push_back(info.absoluteFilePath());
+    }
+
+    std::vector<float> interleaved;
+    SF_INFO format {};
+    if (paths.size() == 1) {
+        if (!readWav(paths.front(), format, interleaved))
+            return false;
+        const int channels = std::min(format.channels, 6);
+        const std::size_t frames = interleaved.size() / static_cast<std::size_t>(format.channels);
+        for (int s = 0; s < channels; ++s) {
+            auto& track = m_fileTracks[static_cast<std::size_t>(s)];
+            track.resize(frames);
+            for (std::size_t i = 0; i < frames; ++i)
+                track[i] = interleaved[i * static_cast<std::size_t>(format.channels) + static_cast<std::size_t>(s)];
+        }
+        m_fileSampleRate = format.samplerate;
+    } else {
+        for (int s = 0; s < std::min<int>(6, paths.size()); ++s) {
+            if (!readWav(paths[s], format, interleaved))
+                continue;
+            if (m_fileSampleRate == 0)
+                m_fileSampleRate = format.samplerate;
+            else if (format.samplerate != m_fileSampleRate) {
+                qWarning() << "NullHexClient" << "sample-rate-mismatch" << paths[s];
+                continue;
+            }
+            // Mixes multichannel files down to the string's track.
+            auto& track = m_fileTracks[static_cast<std::size_t>(s)];
+            const std::size_t frames = interleaved.size() / static_cast<std::size_t>(format.channels);
+            track.assign(frames, 0.f);
+            for (std::size_t i = 0; i < frames; ++i) {
+                for (int c = 0; c < format.channels; ++c)
+                    track[i] += interleaved[i * static_cast<std::size_t>(format.channels) + static_cast<std::size_t>(c)];
+                track[i] /= static_cast<float>(format.channels);
+            }
+        }
+    }
+
+    for (const auto& track : m_fileTracks)
+        m_fileFrames = std::max(m_fileFrames, track.size());
+    // Shorter tracks are zero-padded so every string loops on the same boundary.
+    for (auto& track : m_fileTracks)
+        track.resize(m_fileFrames, 0.f);
+    return m_fileFrames > 0 && m_fileSampleRate > 0;
+}
+
+void NullHexClient::run() {
+    int frames = m_currentBufferSize.load(std::memory_order_acquire);
+    int appliedRequest = m_pendingBufferSize.load(std::memory_order_relaxed);
+    const int sr = m_currentSampleRate.load(std::memory_order_acquire);
+    std::int64_t epochNs = monotonicNanos();
+    std::uint64_t framesSinceEpoch = 0;
+    std::array<const float*, 6> channels {};
+    // This thread analyses inline when the worker could not start.
+    trace::prepareThread();
+
+    while (!m_stopRequested.load(std::memory_order_acquire)) {
+        const int requested = m_pendingBufferSize.load(std::memory_order_relaxed);
+        if (requested > 0 && requested != appliedRequest) {
+            appliedRequest = requested;
+            frames = std::clamp(requested, kMinBufferFrames, kMaxBufferFrames);
+            m_currentBufferSize.store(frames, std::memory_order_release);
+            QMetaObject::invokeMethod(this, [this]() { emit bufferConfigChanged(sampleRate(), bufferSize()); }, Qt::QueuedConnection);
+        }
+
+        // Deadlines are derived from the frame count since the last resync, so
+        // the period never accumulates rounding drift.
+        framesSinceEpoch += static_cast<std::uint64_t>(frames);
+        const std::int64_t deadlineNs = epochNs + static_cast<std::int64_t>(framesSinceEpoch * static_cast<std::uint64_t>(kNanosPerSecond)
+                                                                           / static_cast<std::uint64_t>(sr));
+        sleepUntil(deadlineNs);
+
+        const std::int64_t lateNs = monotonicNanos() - deadlineNs;
+        m_maxWakeLateNs = std::max(m_maxWakeLateNs, lateNs);
+        if (lateNs > periodNanos(frames, sr)) {
+            // A whole period was missed: report it like a JACK xrun and restart
+            // the clock instead of bursting to catch up.
+            countXrun();
+            epochNs = monotonicNanos();
+            framesSinceEpoch = 0;
+        }
+
+        GUITARPI_RT_SCOPE("NullHexClient::run");
+        renderBlock(frames);
+        for (int s = 0; s < 6; ++s)
+            channels[static_cast<std::size_t>(s)] = m_inputBuffers[static_cast<std::size_t>(s)].data();
+        processCapturedBlock(channels, frames);
+        ++m_periods;
+    }
+}
+
+void NullHexClient::renderBlock(int frames) {
+    switch (m_activeSource) {
+    case Source::Generator:
+        renderGenerator(frames);
+        break;
+    case Source::File:
+        renderFile(frames);
+        break;
+    case Source::Silence:
+        for (auto& buffer : m_inputBuffers)
+            std::fill_n(buffer.begin(), frames, 0.0f);
+        break;
+    }
+}
+
+void NullHexClient::renderGenerator(int frames) {
+    const int sr = m_currentSampleRate.load(std::memory_order_relaxed);
+    const auto pluckFrames = static_cast<std::uint64_t>(kPluckIntervalSec * sr);
+    for (int i = 0; i < frames; ++i, ++m_generatorFrame) {
+        if (m_generatorFrame % pluckFrames == 0) {
+            const int string = static_cast<int>(m_noteCounter % 6);
+            const int fret = static_cast<int>((m_noteCounter * 7) % 13);
+            Voice& voice = m_voices[static_cast<std::size_t>(string)];
+            voice.phase = 0.0;
+            voice.increment = static_cast<double>(midiToHz(kOpenStringMidi[static_cast<std::size_t>(string)] + fret)) / sr;
+            voice.amplitude = kPluckAmplitude;
+            ++m_noteCounter;
+        }
+        for (int s = 0; s < 6; ++s) {
+            Voice& voice = m_voices[static_cast<std::size_t>(s)];
+            float sample = 0.f;
+            if (voice.amplitude > 1.0e-5f) {
+                // Fundamental plus two decaying harmonics, roughly a plucked string.
+                const double w = 2.0 * M_PI * voice.phase;
+                sample = voice.amplitude * static_cast<float>(std::sin(w) + 0.5 * std::sin(2.0 * w) + 0.25 * std::sin(3.0 * w));
+                voice.phase += voice.increment;
+                voice.phase -= std::floor(voice.phase);
+                voice.amplitude *= m_decayPerSample;
+            }
+            m_inputBuffers[static_cast<std::size_t>(s)][static_cast<std::size_t>(i)] = sample;
+        }
+    }
+}
+
+void NullHexClient::renderFile(int frames) {
+    for (int i = 0; i < frames; ++i) {
+        for (int s = 0; s < 6; ++s)
+            m_inputBuffers[static_cast<std::size_t>(s)][static_cast<std::size_t>(i)] = m_fileTracks[static_cast<std::size_t>(s)][m_filePosition];
+        if (++m_filePosition >= m_fileFrames)
+            m_filePosition = 0;
+    }
+}
+
+bool NullHexClient::ensureMonitorSink() {
+    if (!m_monitorRequested.load(std::memory_order_acquire))
+        return false;
+    m_monitorActive.store(true, std::memory_order_release);
+    return true;
+}
+
+void NullHexClient::destroyMonitorSink() {
+    m_monitorActive.store(false, std::memory_order_release);
+}
+
+void NullHexClient::pushMonitorBlock(int frames) {
+    // The mix is computed exactly as for JACK; the null sink only meters it.
+    if (frames <= 0 || !m_monitorActive.load(std::memory_order_acquire))
+        return;
+    float peak = m_monitorPeak.load(std::memory_order_relaxed);
+    for (int i = 0; i < frames * 2; ++i)
+        peak = std::max(peak, std::fabs(m_monitorMixBuffer[static_cast<std::size_t>(i)]));
+    m_monitorPeak.store(peak, std::memory_order_relaxed);
+    m_monitorFrames.fetch_add(static_cast<std::uint64_t>(frames), std::memory_order_relaxed);
+}
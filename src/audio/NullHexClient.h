@@ -0,0 +1,87 @@
+#pragma once
+
+#include "HexCaptureClient.h"
+
+#include <QObject>
+#include <QString>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Hardware-free hex backend. A SCHED_FIFO thread wakes on absolute
+// CLOCK_MONOTONIC deadlines exactly one period apart and feeds the shared
+// capture path (calibration, meters, analysis worker, monitor mix) from a
+// looped recording, a pluck generator or silence. Lets the realtime pipeline
+// be benchmarked and soak-tested without jackd or the hex interface.
+// Selected with GUITARPI_HEX_BACKEND=null.
+class NullHexClient : public HexCaptureClient {
+    Q_OBJECT
+public:
+    enum class Source {
+        Silence,
+        Generator,
+        File
+    };
+
+    explicit NullHexClient(QObject* parent=nullptr);
+    ~NullHexClient() override;
+
+    bool start() override;
+    void stop() override;
+    void setBufferSize(int frames) override;
+    void setSampleRate(int sr) override;
+
+    // "silence", "generator", or a path to a directory of six mono WAVs (sorted
+    // by name, low E first) or a single six-channel WAV. Applies on next start().
+    void setSource(const QString& spec);
+    Source source() const noexcept { return m_source; }
+
+    static bool requestedByEnvironment();
+
+protected:
+    bool ensureMonitorSink() override;
+    void destroyMonitorSink() override;
+    void pushMonitorBlock(int frames) override;
+
+private:
+    struct Voice {
+        double phase {0.0};
+        double increment {0.0};
+        float amplitude {0.f};
+    };
+
+    void run();
+    void applySchedulingPolicy(int rtPriority);
+    bool loadFileSource();
+    void renderBlock(int frames);
+    void renderGenerator(int frames);
+    void renderFile(int frames);
+
+    std::thread m_thread;
+    std::atomic<bool> m_stopRequested {false};
+    int m_rtPriority {0};
+
+    Source m_source {Source::Silence};
+    Source m_activeSource {Source::Silence};   // m_source, or Silence when the file failed to load
+    QString m_sourcePath;
+    std::array<std::vector<float>, 6> m_fileTracks;
+    std::size_t m_fileFrames {0};
+    int m_fileSampleRate {0};
+    std::size_t m_filePosition {0};
+
+    std::array<Voice, 6> m_voices {};
+    std::uint64_t m_generatorFrame {0};
+    std::uint32_t m_noteCounter {0};
+    float m_decayPerSample {1.f};
+
+    std::array<std::vector<float>, 6> m_inputBuffers;
+
+    std::atomic<bool> m_monitorActive {false};
+    std::atomic<std::uint64_t> m_monitorFrames {0};
+    std::atomic<float> m_monitorPeak {0.f};
+
+    std::uint64_t m_periods {0};
+    std::int64_t m_maxWakeLateNs {0};
+};
@@ -0,0 +1,1653 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <new>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TabEngine.h"
+#include "EventFuser.h"
+#include "EventSerializer.h"
+#include "FretBank.h"
+#include "NoteDetectionStore.h"
+#include "PitchEstimator.h"
+#include "SessionLogger.h"
+#include "StringTracker.h"
+#include "StringTrackerParams.h"
+#include "SyntheticHexSource.h"
+#include "TraceRing.h"
+#include "TrackerRebuilder.h"
+#include "util.h"
+
+// Micro-benchmarks for the tab pipeline. Not part of the test suite; run
+// `tab_bench [name]` on the target (Pi) for numbers that matter.
+
+namespace {
+std::atomic<std::size_t> gAllocations {0};
+thread_local std::size_t tAllocations = 0;
+}
+
+// Every heap allocation in the process is counted, for `tab_bench alloc`, and
+// per thread, for `tab_bench rebuild`.
+void* operator new(std::size_t size) {
+  gAllocations.fetch_add(1, std::memory_order_relaxed);
+  ++tAllocations;
+  if (void* p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float kSampleRate = 48000.0f;
+constexpr int kBlockFrames = 128;
+constexpr float kSessionSec = 30.0f;
+
+// Plucked notes walking up the neck: a few decaying harmonics plus a noise
+// floor, so the silence skip in StringTracker never hides the work.
+std::vector<float> pluckedString(int openMidi, float seconds, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::normal_distribution<float> noise(0.f, 1.0e-4f);
+  const std::size_t total = static_cast<std::size_t>(seconds * kSampleRate);
+  std::vector<float> out(total);
+  const float noteSec = 0.5f;
+  for (std::size_t i = 0; i < total; ++i) {
+    const float t = static_cast<float>(i) / kSampleRate;
+    const int note = static_cast<int>(t / noteSec);
+    const float local = t - static_cast<float>(note) * noteSec;
+    const float hz = midiToHz(openMidi + (note * 5) % 25);
+    float v = 0.f;
+    for (int h = 1; h <= 5; ++h)
+      v += std::sin(2.f * float(M_PI) * hz * static_cast<float>(h) * local) / static_cast<float>(h * h);
+    out[i] = 0.2f * v * std::exp(-local * 5.f) + noise(rng);
+  }
+  return out;
+}
+
+// Pitch of pluckedString() at time t.
+float pluckedStringHz(int openMidi, float t) {
+  const int note = static_cast<int>(t / 0.5f);
+  return midiToHz(openMidi + (note * 5) % 25);
+}
+
+// Six mono WAVs from GUITARPI_BENCH_SESSION (a directory, sorted by name,
+// low E first), or nothing when unset or unreadable.
+bool loadBenchSession(std::array<std::vector<float>, 6>& out) {
+  const char* dir = std::getenv("GUITARPI_BENCH_SESSION");
+  if (!dir)
+    return false;
+  std::vector<std::string> paths;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+    if (entry.path().extension() == ".wav")
+      paths.push_back(entry.path().string());
+  }
+  std::sort(paths.begin(), paths.end());
+  if (paths.size() < 6) {
+    std::fprintf(stderr, "GUITARPI_BENCH_SESSION: need six mono WAVs in %s\n", dir);
+    return false;
+  }
+  for (std::size_t s = 0; s < 6; ++s) {
+    float sr = 0.f;
+    if (!loadWavMono(paths[s], out[s], sr) || std::fabs(sr - kSampleRate) > 1.f) {
+      std::fprintf(stderr, "GUITARPI_BENCH_SESSION: %s is not a %.0f Hz mono WAV\n", paths[s].c_str(), kSampleRate);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Tracker events against the plucks of pluckedString(): an event starting
+// within 60 ms of a pluck is a hit when it has the plucked note, a wrong note
+// otherwise; events away from any pluck, or a second event on one, are extra.
+struct PluckScore {
+  int plucks = 0;
+  int hits = 0;
+  int wrongNote = 0;
+  int extra = 0;
+  int missed() const { return plucks - hits - wrongNote; }
+};
+
+PluckScore scorePlucks(const std::vector<NoteEvent>& events, int openMidi, float seconds) {
+  constexpr float kNoteSec = 0.5f;
+  constexpr float kToleranceSec = 0.06f;
+  PluckScore score;
+  score.plucks = static_cast<int>(seconds / kNoteSec);
+  int lastMatched = -1;   // one tracker's events arrive in start order
+  for (const NoteEvent& ev : events) {
+    const int note = static_cast<int>(std::lround(ev.startSec / kNoteSec));
+    const float offset = ev.startSec - static_cast<float>(note) * kNoteSec;
+    if (note < 0 || note >= score.plucks || std::fabs(offset) > kToleranceSec || note == lastMatched) {
+      ++score.extra;
+      continue;
+    }
+    lastMatched = note;
+    if (ev.midi == openMidi + (note * 5) % 25)
+      ++score.hits;
+    else
+      ++score.wrongNote;
+  }
+  return score;
+}
+
+struct TrackerRun {
+  double usPerAudioSec = 0.0;
+  float analysisRate = 0.f;
+  std::size_t notes = 0;
+  std::vector<NoteEvent> events;
+};
+
+TrackerRun runTracker(int s, const std::vector<float>& audio, bool multirate, int blockFrames = kBlockFrames,
+                      bool spectral = false) {
+  Tuning tuning;
+  TrackerConfig cfg;
+  cfg.multirateLowStrings = multirate;
+  cfg.spectralFrontEnd = spectral;
+  NoteEventStore events;
+  std::vector<int> active(6, -1);
+  StringTracker tracker(s, tuning, cfg, events, active);
+
+  const std::size_t block = static_cast<std::size_t>(blockFrames);
+  const std::size_t blocks = audio.size() / block;
+  tracker.prepareBlock(kSampleRate, blockFrames);
+  const auto start = Clock::now();
+  for (std::size_t b = 0; b < blocks; ++b) {
+    const float t0 = static_cast<float>(b * block) / kSampleRate;
+    tracker.processBlock(audio.data() + b * block, blockFrames, kSampleRate, t0);
+    tracker.commitStagedEvents();
+  }
+  const double elapsedUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+  TrackerRun run;
+  run.usPerAudioSec = elapsedUs / (static_cast<double>(audio.size()) / kSampleRate);
+  run.analysisRate = tracker.analysisRate();
+  run.notes = events.size();
+  run.events.assign(events.begin(), events.end());
+  return run;
+}
+
+// Cost and accuracy of the decimated low strings against full rate. Scores
+// are hit/wrong-note/missed/extra against the plucks of pluckedString().
+int benchMultirate() {
+  std::printf("multirate: %.0f s per string, block %d @ %.0f Hz, %s\n", kSessionSec, kBlockFrames, kSampleRate,
+#ifdef HAVE_AUBIO
+              "aubio"
+#else
+              "spectral front end + native pitch"
+#endif
+  );
+  std::printf("string  rate(Hz)  full(us/s)  multi(us/s)  saved  full hit/wrong/miss/extra  multi hit/wrong/miss/extra\n");
+  Tuning tuning;
+  for (int s = 0; s < 6; ++s) {
+    const int openMidi = tuning.stringMidi[static_cast<std::size_t>(s)];
+    const auto audio = pluckedString(openMidi, kSessionSec, 17u + static_cast<unsigned>(s));
+    const TrackerRun full = runTracker(s, audio, false);
+    const TrackerRun multi = runTracker(s, audio, true);
+    const PluckScore fullScore = scorePlucks(full.events, openMidi, kSessionSec);
+    const PluckScore multiScore = scorePlucks(multi.events, openMidi, kSessionSec);
+    const double saved = full.usPerAudioSec > 0.0 ? 100.0 * (1.0 - multi.usPerAudioSec / full.usPerAudioSec) : 0.0;
+    std::printf("%6d  %8.0f  %10.1f  %11.1f  %4.0f%%  %10d/%d/%d/%d  %15d/%d/%d/%d\n",
+                s + 1,
+                static_cast<double>(multi.analysisRate),
+                full.usPerAudioSec,
+                multi.usPerAudioSec,
+                saved,
+                fullScore.hits, fullScore.wrongNote, fullScore.missed(), fullScore.extra,
+                multiScore.hits, multiScore.wrongNote, multiScore.missed(), multiScore.extra);
+  }
+  return 0;
+}
+
+// Analysis cost should not depend on the JACK period now that trackers
+// accumulate into a fixed hop.
+int benchHop() {
+  TrackerConfig cfg;
+  std::printf("hop: string 1, %.0f s, analysis hop %d @ %.0f Hz\n", kSessionSec, cfg.analysisHopSamples, kSampleRate);
+  std::printf("period  us/s      notes\n");
+  Tuning tuning;
+  const auto audio = pluckedString(tuning.stringMidi[0], kSessionSec, 17u);
+  for (const int period : {16, 32, 64, 128, 256, 512, 1024}) {
+    const TrackerRun run = runTracker(0, audio, false, period);
+    std::printf("%6d  %8.1f  %zu\n", period, run.usPerAudioSec, run.notes);
+  }
+  return 0;
+}
+
+// aubio onset + pitch (two windows, two transforms per hop, plus time-domain
+// YIN on the low strings) against the shared-FFT SpectralFrontEnd. Without
+// aubio both configurations run the front end, so only that column is real.
+int benchFrontEnd() {
+  std::printf("frontend: %.0f s per string, block %d @ %.0f Hz\n", kSessionSec, kBlockFrames, kSampleRate);
+#ifndef HAVE_AUBIO
+  std::printf("built without aubio: aubio column and saving are n/a\n");
+#endif
+  std::printf("string  aubio(us/s)  shared(us/s)  saved  aubio hit/wrong/miss/extra  shared hit/wrong/miss/extra\n");
+  Tuning tuning;
+  for (int s = 0; s < 6; ++s) {
+    const int openMidi = tuning.stringMidi[static_cast<std::size_t>(s)];
+    const auto audio = pluckedString(openMidi, kSessionSec, 17u + static_cast<unsigned>(s));
+    const TrackerRun shared = runTracker(s, audio, false, kBlockFrames, true);
+    const PluckScore sharedScore = scorePlucks(shared.events, openMidi, kSessionSec);
+#ifdef HAVE_AUBIO
+    const TrackerRun aubio = runTracker(s, audio, false, kBlockFrames, false);
+    const PluckScore aubioScore = scorePlucks(aubio.events, openMidi, kSessionSec);
+    const double saved = aubio.usPerAudioSec > 0.0 ? 100.0 * (1.0 - shared.usPerAudioSec / aubio.usPerAudioSec) : 0.0;
+    std::printf("%6d  %11.1f  %12.1f  %4.0f%%  %11d/%d/%d/%d  %12d/%d/%d/%d\n",
+                s + 1,
+                aubio.usPerAudioSec,
+                shared.usPerAudioSec,
+                saved,
+                aubioScore.hits, aubioScore.wrongNote, aubioScore.missed(), aubioScore.extra,
+                sharedScore.hits, sharedScore.wrongNote, sharedScore.missed(), sharedScore.extra);
+#else
+    std::printf("%6d  %11s  %12.1f  %5s  %26s  %12d/%d/%d/%d\n",
+                s + 1,
+                "n/a",
+                shared.usPerAudioSec,
+                "n/a",
+                "n/a",
+                sharedScore.hits, sharedScore.wrongNote, sharedScore.missed(), sharedScore.extra);
+#endif
+  }
+  return 0;
+}
+
+// Per-hop cost, octave errors and fret accuracy (within 50 cents) of aubio
+// yin / yinfast (sized to the tracker's FFT) against the native
+// lag-restricted PitchEstimator and the fret-constrained FretBank. The
+// reference is the known pitch of the generated notes, or aubio yin when
+// GUITARPI_BENCH_SESSION points at a recorded session.
+struct PitchRun {
+  double nsPerHop = 0.0;
+  std::vector<float> pitch; // per hop, -1 when unvoiced
+};
+
+template <typename Estimate>
+PitchRun runPitch(const std::vector<float>& audio, Estimate&& estimate) {
+  PitchRun run;
+  const std::size_t hops = audio.size() / static_cast<std::size_t>(kBlockFrames);
+  run.pitch.resize(hops);
+  const auto start = Clock::now();
+  for (std::size_t h = 0; h < hops; ++h)
+    run.pitch[h] = estimate(audio.data() + h * static_cast<std::size_t>(kBlockFrames));
+  const double elapsedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  run.nsPerHop = hops ? elapsedNs / static_cast<double>(hops) : 0.0;
+  return run;
+}
+
+struct PitchScore {
+  std::size_t voiced = 0;
+  std::size_t octave = 0;
+  std::size_t fret = 0;
+  std::size_t reference = 0;
+};
+
+PitchScore scorePitch(const PitchRun& run, const std::vector<float>& reference) {
+  PitchScore score;
+  for (std::size_t h = 0; h < run.pitch.size() && h < reference.size(); ++h) {
+    if (reference[h] <= 0.f)
+      continue;
+    ++score.reference;
+    if (run.pitch[h] <= 0.f)
+      continue;
+    ++score.voiced;
+    const float cents = std::fabs(centsBetween(run.pitch[h], reference[h]));
+    if (std::fabs(cents - 1200.f) < 100.f || std::fabs(cents - 2400.f) < 100.f)
+      ++score.octave;
+    if (cents < 50.f)
+      ++score.fret;
+  }
+  return score;
+}
+
+void printPitch(const char* name, const PitchRun& run, const PitchScore& score) {
+  const double voiced = static_cast<double>(score.voiced);
+  std::printf("        %-8s %9.0f  %6.1f%%  %6.2f%%  %6.1f%%\n",
+              name,
+              run.nsPerHop,
+              score.reference ? 100.0 * voiced / static_cast<double>(score.reference) : 0.0,
+              score.voiced ? 100.0 * static_cast<double>(score.octave) / voiced : 0.0,
+              score.voiced ? 100.0 * static_cast<double>(score.fret) / voiced : 0.0);
+}
+
+int benchPitch() {
+  std::array<std::vector<float>, 6> session;
+  const bool recorded = loadBenchSession(session);
+  std::printf("pitch: %s, hop %d @ %.0f Hz; octave errors vs %s\n",
+              recorded ? "recorded session" : "generated notes",
+              kBlockFrames,
+              kSampleRate,
+              recorded ? "aubio yin" : "the generated pitch");
+  std::printf("string  method     ns/hop   voiced  octave    fret\n");
+  Tuning tuning;
+  for (int s = 0; s < 6; ++s) {
+    const int openMidi = tuning.stringMidi[static_cast<std::size_t>(s)];
+    const std::vector<float> audio = recorded
+        ? session[static_cast<std::size_t>(s)]
+        : pluckedString(openMidi, kSessionSec, 17u + static_cast<unsigned>(s));
+    const std::size_t hops = audio.size() / static_cast<std::size_t>(kBlockFrames);
+    std::vector<float> reference(hops, -1.f);
+    if (!recorded) {
+      for (std::size_t h = 0; h < hops; ++h)
+        reference[h] = pluckedStringHz(openMidi, static_cast<float>((h + 1) * static_cast<std::size_t>(kBlockFrames)) / kSampleRate);
+    }
+    std::printf("%6d\n", s + 1);
+
+#ifdef HAVE_AUBIO
+    int fftSize = 1;
+    while (fftSize < kBlockFrames * std::max(trackerparams::fftMultiple(s), 4))
+      fftSize <<= 1;
+    for (const char* algo : {"yin", "yinfast"}) {
+      aubio_pitch_t* pitch = new_aubio_pitch(algo, static_cast<uint_t>(fftSize), static_cast<uint_t>(kBlockFrames),
+                                             static_cast<uint_t>(kSampleRate));
+      fvec_t* in = new_fvec(static_cast<uint_t>(kBlockFrames));
+      fvec_t* out = new_fvec(1);
+      aubio_pitch_set_unit(pitch, "Hz");
+      aubio_pitch_set_silence(pitch, trackerparams::pitchSilenceDb(s));
+      aubio_pitch_set_tolerance(pitch, trackerparams::pitchTolerance(s));
+      const PitchRun run = runPitch(audio, [&](const float* hop) {
+        std::copy(hop, hop + kBlockFrames, in->data);
+        aubio_pitch_do(pitch, in, out);
+        const float hz = fvec_get_sample(out, 0);
+        return hz > 0.f ? hz : -1.f;
+      });
+      if (recorded && std::strcmp(algo, "yin") == 0)
+        reference = run.pitch;
+      printPitch(algo, run, scorePitch(run, reference));
+      del_fvec(out);
+      del_fvec(in);
+      del_aubio_pitch(pitch);
+    }
+#endif
+
+    PitchEstimator estimator;
+    estimator.configure(kSampleRate, kBlockFrames, openMidi);
+    estimator.setTolerance(trackerparams::pitchTolerance(s));
+    estimator.setSilenceDb(trackerparams::pitchSilenceDb(s));
+    const PitchRun run = runPitch(audio, [&](const float* hop) { return estimator.process(hop, 1.f); });
+    printPitch("native", run, scorePitch(run, reference));
+
+    FretBank bank;
+    bank.configure(kSampleRate, kBlockFrames, openMidi);
+    bank.setTolerance(trackerparams::pitchTolerance(s));
+    bank.setSilenceDb(trackerparams::pitchSilenceDb(s));
+    const PitchRun bankRun = runPitch(audio, [&](const float* hop) { return bank.process(hop, 1.f).hz; });
+    printPitch("fretbank", bankRun, scorePitch(bankRun, reference));
+  }
+  return 0;
+}
+
+// Whole engine on a seeded synthetic hex phrase with ground truth: real-time
+// factor, events/sec the engine sustains, and detection latency (audio time
+// from the true onset to the block in which the event first appears).
+int benchSynthetic() {
+  constexpr float kPhraseNotesPerSec = 4.f;
+  constexpr float kPhraseArticulationRate = 0.3f;
+  constexpr float kMatchToleranceSec = 0.05f;
+
+  Tuning tuning;
+  SyntheticHexConfig synthCfg;
+  synthCfg.sampleRate = kSampleRate;
+  synthCfg.seed = 17u;
+  SyntheticHexSource source(tuning, synthCfg);
+  source.generatePhrase(kSessionSec, kPhraseNotesPerSec, kPhraseArticulationRate);
+  std::array<std::vector<float>, 6> audio;
+  source.render(audio);
+  const std::vector<NoteEvent> truth = source.groundTruth();
+
+  TrackerConfig cfg;
+  TabEngine engine(tuning, cfg);
+  engine.prepare(kSampleRate, kBlockFrames);
+  const std::size_t block = static_cast<std::size_t>(kBlockFrames);
+  const std::size_t blocks = source.frames() / block;
+  std::vector<float> firstSeenSec;
+  const auto start = Clock::now();
+  for (std::size_t b = 0; b < blocks; ++b) {
+    const float* channels[6];
+    for (std::size_t s = 0; s < 6; ++s)
+      channels[s] = audio[s].data() + b * block;
+    const float t0 = static_cast<float>(b * block) / kSampleRate;
+    engine.processBlock(channels, kBlockFrames, kSampleRate, t0);
+    const std::size_t count = engine.events().size();
+    if (count > firstSeenSec.size())
+      firstSeenSec.resize(count, t0 + static_cast<float>(kBlockFrames) / kSampleRate);
+  }
+  const double wallSec = std::chrono::duration<double>(Clock::now() - start).count();
+  const double audioSec = static_cast<double>(blocks * block) / kSampleRate;
+  const std::vector<NoteEvent> detected(engine.events().begin(), engine.events().end());
+
+  std::vector<float> latencies;
+  std::vector<bool> used(detected.size(), false);
+  for (const NoteEvent& t : truth) {
+    for (std::size_t i = 0; i < detected.size(); ++i) {
+      const NoteEvent& d = detected[i];
+      if (used[i] || d.stringIdx != t.stringIdx || d.fret != t.fret ||
+          std::fabs(d.startSec - t.startSec) > kMatchToleranceSec)
+        continue;
+      used[i] = true;
+      latencies.push_back(firstSeenSec[i] - t.startSec);
+      break;
+    }
+  }
+  std::sort(latencies.begin(), latencies.end());
+  float meanLatency = 0.f;
+  for (float l : latencies)
+    meanLatency += l;
+  if (!latencies.empty())
+    meanLatency /= static_cast<float>(latencies.size());
+  const float p95Latency = latencies.empty() ? 0.f : latencies[(latencies.size() - 1) * 95 / 100];
+
+  const SyntheticScore score = scoreEvents(truth, detected, kMatchToleranceSec);
+  std::printf("synthetic: %.0f s phrase, %.1f notes/s, %.0f%% articulated, block %d @ %.0f Hz\n",
+              kSessionSec, static_cast<double>(kPhraseNotesPerSec), 100.0 * kPhraseArticulationRate, kBlockFrames, kSampleRate);
+  std::printf("realtime factor  %.1fx (%.3f s wall)\n", audioSec / wallSec, wallSec);
+  std::printf("events/sec       %.0f truth events per wall second\n", static_cast<double>(truth.size()) / wallSec);
+  std::printf("detected         %zu of %zu truth events, recall %.2f precision %.2f\n",
+              score.matched, score.truth, static_cast<double>(score.recall()), static_cast<double>(score.precision()));
+  std::printf("latency          mean %.1f ms, p95 %.1f ms over %zu matches\n",
+              1000.0 * meanLatency, 1000.0 * p95Latency, latencies.size());
+  return 0;
+}
+
+struct GateRun {
+  double usPerAudioSec = 0.0;
+  SyntheticScore score;
+  std::array<TrackerGateStats, 6> gate {};
+};
+
+GateRun runGateEngine(const SyntheticHexSource& source, const std::array<std::vector<float>, 6>& audio, bool energyGate) {
+  Tuning tuning;
+  TrackerConfig cfg;
+  cfg.energyGate = energyGate;
+  TabEngine engine(tuning, cfg);
+  engine.prepare(kSampleRate, kBlockFrames);
+  const std::size_t block = static_cast<std::size_t>(kBlockFrames);
+  const std::size_t blocks = source.frames() / block;
+  const auto start = Clock::now();
+  for (std::size_t b = 0; b < blocks; ++b) {
+    const float* channels[6];
+    for (std::size_t s = 0; s < 6; ++s)
+      channels[s] = audio[s].data() + b * block;
+    engine.processBlock(channels, kBlockFrames, kSampleRate, static_cast<float>(b * block) / kSampleRate);
+  }
+  const double elapsedUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+  GateRun run;
+  run.usPerAudioSec = elapsedUs / (static_cast<double>(blocks * block) / kSampleRate);
+  std::vector<NoteEvent> finished;
+  for (const NoteEvent& ev : engine.events()) {
+    if (ev.endSec > ev.startSec)
+      finished.push_back(ev);
+  }
+  run.score = scoreEvents(source.groundTruth(), finished);
+  for (int s = 0; s < 6; ++s)
+    run.gate[static_cast<std::size_t>(s)] = engine.gateStats(s);
+  return run;
+}
+
+double skippedPercent(std::uint64_t skipped, std::uint64_t hops) {
+  return hops ? 100.0 * static_cast<double>(skipped) / static_cast<double>(hops) : 0.0;
+}
+
+// Energy gate on a full phrase and on one where only the low E and G strings
+// play (the others carry crosstalk and the noise floor): engine cost with the
+// gate off and on, recall either way, and the share of hops each string skips.
+int benchGate() {
+  Tuning tuning;
+  SyntheticHexConfig synthCfg;
+  synthCfg.sampleRate = kSampleRate;
+  synthCfg.seed = 17u;
+  SyntheticHexSource full(tuning, synthCfg);
+  full.generatePhrase(kSessionSec, 4.f, 0.3f);
+  SyntheticHexSource sparse(tuning, synthCfg);
+  for (const SyntheticNote& note : full.notes()) {
+    if (note.stringIdx == 0 || note.stringIdx == 3)
+      sparse.addNote(note);
+  }
+
+  std::printf("gate: %.0f s synthetic phrase, block %d @ %.0f Hz\n", kSessionSec, kBlockFrames, kSampleRate);
+  for (const SyntheticHexSource* source : {&full, &sparse}) {
+    std::array<std::vector<float>, 6> audio;
+    source->render(audio);
+    const GateRun off = runGateEngine(*source, audio, false);
+    const GateRun on = runGateEngine(*source, audio, true);
+    const double saved = off.usPerAudioSec > 0.0 ? 100.0 * (1.0 - on.usPerAudioSec / off.usPerAudioSec) : 0.0;
+    std::printf("%s (%zu notes)\n", source == &full ? "all strings" : "strings 1 and 4", source->notes().size());
+    std::printf("  off %8.1f us/s  recall %.2f precision %.2f\n",
+                off.usPerAudioSec, static_cast<double>(off.score.recall()), static_cast<double>(off.score.precision()));
+    std::printf("  on  %8.1f us/s  recall %.2f precision %.2f  saved %.0f%%\n",
+                on.usPerAudioSec, static_cast<double>(on.score.recall()), static_cast<double>(on.score.precision()), saved);
+    std::printf("  skipped pitch/onset:");
+    for (const TrackerGateStats& gate : on.gate)
+      std::printf("  %.0f/%.0f%%", skippedPercent(gate.pitchSkipped, gate.hops), skippedPercent(gate.onsetSkipped, gate.hops));
+    std::printf("\n");
+  }
+  return 0;
+}
+
+struct OnsetPitch {
+  float startSec = 0.f;
+  int midi = -1;
+  float pitchHz = -1.f;
+};
+
+// Note starts of one string tracker fed one analysis hop per block, with the
+// pitch the tracker reported on the hop that started each note.
+std::vector<OnsetPitch> runOnsetPitch(int s, const std::vector<float>& audio, const TrackerConfig& cfg) {
+  Tuning tuning;
+  NoteEventStore events;
+  std::vector<int> active(6, -1);
+  StringTracker tracker(s, tuning, cfg, events, active);
+  const int hop = cfg.analysisHopSamples;
+  const std::size_t block = static_cast<std::size_t>(hop);
+  tracker.prepareBlock(kSampleRate, hop);
+  std::vector<OnsetPitch> onsets;
+  for (std::size_t b = 0; b < audio.size() / block; ++b) {
+    tracker.processBlock(audio.data() + b * block, hop, kSampleRate, static_cast<float>(b * block) / kSampleRate);
+    const int before = events.endHandle();
+    tracker.commitStagedEvents();
+    for (int h = before; h < events.endHandle(); ++h)
+      onsets.push_back({events[h].startSec, events[h].midi, tracker.lastPitchHz()});
+  }
+  return onsets;
+}
+
+// Pitch of the ground-truth note starting nearest startSec on the string,
+// within 50 ms; -1 when there is none.
+int truthMidiAt(const SyntheticHexSource& source, const Tuning& tuning, int s, float startSec) {
+  int midi = -1;
+  float best = 0.05f;
+  for (const SyntheticNote& note : source.notes()) {
+    const float dt = std::fabs(note.startSec - startSec);
+    if (note.stringIdx == s && dt <= best) {
+      best = dt;
+      midi = tuning.stringMidi[s] + note.fret;
+    }
+  }
+  return midi;
+}
+
+// Energy gate against its effect on the estimators' windows: per pitch
+// source, note starts found with the gate off and on, the cents between the
+// two onset-hop pitches (a window resuming on the audio before a quiet gap
+// shows up here), and how many of the matched notes carry the ground-truth
+// pitch either way. Fails when an onset-hop pitch moves by more than a cent.
+int benchGateOnset() {
+  Tuning tuning;
+  SyntheticHexConfig synthCfg;
+  synthCfg.sampleRate = kSampleRate;
+  synthCfg.seed = 17u;
+  SyntheticHexSource source(tuning, synthCfg);
+  source.generatePhrase(kSessionSec, 4.f, 0.3f);
+  std::array<std::vector<float>, 6> audio;
+  source.render(audio);
+
+  struct Source {
+    const char* name;
+    bool nativePitch;
+    unsigned fretBank;
+  };
+  constexpr Source kSources[] = {
+      {"default", false, 0u},
+      {"native", true, 0u},
+      {"fretbank", false, 0x3Fu},
+  };
+  std::printf("gateonset: %.0f s synthetic phrase, one hop per block\n", kSessionSec);
+  std::printf("source     onsets off/on  matched  cents mean/max  truth midi off/on\n");
+  int status = 0;
+  for (const Source& pitch : kSources) {
+    std::size_t off = 0;
+    std::size_t on = 0;
+    std::size_t matched = 0;
+    std::size_t truthOff = 0;
+    std::size_t truthOn = 0;
+    std::size_t voiced = 0;
+    double centsSum = 0.0;
+    double centsMax = 0.0;
+    for (int s = 0; s < 6; ++s) {
+      TrackerConfig cfg;
+      cfg.nativePitch = pitch.nativePitch;
+      cfg.fretBankStrings = pitch.fretBank;
+      const std::vector<float>& samples = audio[static_cast<std::size_t>(s)];
+      const std::vector<OnsetPitch> ungated = runOnsetPitch(s, samples, cfg);
+      cfg.energyGate = true;
+      const std::vector<OnsetPitch> gated = runOnsetPitch(s, samples, cfg);
+      off += ungated.size();
+      on += gated.size();
+      const float hopSec = static_cast<float>(cfg.analysisHopSamples) / kSampleRate;
+      std::size_t j = 0;
+      for (const OnsetPitch& a : ungated) {
+        while (j < gated.size() && gated[j].startSec < a.startSec - 0.5f * hopSec)
+          ++j;
+        if (j == gated.size() || gated[j].startSec > a.startSec + 0.5f * hopSec)
+          continue;
+        const OnsetPitch& b = gated[j++];
+        ++matched;
+        const int truth = truthMidiAt(source, tuning, s, a.startSec);
+        truthOff += (a.midi == truth);
+        truthOn += (b.midi == truth);
+        if (a.pitchHz > 0.f && b.pitchHz > 0.f) {
+          const double cents = std::fabs(static_cast<double>(centsBetween(b.pitchHz, a.pitchHz)));
+          centsSum += cents;
+          centsMax = std::max(centsMax, cents);
+          ++voiced;
+        }
+      }
+    }
+    const double centsMean = voiced ? centsSum / static_cast<double>(voiced) : 0.0;
+    std::printf("%-9s  %6zu/%-6zu  %7zu  %6.2f/%-6.2f   %6zu/%zu\n",
+                pitch.name, off, on, matched, centsMean, centsMax, truthOff, truthOn);
+    if (centsMax > 1.0)
+      status = 1;
+  }
+  return status;
+}
+
+// Let-ring chords (all six strings struck together and held) with the full
+// pitch estimate on every hop and on every 4th / 8th hop of a stable sustain,
+// the drift probe following the notes in between. Pitch from aubio, from the
+// shared-FFT front end, and from PitchEstimator next to the front end's onsets
+// (the no-aubio build, which has only that row). The stride leaves
+// PitchEstimator at every hop, so its rows should match stride 1.
+int benchSustain() {
+  constexpr float kChordSec = 2.f;
+  constexpr int kShapes[][6] = {
+      {0, 2, 2, 1, 0, 0}, {3, 2, 0, 0, 0, 3}, {0, 0, 2, 2, 2, 0}, {1, 3, 3, 2, 1, 1}, {0, 2, 2, 0, 1, 0}};
+
+  Tuning tuning;
+  SyntheticHexConfig synthCfg;
+  synthCfg.sampleRate = kSampleRate;
+  synthCfg.seed = 17u;
+  SyntheticHexSource source(tuning, synthCfg);
+  const int chords = static_cast<int>(kSessionSec / kChordSec);
+  for (int c = 0; c < chords; ++c) {
+    const int* shape = kShapes[c % static_cast<int>(std::size(kShapes))];
+    for (int s = 0; s < 6; ++s) {
+      SyntheticNote note;
+      note.stringIdx = s;
+      note.fret = shape[s];
+      note.startSec = static_cast<float>(c) * kChordSec + 0.01f * static_cast<float>(s);
+      note.durationSec = kChordSec - 0.1f;
+      source.addNote(note);
+    }
+  }
+  std::array<std::vector<float>, 6> audio;
+  source.render(audio);
+  const std::vector<NoteEvent> truth = source.groundTruth();
+
+  std::printf("sustain: %d chords of %.0f s, block %d @ %.0f Hz\n", chords, static_cast<double>(kChordSec), kBlockFrames, kSampleRate);
+  std::printf("pitch   stride  us/s      saved  probed  recall  precision\n");
+  const char* const kPitchNames[] = {"aubio", "shared", "native"};
+#ifdef HAVE_AUBIO
+  for (int pitch = 0; pitch < 3; ++pitch) {
+#else
+  for (int pitch = 2; pitch < 3; ++pitch) {
+#endif
+    double baseline = 0.0;
+    for (const int stride : {1, 4, 8}) {
+      TrackerConfig cfg;
+      cfg.spectralFrontEnd = pitch > 0;
+      cfg.nativePitch = pitch == 2;
+      cfg.sustainPitchStride = stride;
+      TabEngine engine(tuning, cfg);
+      engine.prepare(kSampleRate, kBlockFrames);
+      const std::size_t block = static_cast<std::size_t>(kBlockFrames);
+      const std::size_t blocks = source.frames() / block;
+      const auto start = Clock::now();
+      for (std::size_t b = 0; b < blocks; ++b) {
+        const float* channels[6];
+        for (std::size_t s = 0; s < 6; ++s)
+          channels[s] = audio[s].data() + b * block;
+        engine.processBlock(channels, kBlockFrames, kSampleRate, static_cast<float>(b * block) / kSampleRate);
+      }
+      const double elapsedUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+      const double usPerSec = elapsedUs / (static_cast<double>(blocks * block) / kSampleRate);
+      if (stride == 1)
+        baseline = usPerSec;
+
+      std::uint64_t hops = 0;
+      std::uint64_t probed = 0;
+      for (int s = 0; s < 6; ++s) {
+        const TrackerGateStats gate = engine.gateStats(s);
+        hops += gate.hops;
+        probed += gate.pitchProbed;
+      }
+      std::vector<NoteEvent> finished;
+      for (const NoteEvent& ev : engine.events()) {
+        if (ev.endSec > ev.startSec)
+          finished.push_back(ev);
+      }
+      const SyntheticScore score = scoreEvents(truth, finished);
+      std::printf("%-6s  %6d  %8.1f  %4.0f%%  %5.1f%%  %6.2f  %9.2f\n",
+                  kPitchNames[pitch],
+                  stride,
+                  usPerSec,
+                  baseline > 0.0 ? 100.0 * (1.0 - usPerSec / baseline) : 0.0,
+                  hops ? 100.0 * static_cast<double>(probed) / static_cast<double>(hops) : 0.0,
+                  static_cast<double>(score.recall()),
+                  static_cast<double>(score.precision()));
+    }
+  }
+  return 0;
+}
+
+// Heap allocations once the trackers are warm (the first seconds configure
+// DSP state and size the buffers). The tracker rows reserve the shared event
+// list up front, so they count StringTracker alone; the engine row includes
+// the event list growing as notes arrive.
+int benchAlloc() {
+  constexpr float kWarmupSec = 2.f;
+
+  Tuning tuning;
+  SyntheticHexConfig synthCfg;
+  synthCfg.sampleRate = kSampleRate;
+  synthCfg.seed = 17u;
+  SyntheticHexSource source(tuning, synthCfg);
+  source.generatePhrase(kSessionSec, 4.f, 0.3f);
+  std::array<std::vector<float>, 6> audio;
+  source.render(audio);
+  const std::size_t block = static_cast<std::size_t>(kBlockFrames);
+  const std::size_t blocks = source.frames() / block;
+  const std::size_t warmup = static_cast<std::size_t>(kWarmupSec * kSampleRate) / block;
+
+  std::printf("alloc: %.0f s phrase after %.0f s warm-up, block %d @ %.0f Hz\n",
+              kSessionSec - kWarmupSec, static_cast<double>(kWarmupSec), kBlockFrames, kSampleRate);
+  if (SessionLogger::instance().enabled())
+    std::printf("session log on (%s): its lines allocate too; point SIGNALASSISTANT_LOG_DIR at an "
+                "unwritable path to count the trackers alone\n",
+                SessionLogger::instance().logFilePath().c_str());
+  std::printf("pitch   s1    s2    s3    s4    s5    s6    engine  events\n");
+  const char* const kPitchNames[] = {"aubio", "native"};
+  for (int pitch = 0; pitch < 2; ++pitch) {
+    TrackerConfig cfg;
+    cfg.spectralFrontEnd = pitch == 1;
+    cfg.nativePitch = pitch == 1;
+    std::printf("%-6s", kPitchNames[pitch]);
+    for (int s = 0; s < 6; ++s) {
+      NoteEventStore events;
+      events.reserve(4096);
+      std::vector<int> active(6, -1);
+      StringTracker tracker(s, tuning, cfg, events, active);
+      tracker.prepareBlock(kSampleRate, kBlockFrames);
+      std::size_t before = 0;
+      for (std::size_t b = 0; b < blocks; ++b) {
+        if (b == warmup)
+          before = gAllocations.load(std::memory_order_relaxed);
+        tracker.processBlock(audio[static_cast<std::size_t>(s)].data() + b * block, kBlockFrames, kSampleRate,
+                             static_cast<float>(b * block) / kSampleRate);
+        tracker.commitStagedEvents();
+      }
+      std::printf("  %4zu", gAllocations.load(std::memory_order_relaxed) - before);
+    }
+
+    TabEngine engine(tuning, cfg);
+    engine.prepare(kSampleRate, kBlockFrames);
+    std::size_t before = 0;
+    for (std::size_t b = 0; b < blocks; ++b) {
+      if (b == warmup)
+        before = gAllocations.load(std::memory_order_relaxed);
+      const float* channels[6];
+      for (std::size_t s = 0; s < 6; ++s)
+        channels[s] = audio[s].data() + b * block;
+      engine.processBlock(channels, kBlockFrames, kSampleRate, static_cast<float>(b * block) / kSampleRate);
+    }
+    std::printf("    %6zu  %6zu\n", gAllocations.load(std::memory_order_relaxed) - before, engine.events().size());
+  }
+  return 0;
+}
+
+// The per-string parameter values detectOnset() and noteShouldClose() read
+// each hop, fetched through the store's helpers one atomic at a time and from
+// a TrackerParamSnapshot; then the same reads while another thread flips the
+// whole store between two sets, counting reads that mix the two.
+float sumHelpers(int s) {
+  return trackerparams::lowCutMultiplier(s) + trackerparams::highCutMultiplier(s)
+      + trackerparams::onsetThresholdScale(s, 1.f) + trackerparams::baselineFloor(s) + trackerparams::gateRatio(s)
+      + trackerparams::envelopeFloor(s) + trackerparams::peakReleaseRatio(s) + trackerparams::sustainFloorScale(s)
+      + trackerparams::retriggerGateScale(s) + trackerparams::pitchTolerance(s)
+      + trackerparams::aubioThresholdScale(s) + trackerparams::onsetSilenceDb(s) + trackerparams::pitchSilenceDb(s);
+}
+
+float sumSnapshot(const trackerparams::TrackerParamSnapshot& p) {
+  return p.lowCutMultiplier + p.highCutMultiplier + p.onsetThreshold(1.f) + p.baselineFloor + p.gateRatio
+      + p.envelopeFloor + p.peakReleaseRatio + p.sustainFloorScale + p.retriggerGateScale + p.pitchTolerance
+      + p.aubioThresholdScale + p.onsetSilenceDb + p.pitchSilenceDb;
+}
+
+NoteDetectionParameterSet scaledParameters(const NoteDetectionParameterSet& source, float scale) {
+  NoteDetectionParameterSet out = source;
+  for (auto* arr : {&out.onsetThresholdScale, &out.baselineFloor, &out.envelopeFloor, &out.gateRatio,
+                    &out.sustainFloorScale, &out.retriggerGateScale, &out.peakReleaseRatio, &out.pitchTolerance,
+                    &out.targetRms, &out.calibrationGainMultiplier, &out.lowCutMultiplier, &out.highCutMultiplier,
+                    &out.aubioThresholdScale, &out.onsetSilenceDb, &out.pitchSilenceDb}) {
+    for (float& v : *arr)
+      v *= scale;
+  }
+  return out;
+}
+
+int benchParams() {
+  constexpr int kReads = 2000000;
+  constexpr int kString = 2;
+  auto& store = NoteDetectionStore::instance();
+  const NoteDetectionParameterSet original = store.snapshotCurrent();
+
+  std::printf("params: %d reads of the %d per-string values the tracker uses (string %d)\n", kReads, 13, kString + 1);
+  volatile float sink = 0.f;
+  auto start = Clock::now();
+  for (int i = 0; i < kReads; ++i)
+    sink = sink + sumHelpers(kString);
+  const double helperNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / kReads;
+
+  trackerparams::TrackerParamSnapshot snapshot;
+  start = Clock::now();
+  for (int i = 0; i < kReads; ++i)
+    sink = sink + sumSnapshot(snapshot);
+  const double snapshotNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / kReads;
+
+  int pulled = 0;
+  start = Clock::now();
+  for (int i = 0; i < kReads / 10; ++i)
+    pulled += trackerparams::pullSnapshot(kString, snapshot) ? 1 : 0;
+  const double pullNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (kReads / 10);
+  std::printf("  helpers   %7.1f ns per read\n", helperNs);
+  std::printf("  snapshot  %7.1f ns per read, %.1f ns per pull (only when the generation moves)\n", snapshotNs, pullNs);
+
+  // Every value in b is twice its counterpart in a, so a consistent read sums
+  // to exactly one of the two totals.
+  const NoteDetectionParameterSet a = original;
+  const NoteDetectionParameterSet b = scaledParameters(original, 2.f);
+  store.applyCurrentSnapshot(a);
+  const float sumA = sumHelpers(kString);
+  store.applyCurrentSnapshot(b);
+  const float sumB = sumHelpers(kString);
+
+  std::atomic<bool> stop {false};
+  std::thread writer([&]() {
+    bool flip = false;
+    while (!stop.load(std::memory_order_relaxed)) {
+      store.applyCurrentSnapshot(flip ? a : b);
+      flip = !flip;
+    }
+  });
+  int tornHelpers = 0;
+  int tornSnapshots = 0;
+  int missed = 0;
+  for (int i = 0; i < kReads / 10; ++i) {
+    const float helper = sumHelpers(kString);
+    if (helper != sumA && helper != sumB)
+      ++tornHelpers;
+    if (!trackerparams::pullSnapshot(kString, snapshot)) {
+      ++missed;
+      continue;
+    }
+    const float pulledSum = sumSnapshot(snapshot);
+    if (pulledSum != sumA && pulledSum != sumB)
+      ++tornSnapshots;
+  }
+  stop.store(true);
+  writer.join();
+  store.applyCurrentSnapshot(original);
+
+  std::printf("  under a writer flipping the whole set, %d reads each:\n", kReads / 10);
+  std::printf("  helpers   %6d mixed\n", tornHelpers);
+  std::printf("  snapshot  %6d mixed, %d pulls deferred to the next block\n", tornSnapshots, missed);
+  return tornSnapshots == 0 && pulled > 0 ? 0 : 1;
+}
+
+constexpr std::size_t kEditEveryBlocks = 20;
+
+struct EditRun {
+  double editUs = 0.0;          // mean of the blocks that pick up an edit
+  double otherUs = 0.0;         // mean of the rest
+  double worstUs = 0.0;
+  std::size_t allocations = 0;  // on the processing thread
+  std::uint64_t builds = 0;     // analysis states installed after the first
+};
+
+// Runs six trackers over audio, calling edit(flip) every kEditEveryBlocks
+// blocks after the first kEditEveryBlocks, which are not measured. The first
+// configuration is built by prepare() before the loop.
+template <typename Edit>
+EditRun runEdits(const Tuning& tuning, const TrackerConfig& cfg, const std::array<std::vector<float>, 6>& audio,
+                 std::size_t blocks, bool threaded, Edit edit) {
+  NoteEventStore events;
+  events.reserve(4096);
+  std::vector<int> active(6, -1);
+  std::array<std::optional<StringTracker>, 6> trackers;
+  std::vector<StringTracker*> raw;
+  for (int s = 0; s < 6; ++s)
+    raw.push_back(&trackers[static_cast<std::size_t>(s)].emplace(s, tuning, cfg, events, active));
+  std::optional<TrackerRebuilder> rebuilder;
+  if (threaded) {
+    rebuilder.emplace(raw);
+    for (StringTracker* tracker : raw)
+      tracker->setRebuilder(&*rebuilder);
+  }
+
+  for (StringTracker* tracker : raw)
+    tracker->prepare(kSampleRate, kBlockFrames);
+
+  EditRun run;
+  const std::size_t block = static_cast<std::size_t>(kBlockFrames);
+  std::size_t editBlocks = 0;
+  std::uint64_t warmBuilds = 0;
+  bool flip = false;
+  for (std::size_t b = 0; b < blocks; ++b) {
+    if (b == kEditEveryBlocks) {
+      for (StringTracker* tracker : raw)
+        warmBuilds += tracker->dspBuilds();
+    }
+    if (b >= kEditEveryBlocks && b % kEditEveryBlocks == 0) {
+      edit(flip);
+      flip = !flip;
+    }
+    const std::size_t before = tAllocations;
+    const auto start = Clock::now();
+    for (std::size_t s = 0; s < 6; ++s) {
+      raw[s]->prepareBlock(kSampleRate, kBlockFrames);
+      raw[s]->processBlock(audio[s].data() + b * block, kBlockFrames, kSampleRate,
+                           static_cast<float>(b * block) / kSampleRate);
+      raw[s]->commitStagedEvents();
+    }
+    const double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    if (b >= kEditEveryBlocks) {
+      run.worstUs = std::max(run.worstUs, us);
+      if (b % kEditEveryBlocks == 0) {
+        run.editUs += us;
+        ++editBlocks;
+      } else {
+        run.otherUs += us;
+      }
+      run.allocations += tAllocations - before;
+    }
+  }
+  // Stop the rebuilder before the trackers it services.
+  rebuilder.reset();
+  for (StringTracker* tracker : raw)
+    run.builds += tracker->dspBuilds();
+  run.builds -= warmBuilds;
+  const std::size_t measured = blocks > kEditEveryBlocks ? blocks - kEditEveryBlocks : 0;
+  run.editUs = editBlocks ? run.editUs / static_cast<double>(editBlocks) : 0.0;
+  run.otherUs = measured > editBlocks ? run.otherUs / static_cast<double>(measured - editBlocks) : 0.0;
+  return run;
+}
+
+// Parameter edits during a phrase, as in a slider drag. First every 20 blocks
+// the whole store flips between two sets: mean time of the blocks that pick
+// up an edit and of the rest, worst block, and the heap allocations made on
+// the processing thread, with the DSP state rebuilt inline and on
+// TrackerRebuilder's thread (where the edit lands a block or two later).
+// Then one key on one string at a time, on the rebuilder: only the stage the
+// key feeds is touched, so most edits rebuild nothing.
+int benchRebuild() {
+  Tuning tuning;
+  SyntheticHexConfig synthCfg;
+  synthCfg.sampleRate = kSampleRate;
+  synthCfg.seed = 17u;
+  SyntheticHexSource source(tuning, synthCfg);
+  source.generatePhrase(10.f, 4.f, 0.3f);
+  std::array<std::vector<float>, 6> audio;
+  source.render(audio);
+  const std::size_t blocks = source.frames() / static_cast<std::size_t>(kBlockFrames);
+
+  auto& store = NoteDetectionStore::instance();
+  const NoteDetectionParameterSet original = store.snapshotCurrent();
+  const NoteDetectionParameterSet edited = scaledParameters(original, 1.05f);
+
+  std::printf("rebuild: 10 s phrase, 6 trackers, an edit every %zu blocks (block %d @ %.0f Hz)\n",
+              kEditEveryBlocks, kBlockFrames, kSampleRate);
+  std::printf("pitch   build      edit us  other us  worst us  allocs  builds\n");
+  const char* const kPitchNames[] = {"aubio", "native"};
+  for (int pitch = 0; pitch < 2; ++pitch) {
+    TrackerConfig cfg;
+    cfg.spectralFrontEnd = pitch == 1;
+    cfg.nativePitch = pitch == 1;
+    for (int threaded = 0; threaded < 2; ++threaded) {
+      store.applyCurrentSnapshot(original);
+      const EditRun run = runEdits(tuning, cfg, audio, blocks, threaded != 0, [&](bool flip) {
+        store.applyCurrentSnapshot(flip ? original : edited);
+      });
+      std::printf("%-6s  %-9s  %7.1f  %8.1f  %8.1f  %6zu  %6llu\n",
+                  kPitchNames[pitch],
+                  threaded ? "rebuilder" : "inline",
+                  run.editUs,
+                  run.otherUs,
+                  run.worstUs,
+                  run.allocations,
+                  static_cast<unsigned long long>(run.builds));
+    }
+  }
+
+  // Low E decimates under multirate, so its high cut moves the decimator's
+  // passband; the G string's high cut only retunes the band-pass.
+  struct KeyEdit {
+    const char* key;
+    int string;
+  };
+  constexpr KeyEdit kKeyEdits[] = {
+      {"gateRatio", 3},
+      {"pitchTolerance", 3},
+      {"aubioThresholdScale", 3},
+      {"lowCutMultiplier", 3},
+      {"highCutMultiplier", 3},
+      {"highCutMultiplier", 0},
+  };
+  TrackerConfig cfg;
+  cfg.spectralFrontEnd = true;
+  cfg.nativePitch = true;
+  cfg.multirateLowStrings = true;
+  std::printf("one key on one string (native pitch, multirate, rebuilder)\n");
+  std::printf("key                   string  edit us  other us  allocs  builds\n");
+  for (const KeyEdit& keyEdit : kKeyEdits) {
+    store.applyCurrentSnapshot(original);
+    const float base = store.currentValueFromKey(keyEdit.key, keyEdit.string);
+    const EditRun run = runEdits(tuning, cfg, audio, blocks, true, [&](bool flip) {
+      store.setValueFromKey(keyEdit.key, keyEdit.string, flip ? base : base * 1.05f);
+    });
+    std::printf("%-20s  %6d  %7.1f  %8.1f  %6zu  %6llu\n",
+                keyEdit.key,
+                keyEdit.string + 1,
+                run.editUs,
+                run.otherUs,
+                run.allocations,
+                static_cast<unsigned long long>(run.builds));
+  }
+  store.applyCurrentSnapshot(original);
+  return 0;
+}
+
+// Producer cost of one onset-decision trace (22 values), as a formatted
+// SessionLogger line and as a binary trace record. Rounds stay under a trace
+// ring's capacity and pause for the logger to drain, so nothing is dropped.
+int benchTrace() {
+  constexpr int kRounds = 20;
+  constexpr int kPerRound = 500;
+  auto& logger = SessionLogger::instance();
+  if (!logger.enabled() || !trace::enabled()) {
+    std::printf("trace: session log off; point SIGNALASSISTANT_LOG_DIR at a writable path\n");
+    return 0;
+  }
+  trace::prepareThread();
+  float v[22];
+  for (int i = 0; i < 22; ++i)
+    v[i] = 0.001f * static_cast<float>(i + 1);
+
+  std::printf("trace: %d onset-decision records in rounds of %d\n", kRounds * kPerRound, kPerRound);
+  std::printf("path     ns/record  allocs/record\n");
+  for (int binary = 0; binary < 2; ++binary) {
+    double ns = 0.0;
+    std::size_t allocations = 0;
+    for (int round = 0; round < kRounds; ++round) {
+      const std::size_t before = tAllocations;
+      const auto start = Clock::now();
+      for (int i = 0; i < kPerRound; ++i) {
+        const float t = static_cast<float>(round * kPerRound + i) * 0.00267f;
+        if (binary) {
+          trace::emit(trace::Event::OnsetBelowGate, 0, t,
+                      {v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10],
+                       v[11], v[12], v[13], v[14], v[15], v[16], v[17], v[18], v[19], v[20], v[21]});
+        } else {
+          logger.logf("tracker",
+                      "[s%d] onset-%s t=%.4f env=%.6f gate=%.6f envDelta=%.6f envFloor=%.6f onset=%.6f thresh=%.6f onsetDelta=%.6f baseline=%.6f floor=%.6f adapt=%.6f lastPeak=%.6f baseParam=%.6f gateRatio=%.4f envParam=%.6f onsetScale=%.3f retriggerScale=%.3f guard=%.3f guardRemain=%.3f activeAge=%.3f retrigRemain=%.3f pitchHz=%.2f pitchCents=%.1f",
+                      1, "below-gate", t, v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10],
+                      v[11], v[12], v[13], v[14], v[15], v[16], v[17], v[18], v[19], v[20], v[21]);
+        }
+      }
+      ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+      allocations += tAllocations - before;
+      std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    }
+    const double records = static_cast<double>(kRounds * kPerRound);
+    std::printf("%-7s  %9.1f  %13.2f\n", binary ? "binary" : "logf", ns / records,
+                static_cast<double>(allocations) / records);
+  }
+  return 0;
+}
+
+// SessionLogger under contention: kThreads producers log short lines flat
+// out, far faster than the worker drains, so most are dropped. Cost per line
+// on the producers, allocations, and the drops the logger counted (and
+// reported in the log).
+int benchLogger() {
+  constexpr int kThreads = 4;
+  constexpr int kLinesPerThread = 20000;
+  auto& logger = SessionLogger::instance();
+  if (!logger.enabled()) {
+    std::printf("logger: session log off; point SIGNALASSISTANT_LOG_DIR at a writable path\n");
+    return 0;
+  }
+  const std::uint64_t droppedBefore = logger.droppedLines();
+  std::atomic<std::size_t> allocations {0};
+  std::atomic<bool> go {false};
+  std::vector<std::thread> producers;
+  std::vector<double> ns(kThreads, 0.0);
+  for (int t = 0; t < kThreads; ++t) {
+    producers.emplace_back([&, t]() {
+      while (!go.load(std::memory_order_acquire)) {}
+      const std::size_t before = tAllocations;
+      const auto start = Clock::now();
+      for (int i = 0; i < kLinesPerThread; ++i)
+        logger.logf("bench", "producer=%d line=%d value=%.3f", t, i, 0.001 * i);
+      ns[static_cast<std::size_t>(t)] = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+      allocations.fetch_add(tAllocations - before);
+    });
+  }
+  go.store(true, std::memory_order_release);
+  for (auto& producer : producers)
+    producer.join();
+
+  double totalNs = 0.0;
+  for (double v : ns)
+    totalNs += v;
+  const double lines = static_cast<double>(kThreads) * kLinesPerThread;
+  const std::uint64_t dropped = logger.droppedLines() - droppedBefore;
+  std::printf("logger: %d threads x %d lines, no pauses\n", kThreads, kLinesPerThread);
+  std::printf("  %.1f ns/line, %.2f allocs/line, %llu dropped (%.1f%%)\n",
+              totalNs / lines,
+              static_cast<double>(allocations.load()) / lines,
+              static_cast<unsigned long long>(dropped),
+              100.0 * static_cast<double>(dropped) / lines);
+  return 0;
+}
+
+// TabEngine's articulation pass as it was before EventFuser: every finished
+// event against the previous finished one on its string, every block.
+void rescanFusion(std::vector<NoteEvent>& events) {
+  std::array<int, 6> lastFinished{};
+  lastFinished.fill(-1);
+  const int total = static_cast<int>(events.size());
+  for (int i = 0; i < total; ++i) {
+    auto& ev = events[static_cast<std::size_t>(i)];
+    if (ev.stringIdx < 0 || ev.stringIdx >= 6 || ev.endSec <= ev.startSec)
+      continue;
+    const int prevIdx = lastFinished[static_cast<std::size_t>(ev.stringIdx)];
+    if (prevIdx >= 0) {
+      auto& prev = events[static_cast<std::size_t>(prevIdx)];
+      const float gap = ev.startSec - prev.endSec;
+      if (prev.endSec > prev.startSec && gap >= 0.f && gap < 0.12f) {
+        const int delta = ev.fret - prev.fret;
+        const int absDelta = delta >= 0 ? delta : -delta;
+        if (absDelta >= 2) {
+          if (ev.articulation == Articulation::None)
+            ev.articulation = Articulation::Slide;
+          if (prev.articulation == Articulation::None)
+            prev.articulation = Articulation::Slide;
+        } else if (delta == 1 || delta == 2) {
+          if (ev.articulation == Articulation::None)
+            ev.articulation = Articulation::Hammer;
+        } else if (delta == -1 || delta == -2) {
+          if (ev.articulation == Articulation::None)
+            ev.articulation = Articulation::Pull;
+        } else if (absDelta == 0 && gap < 0.06f) {
+          if (ev.velocity < prev.velocity * 0.7f && ev.articulation == Articulation::None)
+            ev.articulation = Articulation::PalmMute;
+        }
+      }
+    }
+    if (ev.articulation == Articulation::None && ev.endSec - ev.startSec < 0.18f && ev.velocity < 0.30f)
+      ev.articulation = Articulation::PalmMute;
+    lastFinished[static_cast<std::size_t>(ev.stringIdx)] = i;
+  }
+}
+
+// An hour of events as the trackers would append them (about four notes a
+// second, legato and muted notes included), fused after every block by the
+// old full rescan and by EventFuser. Mean fusion time per block in a few
+// minutes of the hour, and whether the articulations agree at the end.
+int benchFusion() {
+  constexpr float kHourSec = 3600.f;
+  constexpr int kFusionBlockFrames = 1024;   // the rescan is too slow to run an hour at 128
+  constexpr float kNotesPerSec = 4.f;
+  const float blockSec = static_cast<float>(kFusionBlockFrames) / kSampleRate;
+  const std::size_t blocks = static_cast<std::size_t>(kHourSec / blockSec);
+  const std::size_t blocksPerMinute = static_cast<std::size_t>(60.f / blockSec);
+
+  std::mt19937 rng(23u);
+  std::uniform_real_distribution<float> unit(0.f, 1.f);
+  std::uniform_int_distribution<int> step(-3, 3);
+  std::vector<NoteEvent> rescanned;
+  NoteEventStore fused;
+  rescanned.reserve(32768);
+  fused.reserve(32768);
+  std::vector<int> active(6, -1);
+  std::array<float, 6> plannedEnd {};
+  std::array<int, 6> lastFret {5, 5, 5, 5, 5, 5};
+  EventFuser fuser;
+
+  constexpr std::size_t kReportMinutes[] = {1, 15, 30, 45, 60};
+  std::printf("fusion: one hour, ~%.0f notes/s, block %d @ %.0f Hz\n", static_cast<double>(kNotesPerSec),
+              kFusionBlockFrames, kSampleRate);
+  std::printf("minute  events  rescan us/block  incremental us/block\n");
+  double rescanNs = 0.0;
+  double fusedNs = 0.0;
+  for (std::size_t b = 0; b < blocks; ++b) {
+    const float t = static_cast<float>(b) * blockSec;
+    for (std::size_t s = 0; s < 6; ++s) {
+      const auto close = [&](NoteEvent& ev) { ev.endSec = std::max(t, ev.startSec + 0.045f); };
+      if (active[s] >= 0) {
+        const float velocity = unit(rng);
+        for (NoteEvent* ev : {&rescanned[static_cast<std::size_t>(active[s])], &fused[active[s]]}) {
+          ev->endSec = t;
+          ev->velocity = std::max(ev->velocity, 0.3f * velocity);
+          if (t >= plannedEnd[s])
+            close(*ev);
+        }
+        if (t >= plannedEnd[s])
+          active[s] = -1;
+      }
+      if (unit(rng) >= kNotesPerSec / 6.f * blockSec)
+        continue;
+      if (active[s] >= 0) {
+        close(rescanned[static_cast<std::size_t>(active[s])]);
+        close(fused[active[s]]);
+      }
+      NoteEvent ev;
+      ev.stringIdx = static_cast<int>(s);
+      ev.fret = std::clamp(lastFret[s] + step(rng), 0, 24);
+      ev.midi = 40 + ev.fret;
+      ev.startSec = t;
+      ev.endSec = t;
+      ev.velocity = 0.1f + 0.9f * unit(rng);
+      lastFret[s] = ev.fret;
+      plannedEnd[s] = t + 0.05f + 0.6f * unit(rng);
+      rescanned.push_back(ev);
+      active[s] = fused.append(ev);
+    }
+
+    auto start = Clock::now();
+    rescanFusion(rescanned);
+    rescanNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    start = Clock::now();
+    fuser.run(fused, active);
+    fusedNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    if ((b + 1) % blocksPerMinute == 0) {
+      const std::size_t minute = (b + 1) / blocksPerMinute;
+      if (std::find(std::begin(kReportMinutes), std::end(kReportMinutes), minute) != std::end(kReportMinutes))
+        std::printf("%6zu  %6zu  %15.2f  %20.3f\n", minute, fused.size(),
+                    rescanNs / 1000.0 / static_cast<double>(blocksPerMinute),
+                    fusedNs / 1000.0 / static_cast<double>(blocksPerMinute));
+      rescanNs = 0.0;
+      fusedNs = 0.0;
+    }
+  }
+
+  std::size_t differing = 0;
+  for (std::size_t i = 0; i < fused.size(); ++i)
+    differing += fused[static_cast<int>(i)].articulation != rescanned[i].articulation;
+  std::printf("articulations: %zu of %zu events differ\n", differing, fused.size());
+  return differing == 0 ? 0 : 1;
+}
+
+struct AppendRun {
+  double meanNs = 0.0;
+  double maxNs = 0.0;
+  std::size_t allocations = 0;
+};
+
+template <typename Append>
+AppendRun runAppends(std::size_t count, Append append) {
+  NoteEvent ev;
+  ev.stringIdx = 2;
+  ev.fret = 5;
+  ev.midi = 55;
+  ev.velocity = 0.5f;
+  AppendRun run;
+  const std::size_t before = gAllocations.load(std::memory_order_relaxed);
+  const auto begin = Clock::now();
+  for (std::size_t i = 0; i < count; ++i) {
+    ev.startSec = static_cast<float>(i) * 0.25f;
+    ev.endSec = ev.startSec + 0.2f;
+    const auto start = Clock::now();
+    append(ev);
+    run.maxNs = std::max(run.maxNs, std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+  }
+  run.meanNs = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / static_cast<double>(count);
+  run.allocations = gAllocations.load(std::memory_order_relaxed) - before;
+  return run;
+}
+
+// Appends to a growing vector against the chunked store, unbounded, with a
+// preview window, and archiving two takes into a reserve sized for them; then
+// a synthetic session through TabEngine with a short window, archived and
+// dropped, against one that keeps everything. The archiving runs must not
+// allocate.
+int benchEvents() {
+  constexpr std::size_t kAppends = 1u << 20;
+  constexpr std::size_t kWindow = 1024;
+  constexpr float kEngineSec = 75.f;    // a few windows' worth of notes
+  constexpr float kWarmupSec = 2.f;
+
+  std::printf("events: %zu appends\n", kAppends);
+  std::printf("store              ns/append  max ns  allocations\n");
+  const auto print = [](const char* name, const AppendRun& run) {
+    std::printf("%-17s  %9.1f  %6.0f  %11zu\n", name, run.meanNs, run.maxNs, run.allocations);
+  };
+  {
+    std::vector<NoteEvent> events;
+    print("vector", runAppends(kAppends, [&](const NoteEvent& ev) { events.push_back(ev); }));
+  }
+  {
+    NoteEventStore events;
+    print("chunked", runAppends(kAppends, [&](const NoteEvent& ev) { events.append(ev); }));
+  }
+  {
+    NoteEventStore events;
+    events.setRetention(kWindow);
+    print("chunked, window", runAppends(kAppends, [&](const NoteEvent& ev) {
+      events.compact(events.append(ev));
+    }));
+  }
+  std::size_t archiveAllocations = 0;
+  {
+    NoteEventStore events;
+    events.setRetention(kWindow);
+    events.setArchiveReserve(kAppends);
+    for (const char* take : {"archive, take 1", "archive, take 2"}) {
+      events.clear();
+      events.setArchive(true);
+      const AppendRun run = runAppends(kAppends, [&](const NoteEvent& ev) {
+        events.compact(events.append(ev));
+      });
+      print(take, run);
+      archiveAllocations += run.allocations;
+      events.setArchive(false);
+    }
+  }
+
+  Tuning tuning;
+  SyntheticHexConfig synthCfg;
+  synthCfg.sampleRate = kSampleRate;
+  synthCfg.seed = 17u;
+  SyntheticHexSource source(tuning, synthCfg);
+  source.generatePhrase(kEngineSec, 12.f, 0.3f);
+  std::array<std::vector<float>, 6> audio;
+  source.render(audio);
+  const std::size_t block = static_cast<std::size_t>(kBlockFrames);
+  const std::size_t blocks = source.frames() / block;
+
+  TrackerConfig cfg;
+  TabEngine full(tuning, cfg);
+  TabEngine archived(tuning, cfg);
+  TabEngine dropped(tuning, cfg);
+  for (TabEngine* engine : {&archived, &dropped})
+    engine->setEventRetention(static_cast<std::size_t>(NoteEventStore::kChunkEvents));
+  archived.setEventArchiveReserve(static_cast<std::size_t>(kEngineSec * 40.f));
+  archived.setEventArchive(true);
+  const std::size_t warmup = static_cast<std::size_t>(kWarmupSec * kSampleRate) / block;
+  std::size_t archivedAllocations = 0;
+  for (std::size_t b = 0; b < blocks; ++b) {
+    const float* channels[6];
+    for (std::size_t s = 0; s < 6; ++s)
+      channels[s] = audio[s].data() + b * block;
+    const float t0 = static_cast<float>(b * block) / kSampleRate;
+    full.processBlock(channels, kBlockFrames, kSampleRate, t0);
+    dropped.processBlock(channels, kBlockFrames, kSampleRate, t0);
+    const std::size_t before = gAllocations.load(std::memory_order_relaxed);
+    archived.processBlock(channels, kBlockFrames, kSampleRate, t0);
+    if (b >= warmup)
+      archivedAllocations += gAllocations.load(std::memory_order_relaxed) - before;
+  }
+  const NoteEventStore& kept = dropped.events();
+  bool tailSame = true;
+  for (int h = kept.firstHandle(); h < kept.endHandle(); ++h) {
+    const NoteEvent& a = kept[h];
+    const NoteEvent& b = full.events()[h];
+    tailSame = tailSame && a.stringIdx == b.stringIdx && a.fret == b.fret && a.startSec == b.startSec
+        && a.endSec == b.endSec && a.articulation == b.articulation;
+  }
+  const bool archiveSame = archived.toJson(false) == full.toJson(false);
+  std::printf("engine, %d-event window: %zu events; archived keeps %zu (%s), dropped keeps the last %zu (%s)\n",
+              NoteEventStore::kChunkEvents, full.events().size(), archived.events().size(),
+              archiveSame ? "identical" : "DIFFERENT", kept.size(), tailSame ? "identical" : "DIFFERENT");
+  std::printf("archived engine after %.0f s warm-up: %zu allocations, %llu event chunks allocated\n",
+              static_cast<double>(kWarmupSec), archivedAllocations,
+              static_cast<unsigned long long>(archived.events().chunkAllocations()));
+  const bool noAllocations = archiveAllocations == 0 && archivedAllocations == 0
+      && archived.events().chunkAllocations() == 0;
+  return archiveSame && tailSame && noAllocations ? 0 : 1;
+}
+
+// NoteEvent as it was before it was packed, for `tab_bench noteevent`.
+struct LegacyNoteEvent {
+  int stringIdx = -1;
+  int fret = -1;
+  int midi = -1;
+  float startSec = 0.f;
+  float endSec = 0.f;
+  float velocity = 0.f;
+  std::string articulation;
+};
+
+struct SessionRun {
+  double fillNs = 0.0;
+  double copyNs = 0.0;
+  double markNs = 0.0;
+  double countNs = 0.0;
+  std::size_t allocations = 0;
+  std::size_t marked = 0;
+};
+
+// Builds a session of count events, copies it as a snapshot would, marks
+// every third event with one of five articulations and counts the slides.
+template <typename Event, typename Mark, typename IsSlide>
+SessionRun runSession(std::size_t count, Mark mark, IsSlide isSlide) {
+  SessionRun run;
+  const auto nsPerEvent = [count](Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(count);
+  };
+  std::vector<Event> events(count);
+  const std::size_t before = gAllocations.load(std::memory_order_relaxed);
+  auto start = Clock::now();
+  for (std::size_t i = 0; i < count; ++i) {
+    Event ev;
+    ev.stringIdx = static_cast<int>(i % 6);
+    ev.fret = static_cast<int>(i % 13);
+    ev.midi = 40 + ev.fret;
+    ev.startSec = static_cast<float>(i) * 0.1f;
+    ev.endSec = ev.startSec + 0.08f;
+    ev.velocity = 0.5f;
+    events[i] = ev;
+  }
+  run.fillNs = nsPerEvent(start);
+
+  start = Clock::now();
+  std::vector<Event> snapshot = events;
+  run.copyNs = nsPerEvent(start);
+
+  start = Clock::now();
+  for (std::size_t i = 0; i < count; i += 3)
+    mark(snapshot[i], (i / 3) % 5);
+  run.markNs = nsPerEvent(start);
+
+  start = Clock::now();
+  for (const Event& ev : snapshot)
+    run.marked += isSlide(ev);
+  run.countNs = nsPerEvent(start);
+  run.allocations = gAllocations.load(std::memory_order_relaxed) - before;
+  return run;
+}
+
+// Memory and per-event cost of a 100k-event session with the old string
+// articulation and the packed event.
+int benchNoteEvent() {
+  constexpr std::size_t kEvents = 100000;
+  constexpr const char* kNames[] = {"slide", "bend", "hammer", "pull", "pm"};
+  constexpr Articulation kMarks[] = {Articulation::Slide, Articulation::Bend, Articulation::Hammer,
+                                     Articulation::Pull, Articulation::PalmMute};
+
+  const SessionRun legacy = runSession<LegacyNoteEvent>(
+      kEvents, [&](LegacyNoteEvent& ev, std::size_t k) { ev.articulation = kNames[k]; },
+      [](const LegacyNoteEvent& ev) { return ev.articulation == "slide"; });
+  const SessionRun packed = runSession<NoteEvent>(
+      kEvents, [&](NoteEvent& ev, std::size_t k) { ev.articulation = kMarks[k]; },
+      [](const NoteEvent& ev) { return hasArticulation(ev.articulation, Articulation::Slide); });
+
+  std::printf("noteevent: %zu-event session\n", kEvents);
+  std::printf("event    bytes  session KiB  fill ns  copy ns  mark ns  count ns  allocations\n");
+  const auto print = [&](const char* name, std::size_t bytes, const SessionRun& run) {
+    std::printf("%-7s  %5zu  %11.0f  %7.2f  %7.2f  %7.2f  %8.2f  %11zu\n", name, bytes,
+                static_cast<double>(bytes * kEvents) / 1024.0, run.fillNs, run.copyNs, run.markNs,
+                run.countNs, run.allocations);
+  };
+  print("string", sizeof(LegacyNoteEvent), legacy);
+  print("packed", sizeof(NoteEvent), packed);
+  return legacy.marked == packed.marked ? 0 : 1;
+}
+
+// TabEngine::toJson as it was before EventSerializer.
+std::string streamJson(const std::vector<NoteEvent>& events) {
+  std::ostringstream oss;
+  oss << "[";
+  bool first = true;
+  for (const auto& e : events) {
+    if (e.endSec <= e.startSec) continue;
+    if (!first) oss << ",";
+    first = false;
+    oss << "{"
+        << "\"string\":" << static_cast<int>(e.stringIdx)
+        << ",\"fret\":" << static_cast<int>(e.fret)
+        << ",\"midi\":" << static_cast<int>(e.midi)
+        << ",\"start\":" << std::fixed << std::setprecision(6) << e.startSec
+        << ",\"end\":"   << std::fixed << std::setprecision(6) << e.endSec
+        << ",\"vel\":"   << std::fixed << std::setprecision(3) << e.velocity
+        << ",\"art\":\"" << articulationLabel(e.articulation) << "\""
+        << "}";
+  }
+  oss << "]";
+  return oss.str();
+}
+
+// A 100k-event take serialized the old way and with the to_chars writer,
+// then written to and reloaded from events.bin.
+int benchSerialize() {
+  constexpr std::size_t kEvents = 100000;
+  constexpr Articulation kMarks[] = {Articulation::None, Articulation::Slide, Articulation::Hammer,
+                                     Articulation::Pull, Articulation::PalmMute};
+
+  std::mt19937 rng(29u);
+  std::uniform_real_distribution<float> unit(0.f, 1.f);
+  std::vector<NoteEvent> events(kEvents);
+  float t = 0.f;
+  for (std::size_t i = 0; i < kEvents; ++i) {
+    NoteEvent& ev = events[i];
+    ev.stringIdx = static_cast<std::int8_t>(i % 6);
+    ev.fret = static_cast<std::int8_t>(unit(rng) * 24.f);
+    ev.midi = static_cast<std::int8_t>(40 + ev.fret);
+    t += 0.05f + 0.3f * unit(rng);
+    ev.startSec = t;
+    ev.endSec = t + 0.05f + unit(rng);
+    ev.velocity = unit(rng);
+    ev.articulation = kMarks[i % std::size(kMarks)];
+  }
+  NoteEventStore store;
+  store.assign(events);
+
+  const auto msSince = [](Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  };
+  std::printf("serialize: %zu events\n", kEvents);
+  std::printf("writer          ms  allocations\n");
+
+  std::size_t before = gAllocations.load(std::memory_order_relaxed);
+  auto start = Clock::now();
+  const std::string streamed = streamJson(events);
+  std::printf("ostringstream  %5.1f  %11zu\n", msSince(start), gAllocations.load(std::memory_order_relaxed) - before);
+
+  before = gAllocations.load(std::memory_order_relaxed);
+  start = Clock::now();
+  std::string written;
+  writeEventsJson(written, store, true);
+  std::printf("to_chars       %5.1f  %11zu\n", msSince(start), gAllocations.load(std::memory_order_relaxed) - before);
+
+  const bool jsonSame = written == streamed;
+
+  const std::string path = (std::filesystem::temp_directory_path() / "tab_bench_events.bin").string();
+  start = Clock::now();
+  const bool wrote = writeEventsBinary(path, events);
+  const double writeMs = msSince(start);
+  std::vector<NoteEvent> loaded;
+  start = Clock::now();
+  const bool read = readEventsBinary(path, loaded);
+  const double readMs = msSince(start);
+  std::error_code ec;
+  const auto binBytes = std::filesystem::file_size(path, ec);
+  std::filesystem::remove(path, ec);
+  bool binSame = wrote && read && loaded.size() == events.size();
+  for (std::size_t i = 0; binSame && i < events.size(); ++i)
+    binSame = std::memcmp(&loaded[i], &events[i], sizeof(NoteEvent)) == 0;
+
+  std::printf("events.bin     write %.1f ms, read %.1f ms, %.0f KiB (JSON %.0f KiB)\n", writeMs, readMs,
+              static_cast<double>(binBytes) / 1024.0, static_cast<double>(streamed.size()) / 1024.0);
+  std::printf("JSON identical to ostringstream: %s, events.bin round trip: %s\n", jsonSame ? "yes" : "NO",
+              binSame ? "yes" : "NO");
+  return jsonSame && binSame ? 0 : 1;
+}
+
+struct Bench {
+  const char* name;
+  int (*run)();
+};
+
+constexpr Bench kBenches[] = {
+    {"multirate", benchMultirate},
+    {"hop", benchHop},
+    {"frontend", benchFrontEnd},
+    {"pitch", benchPitch},
+    {"synthetic", benchSynthetic},
+    {"gate", benchGate},
+    {"gateonset", benchGateOnset},
+    {"sustain", benchSustain},
+    {"alloc", benchAlloc},
+    {"params", benchParams},
+    {"rebuild", benchRebuild},
+    {"fusion", benchFusion},
+    {"events", benchEvents},
+    {"noteevent", benchNoteEvent},
+    {"serialize", benchSerialize},
+    {"trace", benchTrace},
+    {"logger", benchLogger},
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const char* only = argc > 1 ? argv[1] : nullptr;
+  int status = 0;
+  bool matched = false;
+  for (const Bench& bench : kBenches) {
+    if (only && std::strcmp(only, bench.name) != 0)
+      continue;
+    matched = true;
+    status |= bench.run();
+  }
+  if (!matched) {
+    std::fprintf(stderr, "unknown benchmark '%s'; available:", only);
+    for (const Bench& bench : kBenches)
+      std::fprintf(stderr, " %s", bench.name);
+    std::fprintf(stderr, "\n");
+    return 2;
+  }
+  return status;
+}
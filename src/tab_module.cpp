@@ -1,16 +1,128 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
 #include <iostream>
 #include <vector>
 #include <string>
+#include "EventSerializer.h"
 #include "TabEngine.h"
 #include "StringTracker.h"
+#include "SyntheticHexSource.h"
 #include "util.h"
 
 // Simple functional test for the TabEngine module.
 // This can be built separately using `make test_tab_module`.
 
+namespace {
+
+void runEngine(TabEngine& engine, const TrackerConfig& cfg, const std::vector<std::vector<float>>& audio, float sr) {
+    if (const char* threads = std::getenv("GUITARPI_TRACKER_THREADS"))
+        engine.setTrackerThreads(std::atoi(threads));
+    if (const char* hop = std::getenv("GUITARPI_ANALYSIS_HOP"))
+        engine.setAnalysisHop(std::atoi(hop));
+    if (const char* multirate = std::getenv("GUITARPI_MULTIRATE"))
+        engine.setMultirateAnalysis(std::atoi(multirate) > 0);
+    if (const char* spectral = std::getenv("GUITARPI_SPECTRAL_FRONTEND"))
+        engine.setSpectralFrontEnd(std::atoi(spectral) > 0);
+    if (const char* nativePitch = std::getenv("GUITARPI_NATIVE_PITCH"))
+        engine.setNativePitch(std::atoi(nativePitch) > 0);
+    if (const char* fretBank = std::getenv("GUITARPI_FRET_BANK"))
+        engine.setFretBankStrings(unsigned(std::strtoul(fretBank, nullptr, 0)));
+    if (const char* energyGate = std::getenv("GUITARPI_ENERGY_GATE"))
+        engine.setEnergyGate(std::atoi(energyGate) > 0);
+    if (const char* stride = std::getenv("GUITARPI_SUSTAIN_PITCH_STRIDE"))
+        engine.setSustainPitchStride(std::atoi(stride));
+
+    const int blockSize = int(sr * cfg.hopSec);
+    const float hopSec = float(blockSize) / sr;
+
+    size_t maxSamples = 0;
+    for (auto &ch : audio) maxSamples = std::max(maxSamples, ch.size());
+    size_t nBlocks = maxSamples / size_t(blockSize);
+
+    engine.prepare(sr, blockSize);
+    std::vector<const float*> ptrs(6, nullptr);
+    for (size_t b = 0; b < nBlocks; ++b) {
+        for (int s = 0; s < 6; ++s) {
+            size_t off = b * size_t(blockSize);
+            ptrs[s] = (off < audio[s].size()) ? (audio[s].data() + off) : nullptr;
+        }
+        engine.processBlock(ptrs.data(), blockSize, sr, float(b) * hopSec);
+    }
+}
+
+// `--synthetic [seconds] [seed]`: renders a seeded phrase with
+// SyntheticHexSource, prints the detected JSON and scores it against the
+// ground truth on stderr.
+int runSynthetic(int argc, char **argv) {
+    const float seconds = argc > 2 ? float(std::atof(argv[2])) : 20.0f;
+    SyntheticHexConfig synthCfg;
+    if (argc > 3)
+        synthCfg.seed = unsigned(std::strtoul(argv[3], nullptr, 10));
+
+    Tuning tuning;
+    SyntheticHexSource source(tuning, synthCfg);
+    source.generatePhrase(seconds, 4.0f, 0.3f);
+    std::array<std::vector<float>, 6> rendered;
+    source.render(rendered);
+    std::vector<std::vector<float>> audio(rendered.begin(), rendered.end());
+
+    TrackerConfig cfg;
+    TabEngine engine(tuning, cfg);
+    runEngine(engine, cfg, audio, source.sampleRate());
+
+    std::vector<NoteEvent> detected;
+    for (const auto &ev : engine.events()) {
+        if (ev.endSec > ev.startSec)
+            detected.push_back(ev);
+    }
+    const SyntheticScore score = scoreEvents(source.groundTruth(), detected);
+    std::cout << engine.toJson(true) << std::endl;
+    std::cerr << "synthetic seed=" << synthCfg.seed << " seconds=" << seconds
+              << " truth=" << score.truth << " detected=" << score.detected
+              << " matched=" << score.matched
+              << " recall=" << score.recall() << " precision=" << score.precision()
+              << " articulation=" << score.articulationMatched << "/" << score.matched
+              << " onsetError=" << score.meanOnsetErrorSec * 1000.0f << "ms\n";
+    if (engine.energyGate() || engine.sustainPitchStride() > 1) {
+        for (int s = 0; s < 6; ++s) {
+            const TrackerGateStats gate = engine.gateStats(s);
+            std::cerr << "pitch-schedule s" << (s + 1) << " hops=" << gate.hops
+                      << " pitch evaluated/probed/skipped=" << gate.pitchEvaluated << "/" << gate.pitchProbed
+                      << "/" << gate.pitchSkipped
+                      << " onset evaluated/skipped=" << gate.onsetEvaluated << "/" << gate.onsetSkipped << "\n";
+        }
+    }
+    return 0;
+}
+
+// `--events events.bin`: reloads an exported session's events and prints
+// them as JSON.
+int runEventsFile(int argc, char **argv) {
+    std::vector<NoteEvent> events;
+    if (argc < 3 || !readEventsBinary(argv[2], events)) {
+        std::cerr << "Failed to read events: " << (argc < 3 ? "(no file)" : argv[2]) << "\n";
+        return 1;
+    }
+    std::string json;
+    writeEventsJson(json, events, false);
+    std::cout << json << std::endl;
+    std::cerr << "events=" << events.size() << "\n";
+    return 0;
+}
+
+} // namespace
+
 int runTabModuleTest(int argc, char **argv) {
+    if (argc >= 2 && std::string(argv[1]) == "--synthetic")
+        return runSynthetic(argc, argv);
+    if (argc >= 2 && std::string(argv[1]) == "--events")
+        return runEventsFile(argc, argv);
+
     if (argc != 7) {
-        std::cerr << "Usage: test_tab_module e6.wav a5.wav d4.wav g3.wav b2.wav e1.wav\n";
+        std::cerr << "Usage: test_tab_module e6.wav a5.wav d4.wav g3.wav b2.wav e1.wav\n"
+                  << "       test_tab_module --synthetic [seconds] [seed]\n"
+                  << "       test_tab_module --events events.bin\n";
         return 1;
     }
 
@@ -28,22 +140,7 @@ int runTabModuleTest(int argc, char **argv) {
     Tuning tuning;
     TrackerConfig cfg;
     TabEngine engine(tuning, cfg);
-
-    const int blockSize = int(sr * cfg.hopSec);
-    const float hopSec = float(blockSize) / sr;
-
-    size_t maxSamples = 0;
-    for (auto &ch : audio) maxSamples = std::max(maxSamples, ch.size());
-    size_t nBlocks = maxSamples / size_t(blockSize);
-
-    std::vector<const float*> ptrs(6, nullptr);
-    for (size_t b = 0; b < nBlocks; ++b) {
-        for (int s = 0; s < 6; ++s) {
-            size_t off = b * size_t(blockSize);
-            ptrs[s] = (off < audio[s].size()) ? (audio[s].data() + off) : nullptr;
-        }
-        engine.processBlock(ptrs.data(), blockSize, sr, float(b) * hopSec);
-    }
+    runEngine(engine, cfg, audio, sr);
 
     std::cout << engine.toJson(true) << std::endl;
     return 0;